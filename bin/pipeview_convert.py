@@ -0,0 +1,153 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+"""
+Author: HPS Research Group
+Date: 10/18/2026
+Description: Converts a binary pipeview stream (PIPEVIEW_BINARY) into the
+O3PipeView text format written by debug/pipeview.c, which Konata can load.
+The input may be raw or compressed with zstd, lz4, gzip or bzip2.
+"""
+
+import argparse
+import gzip
+import io
+import struct
+import subprocess
+import sys
+
+MAGIC = b"SCARABPV"
+VERSION = 2
+HEADER = struct.Struct("<8sIIII")
+OP = struct.Struct("<QQQIIBB6x10Q")
+STR_HEAD = struct.Struct("<IH")
+
+FETCH, MAP, ISSUE, RDY, SCHED, EXEC, DCACHE, DONE, RETIRE, NOW = range(10)
+FLAG_OFF_PATH = 0x1
+FLAG_SRCS_RDY = 0x2
+
+MASK64 = (1 << 64) - 1
+MEM_PLACEHOLDER = "\x01"
+PREFIX = "O3PipeView"
+
+DECOMPRESSORS = [
+  (b"\x28\xb5\x2f\xfd", ["zstd", "-q", "-d", "-c"]),
+  (b"\x04\x22\x4d\x18", ["lz4", "-q", "-d", "-c"]),
+  (b"BZh", ["bzip2", "-d", "-c"]),
+]
+
+
+def open_stream(path):
+  with open(path, "rb") as f:
+    head = f.read(4)
+  if head[:2] == b"\x1f\x8b":
+    return gzip.open(path, "rb")
+  for magic, cmd in DECOMPRESSORS:
+    if head.startswith(magic):
+      proc = subprocess.Popen(cmd + [path], stdout=subprocess.PIPE)
+      return io.BufferedReader(proc.stdout, 1 << 20)
+  return open(path, "rb", buffering=1 << 20)
+
+
+def read_exact(stream, n):
+  data = stream.read(n)
+  if len(data) != n:
+    sys.exit("pipeview_convert: truncated input")
+  return data
+
+
+def convert(stream, out):
+  magic, version, proc_id, decode_cycles, map_cycles = HEADER.unpack(read_exact(stream, HEADER.size))
+  if magic != MAGIC:
+    sys.exit("pipeview_convert: not a binary pipeview file")
+  if version != VERSION:
+    sys.exit("pipeview_convert: unsupported version {}".format(version))
+
+  disasm = {}
+  while True:
+    tag = stream.read(1)
+    if not tag:
+      break
+    if tag == b"S":
+      str_id, length = STR_HEAD.unpack(read_exact(stream, STR_HEAD.size))
+      disasm[str_id] = read_exact(stream, length).decode("ascii")
+    elif tag == b"O":
+      write_op(out, OP.unpack(read_exact(stream, OP.size)), disasm, decode_cycles, map_cycles)
+    else:
+      sys.exit("pipeview_convert: bad record tag {!r}".format(tag))
+
+
+def write_op(out, rec, disasm, decode_cycles, map_cycles):
+  unique_num, addr, va, disasm_id, mem_size, uop_idx, flags = rec[:7]
+  cycles = rec[7:]
+  fetch = cycles[FETCH]
+  now = cycles[NOW]
+  off_path = flags & FLAG_OFF_PATH
+
+  mem = " {}@{:08x}".format(mem_size, va & 0xffffffff) if mem_size > 0 else ""
+  text = disasm[disasm_id].replace(MEM_PLACEHOLDER, mem)
+  # %lld of an unsigned Counter, as in print_header
+  out.write("{}:new:{}:{:x}:0:{}:{}\n".format(PREFIX, signed(fetch), addr, signed(unique_num), text))
+
+  def event(name, cycle):
+    cycle &= MASK64
+    if fetch <= cycle <= now:
+      out.write("{}:{}:{}\n".format(PREFIX, name, cycle))
+
+  event("fetch_offpath" if off_path else "fetch", fetch)
+  event("decode", fetch + 1)
+  event("decode_done", fetch + 1 + decode_cycles)
+  event("map", cycles[MAP])
+  event("map_done", cycles[MAP] + map_cycles)
+  event("issue", cycles[ISSUE])
+  event("issue_done", cycles[ISSUE] + 1)
+  if flags & FLAG_SRCS_RDY:
+    event("ready", max(cycles[RDY], (cycles[ISSUE] + 1) & MASK64))
+  event("sched", cycles[SCHED])
+  event("exec", cycles[EXEC])
+  event("dcache", cycles[DCACHE])
+  event("done", cycles[DONE])
+  if off_path:
+    event("flush", now)
+    event("end", now)
+  else:
+    event("retire", cycles[RETIRE])
+    event("end", cycles[RETIRE])
+
+
+def signed(value):
+  return value - (1 << 64) if value >> 63 else value
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Convert a binary Scarab pipeview to O3PipeView text.")
+  parser.add_argument("input", help="Binary pipeview file (<PIPEVIEW_FILE>.<proc_id>.pvb).")
+  parser.add_argument("-o", "--output", default=None, help="Output text file (default: stdout).")
+  args = parser.parse_args()
+
+  stream = open_stream(args.input)
+  out = open(args.output, "w") if args.output else sys.stdout
+  convert(stream, out)
+  if args.output:
+    out.close()
+
+
+if __name__ == "__main__":
+  main()
@@ -0,0 +1,157 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+"""
+Author: HPS Research Group
+Date: 10/18/2026
+Description: Fits the coefficient table used by the in-process power model
+(power_intf_coeff_file) from simulations that ran the McPAT/CACTI flow.
+
+Every run directory must hold power_model_results.out and power.stat.<core>.out
+from a run with power_intf_on and the same configuration. Dynamic energy of each
+domain is fit as a non-negative linear function of the POWER_* stats over all
+runs, so use a set of runs with varied behavior (at least as many runs as there
+are stats that change between them). Static power and the reference V/f values
+are taken from the first run.
+
+Example:
+  python3 bin/power/power_fit_coeffs.py -o golden_cove.pwr runs/*/
+"""
+
+import argparse
+import glob
+import os
+import re
+
+import numpy as np
+
+STAT_RE = re.compile(r"^(POWER_\w+)\s+(\d+)\s+(\d+)\s*$")
+FIXED_RESULTS = ["STATIC", "PEAK_DYNAMIC", "SUBTHR_LEAKAGE", "GATE_LEAKAGE", "VOLTAGE", "MIN_VOLTAGE", "FREQUENCY"]
+NUM_CORES_MAX = 8
+
+
+def read_results(run_dir):
+  results = {}
+  with open(os.path.join(run_dir, "power_model_results.out")) as f:
+    for line in f:
+      domain, result, value = line.split()
+      results[(domain.upper(), result.upper())] = float(value)
+  return results
+
+
+def read_power_stats(path):
+  stats = {}
+  with open(path) as f:
+    for line in f:
+      m = STAT_RE.match(line)
+      if m:
+        stats[m.group(1)] = int(m.group(3))  # total count
+  return stats
+
+
+def read_run(run_dir):
+  cores = []
+  for core in range(NUM_CORES_MAX):
+    path = os.path.join(run_dir, "power.stat.{}.out".format(core))
+    if not os.path.exists(path):
+      break
+    cores.append(read_power_stats(path))
+  if not cores:
+    raise RuntimeError("{}: no power.stat.*.out files".format(run_dir))
+  return read_results(run_dir), cores
+
+
+def nnls(a, b, iters=50):
+  """Least squares with the coefficients clamped to >= 0 (simple active set)."""
+  active = np.ones(a.shape[1], dtype=bool)
+  x = np.zeros(a.shape[1])
+  for _ in range(iters):
+    x[:] = 0
+    if not active.any():
+      break
+    x[active] = np.linalg.lstsq(a[:, active], b, rcond=None)[0]
+    if (x >= 0).all():
+      break
+    active &= x > 0
+  return np.maximum(x, 0)
+
+
+def fit_domain(runs, domain, stat_names, counts_of):
+  """Per-event energies for one domain; counts_of(cores) gives its stat counts."""
+  rows, energies = [], []
+  for results, cores in runs:
+    if (domain, "DYNAMIC") not in results:
+      continue
+    counts = counts_of(cores)
+    time = cores[0].get("POWER_TIME", 0) * 1.0e-15
+    rows.append([counts.get(name, 0) for name in stat_names])
+    energies.append(results[(domain, "DYNAMIC")] * time)
+  if not rows:
+    return {}
+  a = np.array(rows, dtype=np.float64)
+  scale = a.max(axis=0)
+  used = scale > 0
+  x = nnls(a[:, used] / scale[used], np.array(energies))
+  coeffs = {}
+  for name, value in zip([n for n, u in zip(stat_names, used) if u], x / scale[used]):
+    if value > 0:
+      coeffs[name] = value
+  return coeffs
+
+
+def accumulate(cores):
+  total = {}
+  for stats in cores:
+    for name, value in stats.items():
+      total[name] = total.get(name, 0) + value
+  return total
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Fit in-process power model coefficients from McPAT runs.")
+  parser.add_argument("run_dirs", nargs="+", help="Simulation directories run with the McPAT/CACTI flow.")
+  parser.add_argument("-o", "--output", required=True, help="Coefficient table to write.")
+  args = parser.parse_args()
+
+  run_dirs = [d for pattern in args.run_dirs for d in sorted(glob.glob(pattern))]
+  runs = [read_run(d) for d in run_dirs]
+  stat_names = sorted({name for _, cores in runs for stats in cores for name in stats
+                       if name not in ("POWER_TIME", "POWER_STATS_BEGIN", "POWER_STATS_END")})
+  first_results = runs[0][0]
+  num_cores = len(runs[0][1])
+
+  domains = [("CORE_{}".format(c), lambda cores, c=c: cores[c]) for c in range(num_cores)]
+  domains += [("UNCORE", accumulate), ("MEMORY", accumulate)]
+
+  with open(args.output, "w") as out:
+    out.write("# Scarab in-process power model coefficients, fit from {} runs\n".format(len(runs)))
+    out.write("# <domain> <POWER_* stat> <joules/event> | <domain> <result> <value>\n")
+    for domain, counts_of in domains:
+      out.write("\n")
+      for result in FIXED_RESULTS:
+        if (domain, result) in first_results:
+          out.write("{:8} {:36} {:.9e}\n".format(domain, result, first_results[(domain, result)]))
+      for name, value in sorted(fit_domain(runs, domain, stat_names, counts_of).items()):
+        out.write("{:8} {:36} {:.9e}\n".format(domain, name, value))
+  print("Wrote {} ({} runs)".format(args.output, len(runs)))
+
+
+if __name__ == "__main__":
+  main()
@@ -0,0 +1,150 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+"""
+Author: HPS Research Group
+Date: 10/18/2026
+Description: Converts a gzip text PT trace (--frontend pt) into the binary
+encoding read by frontend/pt_memtrace/pt_trace_reader_pt.h, or back to text
+with --to-text. Scarab detects the encoding from the file header, so a
+converted trace is used with the same --cbp_trace_r<N> parameter.
+
+Example:
+  python3 bin/pt_trace_convert.py trace.gz -o trace.ptb.gz
+"""
+
+import argparse
+import gzip
+import sys
+
+MAGIC = b"SCPTBIN1"
+MASK64 = (1 << 64) - 1
+MAX_INST_SIZE = 16
+FLUSH_SIZE = 1 << 20
+
+
+def parse_text_line(line):
+  fields = line.split()
+  if len(fields) < 2:
+    return None
+  pc = int(fields[0], 16)
+  size = int(fields[1])
+  if not 0 < size <= MAX_INST_SIZE or len(fields) < 2 + size:
+    return None
+  return pc, bytes(int(b, 16) for b in fields[2:2 + size])
+
+
+def encode_varint(out, value):
+  while value >= 0x80:
+    out.append((value & 0x7f) | 0x80)
+    value >>= 7
+  out.append(value)
+
+
+def to_binary(src, dst):
+  known = {}  # pc -> instruction bytes last written for it
+  next_pc = 0
+  out = bytearray(MAGIC)
+  count = 0
+  for line_num, line in enumerate(src, 1):
+    parsed = parse_text_line(line)
+    if parsed is None:
+      sys.exit("pt_trace_convert: malformed line {}: {!r}".format(line_num, line))
+    pc, inst_bytes = parsed
+    delta = (pc - next_pc) & MASK64
+    delta = delta - (1 << 64) if delta >> 63 else delta
+    zigzag = ((delta << 1) ^ (delta >> 63)) & MASK64
+    if zigzag >> 62:
+      sys.exit("pt_trace_convert: pc jump at line {} does not fit the encoding".format(line_num))
+    has_bytes = known.get(pc) != inst_bytes
+    encode_varint(out, (zigzag << 1) | has_bytes)
+    if has_bytes:
+      known[pc] = inst_bytes
+      out.append(len(inst_bytes))
+      out += inst_bytes
+    next_pc = (pc + len(inst_bytes)) & MASK64
+    count += 1
+    if len(out) >= FLUSH_SIZE:
+      dst.write(out)
+      out.clear()
+  dst.write(out)
+  return count
+
+
+def read_varint(data, pos):
+  value = shift = 0
+  while True:
+    byte = data[pos]
+    pos += 1
+    value |= (byte & 0x7f) << shift
+    if not byte & 0x80:
+      return value, pos
+    shift += 7
+
+
+def to_text(src, dst):
+  data = src.read()
+  if data[:len(MAGIC)] != MAGIC:
+    sys.exit("pt_trace_convert: not a binary PT trace")
+  known = {}
+  next_pc = 0
+  pos = len(MAGIC)
+  count = 0
+  try:
+    while pos < len(data):
+      value, pos = read_varint(data, pos)
+      zigzag = value >> 1
+      pc = (next_pc + ((zigzag >> 1) ^ -(zigzag & 1))) & MASK64
+      if value & 1:
+        size = data[pos]
+        known[pc] = data[pos + 1:pos + 1 + size]
+        pos += 1 + size
+      inst_bytes = known[pc]
+      dst.write("{:x}  {} {}\n".format(pc, len(inst_bytes), " ".join("{:02x}".format(b) for b in inst_bytes)))
+      next_pc = (pc + len(inst_bytes)) & MASK64
+      count += 1
+  except (IndexError, KeyError):
+    sys.exit("pt_trace_convert: corrupt binary PT trace after {} records".format(count))
+  return count
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Convert a text PT trace to Scarab's binary PT trace encoding.")
+  parser.add_argument("input", help="Input trace (gzip or plain).")
+  parser.add_argument("-o", "--output", required=True, help="Output trace, written gzip-compressed.")
+  parser.add_argument("--to-text", action="store_true", help="Convert a binary trace back to text.")
+  parser.add_argument("--level", type=int, default=6, help="gzip compression level (default: 6).")
+  args = parser.parse_args()
+
+  with open(args.input, "rb") as f:
+    gzipped = f.read(2) == b"\x1f\x8b"
+  opener = gzip.open if gzipped else open
+  if args.to_text:
+    with opener(args.input, "rb") as src, gzip.open(args.output, "wt", compresslevel=args.level) as dst:
+      count = to_text(src, dst)
+  else:
+    with opener(args.input, "rt") as src, gzip.open(args.output, "wb", compresslevel=args.level) as dst:
+      count = to_binary(src, dst)
+  print("Converted {} instructions to {}".format(count, args.output))
+
+
+if __name__ == "__main__":
+  main()
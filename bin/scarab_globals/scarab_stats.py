@@ -31,6 +31,7 @@ from scipy import stats
 
 sys.path.append(os.path.dirname(__file__))
 from scarab_utils import *
+from scarab_stats_bin import StatsBinFile
 
 parser = argparse.ArgumentParser(description="Scarab Batch")
 parser.add_argument('results_dir', help="Results directory to parse stats.")
@@ -406,6 +407,12 @@ class StatFileParser:
     """
     stats_file_list = glob.glob(os.path.join(self.results_dir, "*.stat.*.out"))
 
+    # Runs with STATS_BINARY may only have the columnar stats file
+    stats_bin_list = glob.glob(os.path.join(self.results_dir, "*stats.bin"))
+    if len(stats_file_list) == 0 and len(stats_bin_list) > 0:
+      self._parse_stats_bin_file(stats_bin_list[0])
+      return
+
     # Check to see if any stats were generated
     if len(stats_file_list) == 0:
       if print_warnings:
@@ -441,6 +448,22 @@ class StatFileParser:
       if print_warnings:
         warn("Unable to read stats file {} : ".format(statsfile) + str(e))
 
+  def _parse_stats_bin_file(self, statsfile):
+    """Parse the last dump of each core from a STATS_BINARY stats file.
+
+    Args:
+        statsfile (string): Absolute path to the stats.bin file
+    """
+    try:
+      stats_bin = StatsBinFile(statsfile)
+      for core_id in range(stats_bin.num_cores):
+        for stat, value in stats_bin.last(core_id).items():
+          self._add_stat(core_id, stat, float(value), statsfile)
+      self.no_stat_files = False
+    except Exception as e:
+      if print_warnings:
+        warn("Unable to read stats file {} : ".format(statsfile) + str(e))
+
   def _parse_stat(self, stat_str):
     """Convert stat string to stat name and float
 
@@ -0,0 +1,155 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+"""
+Author: HPS Research Group
+Date: 10/18/2026
+Description: Reader for the columnar binary stats file written by Scarab when
+STATS_BINARY is set (see dump_stats_binary in src/statistics.c).
+
+Example:
+  stats = StatsBinFile("results/stats.bin")
+  ipc = [r.cycle_count for r in stats.rows(core_id=0)]
+  df = stats.to_dataframe(core_id=0, total=False)
+"""
+
+import argparse
+import struct
+from collections import namedtuple
+
+import numpy as np
+
+MAGIC = b"SCARABST"
+VERSION = 1
+
+HEADER = struct.Struct("<8sIIII")
+ROW_HEADER = struct.Struct("<IHHIIQQQQQQQ")
+
+ROW_PERIODIC = 0x1
+ROW_ROI = 0x2
+ROW_WARMUP = 0x4
+
+# Order of Stat_Type in src/statistics.h
+STAT_TYPES = ["COUNT", "FLOAT", "DIST", "PER_INST", "PER_1000_INST", "PER_1000_PRET_INST",
+              "PER_CYCLE", "RATIO", "PERCENT", "LINE"]
+FLOAT_TYPE = STAT_TYPES.index("FLOAT")
+
+StatSchema = namedtuple("StatSchema", ["name", "type", "ratio_stat", "file_name"])
+
+StatsBinRow = namedtuple("StatsBinRow", [
+  "proc_id", "bp_id", "flags", "first_stat", "num_stats", "dump_id", "cycle_count",
+  "inst_count", "inst_count_fetched", "pret_inst_count", "period_cycles", "period_insts",
+  "interval", "total"])
+
+
+class StatsBinFile:
+  """All rows of a stats.bin file, with per-stat values decoded according to the schema."""
+
+  def __init__(self, path):
+    with open(path, "rb") as f:
+      data = f.read()
+
+    magic, version, num_stats, self.num_cores, row_header_size = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+      raise ValueError("{} is not a Scarab binary stats file".format(path))
+    if version != VERSION or row_header_size != ROW_HEADER.size:
+      raise ValueError("{}: unsupported stats.bin version {}".format(path, version))
+
+    pos = HEADER.size
+    self.schema = []
+    for _ in range(num_stats):
+      stat_type, ratio_stat, name_len = struct.unpack_from("<BIH", data, pos)
+      pos += 7
+      name = data[pos:pos + name_len].decode("ascii")
+      pos += name_len
+      (file_len,) = struct.unpack_from("<H", data, pos)
+      pos += 2
+      file_name = data[pos:pos + file_len].decode("ascii")
+      pos += file_len
+      self.schema.append(StatSchema(name, STAT_TYPES[stat_type], ratio_stat, file_name))
+    self.stat_index = {s.name: i for i, s in enumerate(self.schema)}
+
+    is_float = np.array([s.type == "FLOAT" for s in self.schema])
+    self._rows = []
+    while pos + ROW_HEADER.size <= len(data):
+      fields = ROW_HEADER.unpack_from(data, pos)
+      pos += ROW_HEADER.size
+      first, count = fields[3], fields[4]
+      raw = np.frombuffer(data, dtype="<u8", count=2 * count, offset=pos)
+      pos += 16 * count
+      self._rows.append(StatsBinRow(*fields, self._decode(raw[:count], is_float[first:first + count]),
+                                    self._decode(raw[count:], is_float[first:first + count])))
+
+  @staticmethod
+  def _decode(raw, is_float):
+    values = raw.astype(np.float64)
+    values[is_float] = raw[is_float].view("<f8")
+    return values
+
+  def rows(self, core_id=None, bp_id=0):
+    """Rows for a core (all cores if core_id is None), in dump order."""
+    return [r for r in self._rows if (core_id is None or r.proc_id == core_id) and r.bp_id == bp_id]
+
+  def get(self, stat_name, core_id=0, total=True, bp_id=0):
+    """Per-dump values of one stat. total selects the cumulative column."""
+    idx = self.stat_index[stat_name]
+    values = []
+    for r in self.rows(core_id, bp_id):
+      if r.first_stat <= idx < r.first_stat + r.num_stats:
+        values.append((r.total if total else r.interval)[idx - r.first_stat])
+    return np.array(values)
+
+  def last(self, core_id=0, total=True):
+    """{stat_name: value} from the last full dump of a core."""
+    full = [r for r in self.rows(core_id) if r.num_stats == len(self.schema)]
+    if not full:
+      return {}
+    values = full[-1].total if total else full[-1].interval
+    return {s.name: values[i] for i, s in enumerate(self.schema)}
+
+  def to_dataframe(self, core_id=0, total=True):
+    """pandas DataFrame with one row per full dump and one column per stat."""
+    import pandas as pd
+    full = [r for r in self.rows(core_id) if r.num_stats == len(self.schema)]
+    values = np.array([r.total if total else r.interval for r in full]).reshape(len(full), len(self.schema))
+    df = pd.DataFrame(values, columns=[s.name for s in self.schema])
+    df.insert(0, "cycle_count", [r.cycle_count for r in full])
+    df.insert(1, "dump_id", [r.dump_id for r in full])
+    return df
+
+
+def __main():
+  parser = argparse.ArgumentParser(description="Print stats from a Scarab stats.bin file.")
+  parser.add_argument("file", help="Path to stats.bin.")
+  parser.add_argument("--core_id", type=int, default=0)
+  parser.add_argument("--stat", action="append", default=None, help="Stat to print for every dump.")
+  args = parser.parse_args()
+
+  stats = StatsBinFile(args.file)
+  if args.stat:
+    for name in args.stat:
+      print(name, " ".join(str(v) for v in stats.get(name, args.core_id)))
+  else:
+    for name, value in stats.last(args.core_id).items():
+      print("{:40} {}".format(name, value))
+
+
+if __name__ == "__main__":
+  __main()
@@ -104,74 +104,6 @@ Bp_Data* g_bp_data = NULL;
 extern List op_buf;
 extern uns operating_mode;
 
-static Hash_Table branch_pc_stats_table;
-static Flag branch_pc_stats_inited = FALSE;
-
-static void init_branch_pc_stats(void) {
-  if (branch_pc_stats_inited)
-    return;
-  init_hash_table(&branch_pc_stats_table, "branch_pc_stats", H2P_TABLE_BUCKETS, sizeof(Branch_PC_Stats));
-  branch_pc_stats_inited = TRUE;
-}
-
-static void branch_pc_stats_update(Op* op) {
-  Flag new_entry;
-  Branch_PC_Stats* s = (Branch_PC_Stats*)hash_table_access_create(&branch_pc_stats_table, op->inst->addr, &new_entry);
-  if (new_entry) {
-    s->pc = op->inst->addr;
-    s->exec_count = 0;
-    s->mispred_count = 0;
-    s->mispred_at_fe_count = 0;
-    s->mispred_at_decode_count = 0;
-    s->mispred_at_exec_count = 0;
-  }
-  s->exec_count++;
-  if (op->bp_pred_main.recovery_point == RECOVER_AT_FE) {
-    s->mispred_count++;
-    s->mispred_at_fe_count++;
-  } else if (op->bp_pred_main.recovery_point == RECOVER_AT_DECODE) {
-    s->mispred_count++;
-    s->mispred_at_decode_count++;
-  } else if (op->bp_pred_main.recovery_point == RECOVER_AT_EXEC) {
-    s->mispred_count++;
-    s->mispred_at_exec_count++;
-  }
-}
-
-static Branch_PC_Stats* lookup_branch_pc_stats(Addr pc) {
-  if (!branch_pc_stats_inited)
-    return NULL;
-  return (Branch_PC_Stats*)hash_table_access(&branch_pc_stats_table, pc);
-}
-
-static Flag h2p_threshold_check(const Branch_PC_Stats* s, Counter mispred) {
-  if (s->exec_count < H2P_MIN_EXEC)
-    return FALSE;
-  if (mispred < H2P_MIN_MISPRED)
-    return FALSE;
-  return (mispred * 1000) > (s->exec_count * (Counter)H2P_MISPRED_RATIO_PERMIL);
-}
-
-Flag is_h2p(Addr pc) {
-  Branch_PC_Stats* s = lookup_branch_pc_stats(pc);
-  return s ? h2p_threshold_check(s, s->mispred_count) : FALSE;
-}
-
-Flag is_h2p_at_fe(Addr pc) {
-  Branch_PC_Stats* s = lookup_branch_pc_stats(pc);
-  return s ? h2p_threshold_check(s, s->mispred_at_fe_count) : FALSE;
-}
-
-Flag is_h2p_at_decode(Addr pc) {
-  Branch_PC_Stats* s = lookup_branch_pc_stats(pc);
-  return s ? h2p_threshold_check(s, s->mispred_at_decode_count) : FALSE;
-}
-
-Flag is_h2p_at_exec(Addr pc) {
-  Branch_PC_Stats* s = lookup_branch_pc_stats(pc);
-  return s ? h2p_threshold_check(s, s->mispred_at_exec_count) : FALSE;
-}
-
 static inline Flag is_h2p_tracked_cf_type(Cf_Type t) {
   switch (t) {
     case CF_CBR:
@@ -191,10 +123,6 @@ static inline Flag is_h2p_tracked_cf_type(Cf_Type t) {
   }
 }
 
-void reset_h2p_stats(void) {
-  hash_table_clear(&branch_pc_stats_table);
-}
-
 /******************************************************************************/
 // Local prototypes
 
@@ -351,16 +279,13 @@ void init_bp_data(uns8 proc_id, uns8 bp_id, Bp_Data* bp_data, Bp_Data* primary_b
 
     ASSERT(proc_id, 0 < BTB_BANKS && BTB_BANKS < 64);
     ASSERT(proc_id, (1 << LOG2(BTB_BANKS)) == BTB_BANKS);
-    bp_data->btb = (Cache*)calloc(BTB_BANKS, sizeof(Cache));
     if (BTB_L0_PRESENT) {
       ASSERT(proc_id, 0 < BTB_L0_BANKS && BTB_L0_BANKS < 64);
       ASSERT(proc_id, (1 << LOG2(BTB_L0_BANKS)) == BTB_L0_BANKS);
-      bp_data->btb_l0 = (Cache*)calloc(BTB_L0_BANKS, sizeof(Cache));
     }
     if (BTB_L1_PRESENT) {
       ASSERT(proc_id, 0 < BTB_L1_BANKS && BTB_L1_BANKS < 64);
       ASSERT(proc_id, (1 << LOG2(BTB_L1_BANKS)) == BTB_L1_BANKS);
-      bp_data->btb_l1 = (Cache*)calloc(BTB_L1_BANKS, sizeof(Cache));
     }
 
     bp_data->tc_tagged = (Cache*)malloc(sizeof(Cache));
@@ -370,7 +295,7 @@ void init_bp_data(uns8 proc_id, uns8 bp_id, Bp_Data* bp_data, Bp_Data* primary_b
   /* initialize branch predictor */
   bp_data->bp = &bp_table[BP_MECH];
   bp_data->bp->init_func();
-  init_branch_pc_stats();
+  h2p_table_init();
   if (bp_l0_enabled()) {
     bp_data->bp_l0 = &bp_table[BP_MECH_L0];
     bp_data->bp_l0->init_func();
@@ -969,7 +894,7 @@ void bp_retire_op(Bp_Data* bp_data, Op* op) {
     bp_data->bp_l0->retire_func(op);
 
   if (is_h2p_tracked_cf_type(op->uop->cf_type))
-    branch_pc_stats_update(op);
+    h2p_table_update(op->proc_id, op->inst->addr, op->bp_pred_main.recovery_point);
 }
 
 /******************************************************************************/
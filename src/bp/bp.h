@@ -33,6 +33,7 @@
 
 #include "bp/bp.param.h"
 
+#include "bp/h2p_table.h"
 #include "libs/cache_lib.h"
 #include "libs/hash_lib.h"
 
@@ -138,15 +139,6 @@ typedef struct CRS_struct {
   uns next;  // next return address will be written here
 } CRS;
 
-typedef struct Branch_PC_Stats_struct {
-  Addr pc;
-  Counter exec_count;
-  Counter mispred_count;
-  Counter mispred_at_fe_count;
-  Counter mispred_at_decode_count;
-  Counter mispred_at_exec_count;
-} Branch_PC_Stats;
-
 typedef struct Bp_Data_struct {
   uns proc_id;
   uns bp_id;
@@ -158,9 +150,8 @@ typedef struct Bp_Data_struct {
   struct Br_Conf_struct* br_conf;
 
   uns32 global_hist;
-  Cache* btb;     // BTB is shared over all the BPs (only allocated on the primary BP)
-  Cache* btb_l0;  // L0 BTB cache (only allocated on primary BP)
-  Cache* btb_l1;  // L1 BTB cache (only allocated on primary BP)
+  Cache* btb;                          // BLOCK_BTB, shared over all the BPs (only allocated on the primary BP)
+  struct Multi_Btb_struct* multi_btb;  // GENERIC_BTB L0/L1/main levels (only allocated on the primary BP)
 
   CRS crs;
 
@@ -206,6 +197,7 @@ typedef enum Btb_Level_enum {
   BTB_L0,
   BTB_L1,
   BTB_MAIN,
+  BTB_NUM_LEVELS,
 } Btb_Level;
 
 typedef enum Ibtb_Id_enum {
@@ -304,11 +296,6 @@ void bp_resolve_op(Bp_Data*, Op*);
 void bp_retire_op(Bp_Data*, Op*);
 void bp_recover_op(Bp_Data*, Cf_Type, Recovery_Info*);
 void bp_sync(Bp_Data*, Bp_Data*);
-Flag is_h2p(Addr pc);
-Flag is_h2p_at_fe(Addr pc);
-Flag is_h2p_at_decode(Addr pc);
-Flag is_h2p_at_exec(Addr pc);
-void reset_h2p_stats(void);
 
 /**************************************************************************************/
 
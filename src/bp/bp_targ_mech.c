@@ -293,27 +293,22 @@ void bp_crs_sync(Bp_Data* bp_data_src, Bp_Data* bp_data_dst) {
 }
 
 /**************************************************************************************/
-/* btb_update_level: write (or update) one BTB-level cache entry for op. */
+/* btb_update_level: write (or update) one BTB-level entry for op. */
 
-static void btb_update_level(Cache* cache, uns level, uns proc_id, Addr fetch_addr, Addr target) {
+static void btb_update_level(Multi_Btb* btb, Btb_Level level, uns proc_id, Addr fetch_addr, Addr target) {
   ASSERT(proc_id, target != ADDR_INVALID);
-  Addr intra_bank_addr, line_addr, repl_line_addr;
   uns bank_id;
-  Flag tag_aliasing;
+  Addr* btb_line = multi_btb_access(btb, level, fetch_addr, TRUE, &bank_id);
 
   if (level == BTB_L0) {
-    bank_id = get_btb_bank_id(BTB_L0_BANKS, fetch_addr, &intra_bank_addr);
     STAT_EVENT_BTB_BANK(proc_id, L0, UPDATE, bank_id);
   } else if (level == BTB_L1) {
-    bank_id = get_btb_bank_id(BTB_L1_BANKS, fetch_addr, &intra_bank_addr);
     STAT_EVENT_BTB_BANK(proc_id, L1, UPDATE, bank_id);
   } else if (level == BTB_MAIN) {
-    bank_id = get_btb_bank_id(BTB_BANKS, fetch_addr, &intra_bank_addr);
     STAT_EVENT_BTB_BANK(proc_id, MAIN, UPDATE, bank_id);
   } else {
     ASSERT(proc_id, FALSE);
   }
-  Addr* btb_line = (Addr*)cache_access_impl(&cache[bank_id], intra_bank_addr, &line_addr, &tag_aliasing, TRUE);
 
   if (!btb_line) {
     if (level == BTB_L0) {
@@ -325,7 +320,7 @@ static void btb_update_level(Cache* cache, uns level, uns proc_id, Addr fetch_ad
     } else {
       ASSERT(proc_id, FALSE);
     }
-    btb_line = (Addr*)cache_insert(&cache[bank_id], proc_id, intra_bank_addr, &line_addr, &repl_line_addr);
+    btb_line = multi_btb_insert(btb, level, fetch_addr);
   }
   *btb_line = target;
 }
@@ -470,40 +465,16 @@ void bp_btb_post_bp_predict(Bp_Data* bp_data, Op* op) {
 /* bp_btb_init: */
 
 void bp_btb_gen_init(Bp_Data* bp_data, Bp_Data* primary_bp) {
-  // btb line size set to 1
   if (!bp_data->bp_id) {
-    ASSERT(bp_data->proc_id, BTB_ENTRIES / BTB_BANKS >= BTB_ASSOC);
-    for (uns ii = 0; ii < BTB_BANKS; ii++) {
-      char name[MAX_STR_LENGTH + 1];
-      snprintf(name, MAX_STR_LENGTH, "BTB BANK %d", ii);
-      init_cache_impl(&bp_data->btb[ii], name, BTB_ENTRIES / BTB_BANKS, BTB_ASSOC, 1, BTB_TAG_BITS, sizeof(Addr),
-                      REPL_TRUE_LRU);
-    }
-
-    if (BTB_L0_PRESENT) {
-      ASSERT(bp_data->proc_id, BTB_L0_ENTRIES / BTB_L0_BANKS >= BTB_L0_ASSOC);
-      for (uns ii = 0; ii < BTB_L0_BANKS; ii++) {
-        char name[MAX_STR_LENGTH + 1];
-        snprintf(name, MAX_STR_LENGTH, "BTB_L0 BANK %d", ii);
-        init_cache_impl(&bp_data->btb_l0[ii], name, BTB_L0_ENTRIES / BTB_L0_BANKS, BTB_L0_ASSOC, 1, BTB_L0_TAG_BITS,
-                        sizeof(Addr), REPL_TRUE_LRU);
-      }
-    }
-
-    if (BTB_L1_PRESENT) {
-      ASSERT(bp_data->proc_id, BTB_L1_ENTRIES / BTB_L1_BANKS >= BTB_L1_ASSOC);
-      for (uns ii = 0; ii < BTB_L1_BANKS; ii++) {
-        char name[MAX_STR_LENGTH + 1];
-        snprintf(name, MAX_STR_LENGTH, "BTB_L1 BANK %d", ii);
-        init_cache_impl(&bp_data->btb_l1[ii], name, BTB_L1_ENTRIES / BTB_L1_BANKS, BTB_L1_ASSOC, 1, BTB_L1_TAG_BITS,
-                        sizeof(Addr), REPL_TRUE_LRU);
-      }
-    }
+    bp_data->multi_btb = (Multi_Btb*)calloc(1, sizeof(Multi_Btb));
+    multi_btb_init_level(bp_data->multi_btb, BTB_MAIN, BTB_ENTRIES, BTB_ASSOC, BTB_BANKS, BTB_TAG_BITS);
+    if (BTB_L0_PRESENT)
+      multi_btb_init_level(bp_data->multi_btb, BTB_L0, BTB_L0_ENTRIES, BTB_L0_ASSOC, BTB_L0_BANKS, BTB_L0_TAG_BITS);
+    if (BTB_L1_PRESENT)
+      multi_btb_init_level(bp_data->multi_btb, BTB_L1, BTB_L1_ENTRIES, BTB_L1_ASSOC, BTB_L1_BANKS, BTB_L1_TAG_BITS);
   } else {
-    // points to the primary BP's shared caches
-    bp_data->btb = primary_bp->btb;
-    bp_data->btb_l0 = primary_bp->btb_l0;
-    bp_data->btb_l1 = primary_bp->btb_l1;
+    // points to the primary BP's shared BTB
+    bp_data->multi_btb = primary_bp->multi_btb;
   }
 }
 
@@ -514,42 +485,37 @@ void bp_btb_gen_pred(Bp_Data* bp_data, Op* op) {
   ASSERT(bp_data->proc_id, op->uop->cf_type);
 
   Btb_Pred_Info* bpi = op->btb_pred_info;
-  Addr intra_bank_addr;
-  Addr line_addr;
-  Flag tag_aliasing;
   Flag lru = bp_data->bp_id ? FALSE : TRUE;
+  Multi_Btb_Probe probe;
 
   op->btb_pred_info->btb_index_addr = op->inst->addr;
 
+  // all levels are looked up in one probe
+  multi_btb_probe(bp_data->multi_btb, op->inst->addr, lru, &probe);
+
   if (BTB_L0_PRESENT) {
-    uns bank_id = get_btb_bank_id(BTB_L0_BANKS, op->inst->addr, &intra_bank_addr);
-    STAT_EVENT_BTB_BANK(op->proc_id, L0, PRED, bank_id);
-    Addr* e = (Addr*)cache_access_impl(&bp_data->btb_l0[bank_id], intra_bank_addr, &line_addr, &tag_aliasing, lru);
-    if (e) {
+    STAT_EVENT_BTB_BANK(op->proc_id, L0, PRED, probe.bank_id[BTB_L0]);
+    if (probe.hit[BTB_L0]) {
       bpi->btb_l0_hit = TRUE;
-      bpi->btb_l0_target = *e;
-      bpi->btb_l0_tag_alias = tag_aliasing;
+      bpi->btb_l0_target = probe.target[BTB_L0];
+      bpi->btb_l0_tag_alias = probe.tag_alias[BTB_L0];
     }
   }
 
   if (BTB_L1_PRESENT) {
-    uns bank_id = get_btb_bank_id(BTB_L1_BANKS, op->inst->addr, &intra_bank_addr);
-    STAT_EVENT_BTB_BANK(op->proc_id, L1, PRED, bank_id);
-    Addr* e = (Addr*)cache_access_impl(&bp_data->btb_l1[bank_id], intra_bank_addr, &line_addr, &tag_aliasing, lru);
-    if (e) {
+    STAT_EVENT_BTB_BANK(op->proc_id, L1, PRED, probe.bank_id[BTB_L1]);
+    if (probe.hit[BTB_L1]) {
       bpi->btb_l1_hit = TRUE;
-      bpi->btb_l1_target = *e;
-      bpi->btb_l1_tag_alias = tag_aliasing;
+      bpi->btb_l1_target = probe.target[BTB_L1];
+      bpi->btb_l1_tag_alias = probe.tag_alias[BTB_L1];
     }
   }
 
-  uns bank_id = get_btb_bank_id(BTB_BANKS, op->inst->addr, &intra_bank_addr);
-  STAT_EVENT_BTB_BANK(op->proc_id, MAIN, PRED, bank_id);
-  Addr* e = (Addr*)cache_access_impl(&bp_data->btb[bank_id], intra_bank_addr, &line_addr, &tag_aliasing, lru);
-  if (e) {
+  STAT_EVENT_BTB_BANK(op->proc_id, MAIN, PRED, probe.bank_id[BTB_MAIN]);
+  if (probe.hit[BTB_MAIN]) {
     bpi->btb_main_hit = TRUE;
-    bpi->btb_main_target = *e;
-    bpi->btb_main_tag_alias = tag_aliasing;
+    bpi->btb_main_target = probe.target[BTB_MAIN];
+    bpi->btb_main_tag_alias = probe.tag_alias[BTB_MAIN];
   }
 }
 
@@ -562,10 +528,8 @@ void bp_btb_gen_update(Bp_Data* bp_data, Op* op) {
   ASSERT(bp_data->proc_id, op->uop->cf_type);
 
   Addr fetch_addr = op->inst->addr;
-  Addr intra_bank_addr;
-  Addr *btb_line, btb_line_addr, repl_line_addr;
-  Flag tag_aliasing;
-  uns bank_id = get_btb_bank_id(BTB_BANKS, fetch_addr, &intra_bank_addr);
+  Addr* btb_line;
+  uns bank_id;
 
   // if it was a btb miss, it is time to write it into the btb
   if (btb_pred_miss(op->btb_pred_info) && op->oracle_info.dir == TAKEN) {
@@ -574,17 +538,7 @@ void bp_btb_gen_update(Bp_Data* bp_data, Op* op) {
       DEBUG_BTB(bp_data->proc_id, "Writing BTB  addr:0x%s  target:0x%s\n", hexstr64s(fetch_addr),
                 hexstr64s(op->oracle_info.target));
       STAT_EVENT(op->proc_id, BTB_WRITE + op->off_path);
-      STAT_EVENT_BTB_BANK(op->proc_id, MAIN, UPDATE, bank_id);
-
-      btb_line = (Addr*)cache_access_impl(&bp_data->btb[bank_id], intra_bank_addr, &btb_line_addr, &tag_aliasing, TRUE);
-      if (!btb_line) {
-        STAT_EVENT_BTB_BANK(op->proc_id, MAIN, INSERT, bank_id);
-        btb_line = (Addr*)cache_insert(&bp_data->btb[bank_id], bp_data->proc_id, intra_bank_addr, &btb_line_addr,
-                                       &repl_line_addr);
-      }
-      *btb_line = op->oracle_info.target;
-      // FIXME: the exceptions to this assert are really about x86 vs Alpha
-      ASSERT(bp_data->proc_id, (fetch_addr == btb_line_addr) || TRUE);
+      btb_update_level(bp_data->multi_btb, BTB_MAIN, bp_data->proc_id, fetch_addr, op->oracle_info.target);
     }
   } else if (!btb_pred_miss(op->btb_pred_info) && op->oracle_info.dir == TAKEN) {
     ASSERT(bp_data->proc_id, op->oracle_info.target != ADDR_INVALID);
@@ -592,20 +546,18 @@ void bp_btb_gen_update(Bp_Data* bp_data, Op* op) {
     // or For indirects we want to update the BTB if the target changes, even on btb hit
     // The detection relies on the target stored in the btb
 
-    btb_line = (Addr*)cache_access_impl(&bp_data->btb[bank_id], intra_bank_addr, &btb_line_addr, &tag_aliasing, FALSE);
+    btb_line = multi_btb_access(bp_data->multi_btb, BTB_MAIN, fetch_addr, FALSE, &bank_id);
 
     // The following assertion can fail (due to eviction?)
     // ASSERT(bp_data->proc_id, btb_entry);
     if (btb_line && *btb_line != op->oracle_info.target) {
-      cache_access_impl(&bp_data->btb[bank_id], intra_bank_addr, &btb_line_addr, &tag_aliasing, TRUE);
+      multi_btb_access(bp_data->multi_btb, BTB_MAIN, fetch_addr, TRUE, &bank_id);
       if (BTB_OFF_PATH_WRITES || !op->off_path) {
         DEBUG_BTB(bp_data->proc_id, "Writing BTB  addr:0x%s  target:0x%s\n", hexstr64s(fetch_addr),
                   hexstr64s(op->oracle_info.target));
         STAT_EVENT(op->proc_id, BTB_WRITE + op->off_path);
         STAT_EVENT_BTB_BANK(op->proc_id, MAIN, UPDATE, bank_id);
         *btb_line = op->oracle_info.target;
-        // FIXME: the exceptions to this assert are really about x86 vs Alpha
-        ASSERT(bp_data->proc_id, (fetch_addr == btb_line_addr) || TRUE);
       }
       STAT_EVENT(bp_data->proc_id, BTB_UPDATE_BTB_HIT_JITTED_NOT_CF + op->uop->cf_type);
     }
@@ -613,12 +565,12 @@ void bp_btb_gen_update(Bp_Data* bp_data, Op* op) {
 
   // Update L0 BTB
   if (BTB_L0_PRESENT && (BTB_OFF_PATH_WRITES || !op->off_path) && op->oracle_info.dir == TAKEN) {
-    btb_update_level(bp_data->btb_l0, BTB_L0, bp_data->proc_id, fetch_addr, op->oracle_info.target);
+    btb_update_level(bp_data->multi_btb, BTB_L0, bp_data->proc_id, fetch_addr, op->oracle_info.target);
   }
 
   // Update L1 BTB
   if (BTB_L1_PRESENT && (BTB_OFF_PATH_WRITES || !op->off_path) && op->oracle_info.dir == TAKEN) {
-    btb_update_level(bp_data->btb_l1, BTB_L1, bp_data->proc_id, fetch_addr, op->oracle_info.target);
+    btb_update_level(bp_data->multi_btb, BTB_L1, bp_data->proc_id, fetch_addr, op->oracle_info.target);
   }
 }
 
@@ -641,6 +593,7 @@ void bp_btb_block_init(Bp_Data* bp_data, Bp_Data* primary_bp) {
 
     ASSERT(bp_data->proc_id, BTB_BANKS == 1);
     ASSERT(bp_data->proc_id, BTB_ENTRIES >= BTB_ASSOC);
+    bp_data->btb = (Cache*)malloc(sizeof(Cache));
     init_cache_impl(bp_data->btb, "B-BTB", BTB_ENTRIES, BTB_ASSOC, 1, BTB_TAG_BITS, BLK_BTB_ENTRY_SIZE, REPL_TRUE_LRU);
   } else  // points to the primary BP's shared BTB
     bp_data->btb = primary_bp->btb;
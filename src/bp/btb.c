@@ -0,0 +1,157 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : bp/btb.c
+ * Author       : HPS Research Group
+ * Date         : 10/19/2026
+ * Description  : Generic BTB levels probed together
+ ***************************************************************************************/
+
+#include "bp/btb.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "bp/bp_targ_mech.h"
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static inline Btb_Entry* btb_level_set(Btb_Level_Array* level, Addr addr, uns* bank_id, Addr* tag, Addr* tag_full);
+
+/**************************************************************************************/
+/* multi_btb_init_level: */
+
+void multi_btb_init_level(Multi_Btb* btb, Btb_Level level, uns entries, uns assoc, uns banks, uns tag_bits) {
+  Btb_Level_Array* array = &btb->levels[level];
+
+  ASSERT(0, entries / banks >= assoc);
+  array->present = TRUE;
+  array->banks = banks;
+  array->sets = entries / banks / assoc;
+  array->assoc = assoc;
+  array->tag_bits = tag_bits;
+  array->set_mask = N_BIT_MASK(LOG2(array->sets));
+  array->tag_pure_mask = tag_bits == 64 ? N_BIT_MASK_64 : N_BIT_MASK(tag_bits);
+  array->entries = (Btb_Entry*)calloc(banks * array->sets * assoc, sizeof(Btb_Entry));
+}
+
+/**************************************************************************************/
+/* btb_level_set: bank, set and tags of addr, same as a cache_lib cache with a
+ * line size of 1 per bank (see cache_index) */
+
+static inline Btb_Entry* btb_level_set(Btb_Level_Array* level, Addr addr, uns* bank_id, Addr* tag, Addr* tag_full) {
+  Addr intra_bank_addr;
+  *bank_id = get_btb_bank_id(level->banks, addr, &intra_bank_addr);
+
+  Addr folded = *tag_full = intra_bank_addr & ~level->set_mask;
+  if (level->tag_bits < 64) {
+    while ((folded >> level->tag_bits) != 0)
+      folded = (folded & level->tag_pure_mask) ^ (folded >> level->tag_bits);
+  }
+  *tag = folded & level->tag_pure_mask;
+
+  uns set = intra_bank_addr & level->set_mask;
+  return &level->entries[((Addr)*bank_id * level->sets + set) * level->assoc];
+}
+
+/**************************************************************************************/
+/* multi_btb_access: */
+
+Addr* multi_btb_access(Multi_Btb* btb, Btb_Level level, Addr addr, Flag update_repl, uns* bank_id) {
+  Btb_Level_Array* array = &btb->levels[level];
+  Addr tag, tag_full;
+  Btb_Entry* set = btb_level_set(array, addr, bank_id, &tag, &tag_full);
+  Addr* target = NULL;
+
+  for (uns ii = 0; ii < array->assoc; ii++) {
+    if (set[ii].valid && set[ii].tag == tag) {
+      if (update_repl)
+        set[ii].last_access_time = sim_time;
+      target = &set[ii].target;
+    }
+  }
+  return target;
+}
+
+/**************************************************************************************/
+/* multi_btb_probe: looks addr up in every present level in one pass */
+
+void multi_btb_probe(Multi_Btb* btb, Addr addr, Flag update_repl, Multi_Btb_Probe* probe) {
+  for (uns level = 0; level < BTB_NUM_LEVELS; level++) {
+    Btb_Level_Array* array = &btb->levels[level];
+    probe->hit[level] = FALSE;
+    probe->tag_alias[level] = FALSE;
+    probe->target[level] = 0;
+    if (!array->present)
+      continue;
+
+    Addr tag, tag_full;
+    Btb_Entry* set = btb_level_set(array, addr, &probe->bank_id[level], &tag, &tag_full);
+    for (uns ii = 0; ii < array->assoc; ii++) {
+      if (set[ii].valid && set[ii].tag == tag) {
+        if (update_repl)
+          set[ii].last_access_time = sim_time;
+        probe->hit[level] = TRUE;
+        probe->tag_alias[level] = set[ii].tag_full != tag_full;
+        probe->target[level] = set[ii].target;
+      }
+    }
+  }
+}
+
+/**************************************************************************************/
+/* multi_btb_insert: same victim as cache_insert with REPL_TRUE_LRU: the first
+ * invalid way, otherwise the first way with the oldest access */
+
+Addr* multi_btb_insert(Multi_Btb* btb, Btb_Level level, Addr addr) {
+  Btb_Level_Array* array = &btb->levels[level];
+  Addr tag, tag_full;
+  uns bank_id;
+  Btb_Entry* set = btb_level_set(array, addr, &bank_id, &tag, &tag_full);
+  uns repl = 0;
+  Counter lru_time = MAX_CTR;
+
+  for (uns ii = 0; ii < array->assoc; ii++) {
+    if (set[ii].valid && set[ii].tag == tag)
+      set[ii].valid = FALSE;
+  }
+  for (uns ii = 0; ii < array->assoc; ii++) {
+    if (!set[ii].valid) {
+      repl = ii;
+      break;
+    }
+    if (set[ii].last_access_time < lru_time) {
+      repl = ii;
+      lru_time = set[ii].last_access_time;
+    }
+  }
+
+  set[repl].valid = TRUE;
+  set[repl].tag = tag;
+  set[repl].tag_full = tag_full;
+  set[repl].last_access_time = sim_time;
+  return &set[repl].target;
+}
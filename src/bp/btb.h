@@ -3,6 +3,8 @@
 
 #include "globals/global_types.h"
 
+#include "bp/bp.h"
+
 // Block-BTB branch slot
 typedef struct Blk_Btb_BrSlot_struct {
   Addr addr;     // equivalent to offset, log2(BTB_BLOCK_SIZE) bits
@@ -13,4 +15,45 @@ typedef struct Blk_Btb_BrSlot_struct {
 
 #define BLK_BTB_ENTRY_SIZE BTB_NUM_BRSLOT * sizeof(Blk_Btb_BrSlot)
 
+// Generic BTB: the L0, L1 and main levels in one structure. Each level keeps
+// the indexing, tag folding and true-LRU replacement of the cache_lib caches
+// it replaces, with the entries stored inline instead of behind data pointers.
+typedef struct Btb_Entry_struct {
+  Addr tag;       // folded to the level's tag bits
+  Addr tag_full;  // unfolded tag, for tag aliasing stats
+  Addr target;
+  Counter last_access_time;
+  Flag valid;
+} Btb_Entry;
+
+typedef struct Btb_Level_Array_struct {
+  Flag present;
+  uns banks;
+  uns sets;  // per bank
+  uns assoc;
+  uns tag_bits;
+  Addr set_mask;
+  Addr tag_pure_mask;
+  Btb_Entry* entries;  // [bank][set][way]
+} Btb_Level_Array;
+
+typedef struct Multi_Btb_struct {
+  Btb_Level_Array levels[BTB_NUM_LEVELS];
+} Multi_Btb;
+
+// Result of probing every present level at once
+typedef struct Multi_Btb_Probe_struct {
+  uns bank_id[BTB_NUM_LEVELS];
+  Flag hit[BTB_NUM_LEVELS];
+  Flag tag_alias[BTB_NUM_LEVELS];
+  Addr target[BTB_NUM_LEVELS];
+} Multi_Btb_Probe;
+
+void multi_btb_init_level(Multi_Btb* btb, Btb_Level level, uns entries, uns assoc, uns banks, uns tag_bits);
+void multi_btb_probe(Multi_Btb* btb, Addr addr, Flag update_repl, Multi_Btb_Probe* probe);
+// Single level lookup; returns the target field of the hit entry or NULL
+Addr* multi_btb_access(Multi_Btb* btb, Btb_Level level, Addr addr, Flag update_repl, uns* bank_id);
+// Replaces the level's invalid or LRU way of addr's set; call after a miss
+Addr* multi_btb_insert(Multi_Btb* btb, Btb_Level level, Addr addr);
+
 #endif /* #ifndef __BTB_H__ */
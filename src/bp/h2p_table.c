@@ -0,0 +1,301 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : bp/h2p_table.c
+ * Author       : HPS Research Group
+ * Date         : 10/19/2026
+ * Description  : Per-PC misprediction statistics behind the is_h2p queries
+ ***************************************************************************************/
+
+#include "bp/h2p_table.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "bp/bp.param.h"
+
+#include "libs/hash_lib.h"
+#include "statistics.h"
+
+/* The stats live in a bounded set-associative table. A resolved branch probes
+ * only its set, and a new PC replaces the way updated least recently, so PCs
+ * that stop executing age out. With H2P_TABLE_EXACT the replaced stats spill
+ * into a hash table and are brought back when their PC executes again, so
+ * every count is exact while the hot PCs still hit in the sets.
+ *
+ * The is_h2p* queries come from the frontend for every fetched branch. They
+ * first check a direct-mapped filter that caches the result of the last query
+ * or update of a PC, including "not tracked". Updates rewrite the filter entry
+ * of their PC and evictions clear it, so the filter never disagrees with the
+ * table. */
+
+#define H2P_ANY (1 << 0)
+#define H2P_AT_FE (1 << 1)
+#define H2P_AT_DECODE (1 << 2)
+#define H2P_AT_EXEC (1 << 3)
+
+typedef struct H2P_Filter_Entry_struct {
+  Addr pc;
+  uns8 h2p;  // H2P_* bits
+  Flag valid;
+} H2P_Filter_Entry;
+
+static H2P_Way* h2p_ways;            // [set][way]
+static Branch_PC_Stats* h2p_stats;   // [set][way]
+static Hash_Table h2p_overflow;      // H2P_TABLE_EXACT only
+static H2P_Filter_Entry* h2p_filter;
+static uns h2p_set_bits;
+static uns32 h2p_time;
+static Flag h2p_inited = FALSE;
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static inline uns h2p_table_set(Addr pc);
+static inline uns32 h2p_table_tag(Addr pc);
+static inline H2P_Filter_Entry* h2p_filter_entry(Addr pc);
+static uns32 h2p_table_tick(void);
+static int h2p_table_find_way(Addr pc);
+static Branch_PC_Stats* h2p_table_access_create(uns8 proc_id, Addr pc);
+static Flag h2p_threshold_check(const Branch_PC_Stats* s, Counter mispred);
+static uns8 h2p_flags(const Branch_PC_Stats* s);
+static uns8 h2p_query(Addr pc);
+
+/**************************************************************************************/
+/* h2p_table_init: the table is shared by all cores, so only the first call
+ * allocates it */
+
+void h2p_table_init(void) {
+  if (h2p_inited)
+    return;
+  uns num_ways = H2P_TABLE_SETS * H2P_TABLE_ASSOC;
+  ASSERTM(0, H2P_TABLE_SETS && !(H2P_TABLE_SETS & (H2P_TABLE_SETS - 1)), "H2P_TABLE_SETS must be a power of 2\n");
+  ASSERTM(0, H2P_TABLE_ASSOC, "H2P_TABLE_ASSOC must be nonzero\n");
+  ASSERTM(0, !(H2P_FILTER_ENTRIES & (H2P_FILTER_ENTRIES - 1)), "H2P_FILTER_ENTRIES must be 0 or a power of 2\n");
+
+  // Sets start on a cache line boundary
+  void* ways;
+  int ret = posix_memalign(&ways, 64, num_ways * sizeof(H2P_Way));
+  ASSERTM(0, !ret, "could not allocate the H2P table\n");
+  h2p_ways = (H2P_Way*)ways;
+  memset(h2p_ways, 0, num_ways * sizeof(H2P_Way));
+  h2p_stats = (Branch_PC_Stats*)calloc(num_ways, sizeof(Branch_PC_Stats));
+  h2p_set_bits = LOG2(H2P_TABLE_SETS);
+  h2p_time = 0;
+
+  if (H2P_TABLE_EXACT)
+    init_hash_table(&h2p_overflow, "h2p_overflow", H2P_TABLE_BUCKETS, sizeof(Branch_PC_Stats));
+  if (H2P_FILTER_ENTRIES)
+    h2p_filter = (H2P_Filter_Entry*)calloc(H2P_FILTER_ENTRIES, sizeof(H2P_Filter_Entry));
+  h2p_inited = TRUE;
+}
+
+/**************************************************************************************/
+/* Indexing */
+
+static inline uns h2p_table_set(Addr pc) {
+  return (pc ^ (pc >> h2p_set_bits) ^ (pc >> (2 * h2p_set_bits))) & N_BIT_MASK(h2p_set_bits);
+}
+
+static inline uns32 h2p_table_tag(Addr pc) {
+  return (uns32)pc ^ (uns32)(pc >> 32);
+}
+
+static inline H2P_Filter_Entry* h2p_filter_entry(Addr pc) {
+  return &h2p_filter[(pc ^ (pc >> 16)) & (H2P_FILTER_ENTRIES - 1)];
+}
+
+/**************************************************************************************/
+/* h2p_table_tick: advances the replacement clock. When it wraps, the ages are
+ * rebased onto the upper half of the range, keeping the order of every way
+ * updated within the last 2^31 updates. */
+
+static uns32 h2p_table_tick(void) {
+  if (++h2p_time == 0) {
+    const uns32 half = 1u << 31;
+    for (uns ii = 0; ii < H2P_TABLE_SETS * H2P_TABLE_ASSOC; ii++) {
+      if (h2p_ways[ii].last_update)
+        h2p_ways[ii].last_update = h2p_ways[ii].last_update > half ? h2p_ways[ii].last_update - half : 1;
+    }
+    h2p_time = half;
+  }
+  return h2p_time;
+}
+
+/**************************************************************************************/
+/* h2p_table_find_way: way index of pc, or -1 */
+
+static int h2p_table_find_way(Addr pc) {
+  uns base = h2p_table_set(pc) * H2P_TABLE_ASSOC;
+  uns32 tag = h2p_table_tag(pc);
+  for (uns way = 0; way < H2P_TABLE_ASSOC; way++) {
+    const H2P_Way* entry = &h2p_ways[base + way];
+    if (entry->last_update && entry->tag == tag && h2p_stats[base + way].pc == pc)
+      return base + way;
+  }
+  return -1;
+}
+
+/**************************************************************************************/
+/* h2p_table_access_create: */
+
+static Branch_PC_Stats* h2p_table_access_create(uns8 proc_id, Addr pc) {
+  int idx = h2p_table_find_way(pc);
+  if (idx < 0) {
+    // victim: an invalid way, otherwise the way updated least recently
+    uns base = h2p_table_set(pc) * H2P_TABLE_ASSOC;
+    idx = base;
+    for (uns way = 1; way < H2P_TABLE_ASSOC; way++) {
+      if (h2p_ways[base + way].last_update < h2p_ways[idx].last_update)
+        idx = base + way;
+    }
+
+    Branch_PC_Stats* victim = &h2p_stats[idx];
+    if (h2p_ways[idx].last_update) {
+      STAT_EVENT(proc_id, H2P_TABLE_EVICT);
+      if (H2P_TABLE_EXACT) {
+        Flag new_entry;
+        *(Branch_PC_Stats*)hash_table_access_create(&h2p_overflow, victim->pc, &new_entry) = *victim;
+      } else if (h2p_filter && h2p_filter_entry(victim->pc)->pc == victim->pc) {
+        h2p_filter_entry(victim->pc)->valid = FALSE;
+      }
+    }
+
+    Branch_PC_Stats* spilled = H2P_TABLE_EXACT ? (Branch_PC_Stats*)hash_table_access(&h2p_overflow, pc) : NULL;
+    if (spilled) {
+      *victim = *spilled;
+      hash_table_access_delete(&h2p_overflow, pc);
+    } else {
+      memset(victim, 0, sizeof(Branch_PC_Stats));
+      victim->pc = pc;
+    }
+    h2p_ways[idx].tag = h2p_table_tag(pc);
+  }
+  h2p_ways[idx].last_update = h2p_table_tick();
+  return &h2p_stats[idx];
+}
+
+/**************************************************************************************/
+/* h2p_table_update: */
+
+void h2p_table_update(uns8 proc_id, Addr pc, Recovery_Point recovery_point) {
+  Branch_PC_Stats* s = h2p_table_access_create(proc_id, pc);
+  s->exec_count++;
+  if (recovery_point == RECOVER_AT_FE) {
+    s->mispred_count++;
+    s->mispred_at_fe_count++;
+  } else if (recovery_point == RECOVER_AT_DECODE) {
+    s->mispred_count++;
+    s->mispred_at_decode_count++;
+  } else if (recovery_point == RECOVER_AT_EXEC) {
+    s->mispred_count++;
+    s->mispred_at_exec_count++;
+  }
+
+  if (h2p_filter) {
+    H2P_Filter_Entry* filter = h2p_filter_entry(pc);
+    if (filter->valid && filter->pc == pc)
+      filter->h2p = h2p_flags(s);
+  }
+}
+
+/**************************************************************************************/
+/* h2p_table_lookup: */
+
+const Branch_PC_Stats* h2p_table_lookup(Addr pc) {
+  if (!h2p_inited)
+    return NULL;
+  int idx = h2p_table_find_way(pc);
+  if (idx >= 0)
+    return &h2p_stats[idx];
+  return H2P_TABLE_EXACT ? (const Branch_PC_Stats*)hash_table_access(&h2p_overflow, pc) : NULL;
+}
+
+/**************************************************************************************/
+/* is_h2p queries */
+
+static Flag h2p_threshold_check(const Branch_PC_Stats* s, Counter mispred) {
+  if (s->exec_count < H2P_MIN_EXEC)
+    return FALSE;
+  if (mispred < H2P_MIN_MISPRED)
+    return FALSE;
+  return (mispred * 1000) > (s->exec_count * (Counter)H2P_MISPRED_RATIO_PERMIL);
+}
+
+static uns8 h2p_flags(const Branch_PC_Stats* s) {
+  if (!s)
+    return 0;
+  return (h2p_threshold_check(s, s->mispred_count) ? H2P_ANY : 0) |
+         (h2p_threshold_check(s, s->mispred_at_fe_count) ? H2P_AT_FE : 0) |
+         (h2p_threshold_check(s, s->mispred_at_decode_count) ? H2P_AT_DECODE : 0) |
+         (h2p_threshold_check(s, s->mispred_at_exec_count) ? H2P_AT_EXEC : 0);
+}
+
+static uns8 h2p_query(Addr pc) {
+  if (!h2p_inited)
+    return 0;
+  if (!h2p_filter)
+    return h2p_flags(h2p_table_lookup(pc));
+  H2P_Filter_Entry* filter = h2p_filter_entry(pc);
+  if (!filter->valid || filter->pc != pc) {
+    filter->pc = pc;
+    filter->h2p = h2p_flags(h2p_table_lookup(pc));
+    filter->valid = TRUE;
+  }
+  return filter->h2p;
+}
+
+Flag is_h2p(Addr pc) {
+  return (h2p_query(pc) & H2P_ANY) != 0;
+}
+
+Flag is_h2p_at_fe(Addr pc) {
+  return (h2p_query(pc) & H2P_AT_FE) != 0;
+}
+
+Flag is_h2p_at_decode(Addr pc) {
+  return (h2p_query(pc) & H2P_AT_DECODE) != 0;
+}
+
+Flag is_h2p_at_exec(Addr pc) {
+  return (h2p_query(pc) & H2P_AT_EXEC) != 0;
+}
+
+/**************************************************************************************/
+/* reset_h2p_stats: forgets every PC, e.g. at the end of warmup */
+
+void reset_h2p_stats(void) {
+  if (!h2p_inited)
+    return;
+  memset(h2p_ways, 0, H2P_TABLE_SETS * H2P_TABLE_ASSOC * sizeof(H2P_Way));
+  h2p_time = 0;
+  if (H2P_TABLE_EXACT)
+    hash_table_clear(&h2p_overflow);
+  if (h2p_filter)
+    memset(h2p_filter, 0, H2P_FILTER_ENTRIES * sizeof(H2P_Filter_Entry));
+}
@@ -0,0 +1,72 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : bp/h2p_table.h
+ * Author       : HPS Research Group
+ * Date         : 10/19/2026
+ * Description  : Per-PC misprediction statistics behind the is_h2p queries
+ ***************************************************************************************/
+
+#ifndef __H2P_TABLE_H__
+#define __H2P_TABLE_H__
+
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+
+#include "pred_info.h"
+
+/**************************************************************************************/
+/* Types */
+
+typedef struct Branch_PC_Stats_struct {
+  Addr pc;
+  Counter exec_count;
+  Counter mispred_count;
+  Counter mispred_at_fe_count;
+  Counter mispred_at_decode_count;
+  Counter mispred_at_exec_count;
+} Branch_PC_Stats;
+
+// One way of a set. The ways of a set are contiguous and 8 bytes each, so a
+// probe of an 8-way set reads a single cache line; the stats are only read on
+// a tag match, which is then confirmed against the full PC.
+typedef struct H2P_Way_struct {
+  uns32 tag;
+  uns32 last_update;  // table clock at the last update, 0 marks an invalid way
+} H2P_Way;
+
+/**************************************************************************************/
+/* Prototypes */
+
+void h2p_table_init(void);
+// Counts one retired instance of the branch at pc, allocating its entry if needed
+void h2p_table_update(uns8 proc_id, Addr pc, Recovery_Point recovery_point);
+// Stats of pc, or NULL if it is not tracked
+const Branch_PC_Stats* h2p_table_lookup(Addr pc);
+
+Flag is_h2p(Addr pc);
+Flag is_h2p_at_fe(Addr pc);
+Flag is_h2p_at_decode(Addr pc);
+Flag is_h2p_at_exec(Addr pc);
+void reset_h2p_stats(void);
+
+#endif /* #ifndef __H2P_TABLE_H__ */
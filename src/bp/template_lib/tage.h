@@ -23,8 +23,16 @@
 #define __TAGE_H_
 
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "utils.h"
 
 /* The main history register suitable for very large history. The history is
@@ -42,7 +50,7 @@ class Long_History_Register {
     buffer_size_ = 1 << log_buffer_size;
     buffer_access_mask_ = (1 << log_buffer_size) - 1;
     max_num_speculative_bits_ = buffer_size_ - history_size;
-    history_bits_.resize(buffer_size_);
+    history_bits_.resize(buffer_size_, 0);
   }
 
   // Pushes one bit into the history at the head. Increments
@@ -84,61 +92,107 @@ class Long_History_Register {
   int num_speculative_bits_ = 0;  // keeps track of how many bits can be
                                   // discarded during a rewind without losing
                                   // bits in the most significant position.
-  std::vector<bool> history_bits_;
+  std::vector<uint8_t> history_bits_;  // one byte per bit for cheap random access
   int64_t head_ = 0;
   int64_t buffer_size_;
   int64_t buffer_access_mask_;
   int64_t max_num_speculative_bits_;
 };
 
-/* Computes the a folded history of a large history, as bits are shifted into
- * the history. The caller should update the folded history everytime  */
-template <int history_size>
-class Folded_History {
+/* Folded histories of all TAGE tables, stored as a structure of arrays so that
+ * every table's value is updated at once with SSE2/AVX2 (with a scalar
+ * fallback). Each lane computes the same value as the classic per-table
+ * folded history:
+ *   update: v = ((v << 1) ^ h[0] ^ (h[original_length] << outpoint)),
+ *           then fold bit compressed_length back into bit 0 and mask.
+ * Since v never holds more than compressed_length + 1 bits before the fold,
+ * the per-lane variable shifts reduce to tests against per-lane constants.
+ * Misprediction repair restores a Checkpoint taken before the flushed
+ * branches updated the bank instead of undoing their updates bit by bit. */
+template <int history_size, int num_folds>
+class Folded_History_Bank {
  public:
-  Folded_History(int original_length, int compressed_length)
-      : current_value_(0),
-        original_length_(original_length),
-        compressed_length_(compressed_length),
-        outpoint_(original_length % compressed_length) {}
-
-  int64_t get_value() const {
-    return current_value_;
-  }
-
-  void update(const Long_History_Register<history_size>& history_register) {
-    // Shift in the most recent GHR bit.
-    current_value_ = (current_value_ << 1) ^ history_register[0];
+  static constexpr int LANES_PER_VECTOR = 8;
+  static constexpr int NUM_LANES = (num_folds + LANES_PER_VECTOR - 1) / LANES_PER_VECTOR * LANES_PER_VECTOR;
 
-    // Shift out the least recent GHR bit.
-    current_value_ ^= history_register[original_length_] << outpoint_;
+  struct Checkpoint {
+    int32_t values[NUM_LANES];
+  };
 
-    // Fold shifted-out bit in.
-    current_value_ ^= current_value_ >> compressed_length_;
+  Folded_History_Bank() : values_(), original_lengths_(), outpoints_(), top_bits_(), masks_() {}
 
-    // Mask out the unused bits.
-    current_value_ &= (1 << compressed_length_) - 1;
+  void init_fold(int fold, int original_length, int compressed_length) {
+    assert(fold < num_folds && compressed_length > 0 && compressed_length < 31);
+    values_[fold] = 0;
+    original_lengths_[fold] = original_length;
+    outpoints_[fold] = original_length % compressed_length;
+    top_bits_[fold] = 1 << compressed_length;
+    masks_[fold] = (1 << compressed_length) - 1;
   }
 
-  void update_reverse(const Long_History_Register<history_size>& history_register) {
-    // Fold out the most recent GHR bit.
-    current_value_ ^= history_register[0];
+  int64_t get_value(int fold) const {
+    return values_[fold];
+  }
 
-    // Fold out the least recent GHR bit.
-    current_value_ ^= history_register[original_length_] << outpoint_;
+  void save(Checkpoint* checkpoint) const {
+    std::memcpy(checkpoint->values, values_, sizeof(values_));
+  }
 
-    // Rotate the low bit around to high bit.
-    current_value_ = ((current_value_ & 1) << (compressed_length_ - 1)) | (current_value_ >> 1);
+  void restore(const Checkpoint& checkpoint) {
+    std::memcpy(values_, checkpoint.values, sizeof(values_));
+  }
 
-    // Mask out the unused bits.
-    current_value_ &= (1 << compressed_length_) - 1;
+  void update(const Long_History_Register<history_size>& history_register) {
+    alignas(32) int32_t shifted_out[NUM_LANES];
+    gather_shifted_out_bits(history_register, shifted_out);
+    const int32_t newest_bit = history_register[0];
+
+#if defined(__AVX2__)
+    const __m256i newest = _mm256_set1_epi32(newest_bit);
+    for (int i = 0; i < NUM_LANES; i += 8) {
+      __m256i value = _mm256_load_si256((const __m256i*)&values_[i]);
+      const __m256i top = _mm256_load_si256((const __m256i*)&top_bits_[i]);
+      value = _mm256_xor_si256(_mm256_slli_epi32(value, 1), newest);
+      value = _mm256_xor_si256(value, _mm256_load_si256((const __m256i*)&shifted_out[i]));
+      value = _mm256_xor_si256(value, _mm256_srli_epi32(_mm256_cmpeq_epi32(_mm256_and_si256(value, top), top), 31));
+      value = _mm256_and_si256(value, _mm256_load_si256((const __m256i*)&masks_[i]));
+      _mm256_store_si256((__m256i*)&values_[i], value);
+    }
+#elif defined(__SSE2__)
+    const __m128i newest = _mm_set1_epi32(newest_bit);
+    for (int i = 0; i < NUM_LANES; i += 4) {
+      __m128i value = _mm_load_si128((const __m128i*)&values_[i]);
+      const __m128i top = _mm_load_si128((const __m128i*)&top_bits_[i]);
+      value = _mm_xor_si128(_mm_slli_epi32(value, 1), newest);
+      value = _mm_xor_si128(value, _mm_load_si128((const __m128i*)&shifted_out[i]));
+      value = _mm_xor_si128(value, _mm_srli_epi32(_mm_cmpeq_epi32(_mm_and_si128(value, top), top), 31));
+      value = _mm_and_si128(value, _mm_load_si128((const __m128i*)&masks_[i]));
+      _mm_store_si128((__m128i*)&values_[i], value);
+    }
+#else
+    for (int i = 0; i < NUM_LANES; ++i) {
+      int32_t value = ((values_[i] << 1) ^ newest_bit) ^ shifted_out[i];
+      value ^= (value & top_bits_[i]) ? 1 : 0;
+      values_[i] = value & masks_[i];
+    }
+#endif
   }
 
  private:
-  int64_t current_value_;
-  int original_length_;
-  int compressed_length_;
-  int outpoint_;
+  // The oldest bit of each fold's history window, already moved to its outpoint.
+  void gather_shifted_out_bits(const Long_History_Register<history_size>& history_register,
+                               int32_t* shifted_out) const {
+    for (int i = 0; i < NUM_LANES; ++i) {
+      shifted_out[i] = history_register[original_lengths_[i]] << outpoints_[i];
+    }
+  }
+
+  // Unused lanes have zero masks, so they always stay zero.
+  alignas(32) int32_t values_[NUM_LANES];
+  alignas(32) int32_t original_lengths_[NUM_LANES];
+  alignas(32) int32_t outpoints_[NUM_LANES];
+  alignas(32) int32_t top_bits_[NUM_LANES];  // 1 << compressed_length
+  alignas(32) int32_t masks_[NUM_LANES];
 };
 
 template <class TAGE_CONFIG>
@@ -227,6 +281,8 @@ struct Tage_Prediction_Info {
   int num_global_history_bits;
   int64_t global_history_head_checkpoint_;
   int64_t path_history_checkpoint;
+  typename Folded_History_Bank<TAGE_CONFIG::MAX_HISTORY_SIZE, 3 * TAGE_CONFIG::NUM_HISTORIES>::Checkpoint
+      folded_history_checkpoint;
 };
 
 template <class TAGE_CONFIG>
@@ -255,6 +311,7 @@ class Tage_Histories {
     prediction_info->num_global_history_bits = num_bit_inserts;
     prediction_info->path_history_checkpoint = path_history_;
     prediction_info->global_history_head_checkpoint_ = history_register_.head_idx();
+    folded_histories_.save(&prediction_info->folded_history_checkpoint);
 
     for (int i = 0; i < num_bit_inserts; ++i) {
       history_register_.push_bit(pc_dir_hash & 1);
@@ -263,11 +320,7 @@ class Tage_Histories {
       path_history_ = (path_history_ << 1) ^ (path_hash & 127);
       path_hash >>= 1;
 
-      for (int j = 0; j < TAGE_CONFIG::NUM_HISTORIES; ++j) {
-        folded_histories_for_indices_[j].update(history_register_);
-        folded_histories_for_tags_0_[j].update(history_register_);
-        folded_histories_for_tags_1_[j].update(history_register_);
-      }
+      folded_histories_.update(history_register_);
     }
 
     path_history_ = path_history_ & ((1 << TAGE_CONFIG::PATH_HISTORY_WIDTH) - 1);
@@ -287,11 +340,21 @@ class Tage_Histories {
   inline static const Tage_History_Sizes<TAGE_CONFIG> history_sizes_{};
   static constexpr Tage_Tag_Bits<TAGE_CONFIG> tag_bits_ = {};
 
+  // Folds of the global history, three per history length: one for the table
+  // index and two for the tag.
+  static constexpr int index_fold(int history) {
+    return history;
+  }
+  static constexpr int tag_0_fold(int history) {
+    return TAGE_CONFIG::NUM_HISTORIES + history;
+  }
+  static constexpr int tag_1_fold(int history) {
+    return 2 * TAGE_CONFIG::NUM_HISTORIES + history;
+  }
+
   // Predictor State
   Long_History_Register<TAGE_CONFIG::MAX_HISTORY_SIZE> history_register_;
-  std::vector<Folded_History<TAGE_CONFIG::MAX_HISTORY_SIZE>> folded_histories_for_indices_;
-  std::vector<Folded_History<TAGE_CONFIG::MAX_HISTORY_SIZE>> folded_histories_for_tags_0_;
-  std::vector<Folded_History<TAGE_CONFIG::MAX_HISTORY_SIZE>> folded_histories_for_tags_1_;
+  Folded_History_Bank<TAGE_CONFIG::MAX_HISTORY_SIZE, 3 * TAGE_CONFIG::NUM_HISTORIES> folded_histories_;
 
   int64_t path_history_ = 0;
   int64_t head_old_ = 0;
@@ -540,14 +603,10 @@ class Tage {
   void global_recover_speculative_state(const Tage_Prediction_Info<TAGE_CONFIG>& prediction_info) {
     int64_t num_flushed_bits =
         (prediction_info.global_history_head_checkpoint_ - tage_histories_.history_register_.head_idx());
-    for (int i = 0; i < num_flushed_bits; ++i) {
-      for (int j = 0; j < TAGE_CONFIG::NUM_HISTORIES; ++j) {
-        tage_histories_.folded_histories_for_indices_[j].update_reverse(tage_histories_.history_register_);
-        tage_histories_.folded_histories_for_tags_0_[j].update_reverse(tage_histories_.history_register_);
-        tage_histories_.folded_histories_for_tags_1_[j].update_reverse(tage_histories_.history_register_);
-      }
-      tage_histories_.history_register_.rewind(1);
+    if (num_flushed_bits > 0) {
+      tage_histories_.history_register_.rewind(num_flushed_bits);
     }
+    tage_histories_.folded_histories_.restore(prediction_info.folded_history_checkpoint);
     tage_histories_.path_history_ = prediction_info.path_history_checkpoint;
   }
 
@@ -630,16 +689,10 @@ void Tage<TAGE_CONFIG>::initialize_table_sizes(void) {
 
 template <class TAGE_CONFIG>
 void Tage_Histories<TAGE_CONFIG>::intialize_folded_history(void) {
-  // insert dummy entries for the zeroth entry of the vector
   for (int i = 0; i < TAGE_CONFIG::NUM_HISTORIES; i++) {
-    // For some reason I cannot pass LOG_ENTRIES_PER_BANK to emplace_bank()
-    // directly (gcc complains that variable is undefined), do not know why.
-    // REVISIT: since I got rid of LOG_ENTRIES_PER_BANK as a constant, this
-    // should be fine now.
-    const int LOG_ENTRIES_PER_BANK2 = TAGE_CONFIG::LOG_ENTRIES_PER_BANK;
-    folded_histories_for_indices_.emplace_back(history_sizes_.arr[i], LOG_ENTRIES_PER_BANK2);
-    folded_histories_for_tags_0_.emplace_back(history_sizes_.arr[i], tag_bits_.arr[i]);
-    folded_histories_for_tags_1_.emplace_back(history_sizes_.arr[i], tag_bits_.arr[i] - 1);
+    folded_histories_.init_fold(index_fold(i), history_sizes_.arr[i], TAGE_CONFIG::LOG_ENTRIES_PER_BANK);
+    folded_histories_.init_fold(tag_0_fold(i), history_sizes_.arr[i], tag_bits_.arr[i]);
+    folded_histories_.init_fold(tag_1_fold(i), history_sizes_.arr[i], tag_bits_.arr[i] - 1);
   }
 }
 
@@ -688,13 +741,13 @@ void Tage<TAGE_CONFIG>::fill_table_indices_tags(uint64_t br_pc, Tage_Prediction_
                                                             TAGE_CONFIG::LOG_ENTRIES_PER_BANK);
       int64_t index = br_pc;
       index ^= br_pc >> (std::abs(TAGE_CONFIG::LOG_ENTRIES_PER_BANK - i) + 1);
-      index ^= tage_histories_.folded_histories_for_indices_[(i - 1) / 2].get_value();
+      index ^= tage_histories_.folded_histories_.get_value(tage_histories_.index_fold((i - 1) / 2));
       index ^= path_hash;
       output->indices[i] = index & ((1 << TAGE_CONFIG::LOG_ENTRIES_PER_BANK) - 1);
 
       int64_t tag = br_pc;
-      tag ^= tage_histories_.folded_histories_for_tags_0_[(i - 1) / 2].get_value();
-      tag ^= tage_histories_.folded_histories_for_tags_1_[(i - 1) / 2].get_value() << 1;
+      tag ^= tage_histories_.folded_histories_.get_value(tage_histories_.tag_0_fold((i - 1) / 2));
+      tag ^= tage_histories_.folded_histories_.get_value(tage_histories_.tag_1_fold((i - 1) / 2)) << 1;
       output->tags[i] = tag & ((1 << tage_histories_.tag_bits_.arr[(i - 1) / 2]) - 1);
 
       output->tags[i + 1] = output->tags[i];
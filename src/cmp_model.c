@@ -36,6 +36,7 @@
 #include "debug/debug.param.h"
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
+#include "debug/host_prof.h"
 
 #include "bp/bp.param.h"
 #include "core.param.h"
@@ -47,6 +48,7 @@
 #include "bp/bp_targ_mech.h"
 #include "dvfs/dvfs.h"
 #include "dvfs/perf_pred.h"
+#include "frontend/frontend.h"
 #include "memory/cache_part.h"
 #include "prefetcher/D_JOLT.h"
 #include "prefetcher/FNL+MMA.h"
@@ -189,7 +191,7 @@ void cmp_cycle() {
 
   /* Frequency domain checking is inside this function, since it
    * handles both shared cache and memory */
-  update_memory();
+  HOST_PROF_REGION(MEMORY, update_memory());
 
   cmp_cores();
 
@@ -239,33 +241,33 @@ void cmp_cores(void) {
       cmp_set_all_data(proc_id, 0);
 
       /* Back-end pipeline */
-      update_dcache_stage(&exec->sd);
-      update_exec_stage(&node->sd);
-      update_node_stage(map->last_sd);
-      update_map_stage(idq_stage_get_stage_data());
+      HOST_PROF_REGION(DCACHE, update_dcache_stage(&exec->sd));
+      HOST_PROF_REGION(EXEC, update_exec_stage(&node->sd));
+      HOST_PROF_REGION(NODE, update_node_stage(map->last_sd));
+      HOST_PROF_REGION(MAP, update_map_stage(idq_stage_get_stage_data()));
 
       if (UOP_CACHE_ENABLE) {
         /* IDQ stage that bridges the front-end and back-end */
         /* This stage can get uops from the uc->sd, cache queue, or decoder. */
-        update_idq_stage(dec->last_sd, &uc->sd, uop_queue_stage_get_latest_sd());
+        HOST_PROF_REGION(IDQ, update_idq_stage(dec->last_sd, &uc->sd, uop_queue_stage_get_latest_sd()));
 
         /* Front-end pipiline */
-        update_uop_queue_stage(&uc->sd);
+        HOST_PROF_REGION(UOP_QUEUE, update_uop_queue_stage(&uc->sd));
       } else {
-        update_idq_stage(dec->last_sd, NULL, NULL);
-        update_uop_queue_stage(NULL);
+        HOST_PROF_REGION(IDQ, update_idq_stage(dec->last_sd, NULL, NULL));
+        HOST_PROF_REGION(UOP_QUEUE, update_uop_queue_stage(NULL));
       }
-      update_decode_stage(&ic->sd);
-      update_icache_stage();
+      HOST_PROF_REGION(DECODE, update_decode_stage(&ic->sd));
+      HOST_PROF_REGION(ICACHE, update_icache_stage());
 
       /* Decoupled branch prediction and prefetching */
       for (uns8 bp_id = 0; bp_id < NUM_BPS; bp_id++) {
         cmp_set_all_data(proc_id, bp_id);
-        update_decoupled_fe(proc_id, bp_id);
-        update_fdip(proc_id, bp_id);
+        HOST_PROF_REGION(DECOUPLED_FE, update_decoupled_fe(proc_id, bp_id));
+        HOST_PROF_REGION(FDIP, update_fdip(proc_id, bp_id));
       }
       cmp_set_all_data(proc_id, 0);
-      update_eip();
+      HOST_PROF_REGION(EIP, update_eip());
 
       cmp_measure_chip_util();
     }
@@ -452,10 +454,7 @@ void warmup_uncore(uns proc_id, Addr addr, Flag write) {
 /* Warm up select microarchitectural structures: BP, icache, dcache,
  * and L1. No wrong path warmup. */
 
-void cmp_warmup(Op* op) {
-  uns proc_id = op->proc_id;
-  Addr ia = op->inst->addr;
-  Addr va = op->oracle_info.va;
+static void cmp_warmup_icache(uns proc_id, Addr ia) {
   Addr dummy_line_addr;
   Addr dummy_line_addr2;
   Icache_Data* line_info = NULL;
@@ -488,30 +487,41 @@ void cmp_warmup(Op* op) {
       line_info->read_count[0] += 1;
     }
   }
+}
+
+static void cmp_warmup_dcache(uns proc_id, Addr va, Flag is_load, Flag is_store) {
+  Addr dummy_line_addr;
+  Cache* dcache = &(cmp_model.dcache_stage[proc_id].dcache);
+  Dcache_Data* dc_data = cache_access(dcache, va, &dummy_line_addr, TRUE);
+  if (dc_data) {
+    // set some fields to meet expectations of the simulation mode
+    if (is_store)
+      dc_data->dirty = TRUE;
+    dc_data->read_count[0] += is_load;
+    dc_data->write_count[0] += is_store;
+  } else {
+    warmup_uncore(proc_id, va, FALSE);
+    Addr repl_line_addr;
+    dc_data = (Dcache_Data*)cache_insert(dcache, proc_id, va, &dummy_line_addr, &repl_line_addr);
+    if (dc_data->dirty)
+      warmup_uncore(proc_id, repl_line_addr, TRUE);
+    dc_data->dirty = is_store;
+    dc_data->read_count[0] = is_load;
+    dc_data->write_count[0] = is_store;
+  }
+}
+
+void cmp_warmup(Op* op) {
+  uns proc_id = op->proc_id;
+  Addr ia = op->inst->addr;
+
+  cmp_warmup_icache(proc_id, ia);
 
   // Warmup caches for data
   Flag is_load = op->uop->mem_type == MEM_LD;
   Flag is_store = op->uop->mem_type == MEM_ST;
-  if (is_load || is_store) {
-    Cache* dcache = &(cmp_model.dcache_stage[proc_id].dcache);
-    Dcache_Data* dc_data = cache_access(dcache, va, &dummy_line_addr, TRUE);
-    if (dc_data) {
-      // set some fields to meet expectations of the simulation mode
-      if (is_store)
-        dc_data->dirty = TRUE;
-      dc_data->read_count[0] += is_load;
-      dc_data->write_count[0] += is_store;
-    } else {
-      warmup_uncore(proc_id, va, FALSE);
-      Addr repl_line_addr;
-      dc_data = (Dcache_Data*)cache_insert(dcache, proc_id, va, &dummy_line_addr, &repl_line_addr);
-      if (dc_data->dirty)
-        warmup_uncore(proc_id, repl_line_addr, TRUE);
-      dc_data->dirty = is_store;
-      dc_data->read_count[0] = is_load;
-      dc_data->write_count[0] = is_store;
-    }
-  }
+  if (is_load || is_store)
+    cmp_warmup_dcache(proc_id, op->oracle_info.va, is_load, is_store);
 
   // Warmup BP for CF instructions
   if (op->uop->cf_type != NOT_CF) {
@@ -532,6 +542,17 @@ void cmp_warmup(Op* op) {
   }
 }
 
+/* Same cache warmup as cmp_warmup for an instruction whose uops were never generated. The instruction is fetched
+ * once instead of once per uop, which leaves the same replacement state since warmup time only advances between
+ * instructions. */
+void cmp_warmup_inst(uns proc_id, Warmup_Inst* inst) {
+  cmp_warmup_icache(proc_id, inst->addr);
+  for (uns i = 0; i < inst->num_ld; i++)
+    cmp_warmup_dcache(proc_id, inst->ld_va[i], TRUE, FALSE);
+  for (uns i = 0; i < inst->num_st; i++)
+    cmp_warmup_dcache(proc_id, inst->st_va[i], FALSE, TRUE);
+}
+
 static void cmp_measure_chip_util() {
   Flag chip_busy =
       exec->fus_busy || mem->uncores[exec->proc_id].num_outstanding_l1_accesses > 0 || dc->idle_cycle > cycle_count;
@@ -45,6 +45,11 @@
 #include "thread.h"
 #include "uop_cache.h"
 
+/**************************************************************************************/
+/* Forward Declarations */
+
+struct Warmup_Inst_struct;
+
 /**************************************************************************************/
 /* cmp model data  */
 
@@ -88,6 +93,7 @@ void cmp_done(void);
 void cmp_wake(Op*, Op*, uns);
 void cmp_retire_hook(Op*);
 void cmp_warmup(Op*);
+void cmp_warmup_inst(uns, struct Warmup_Inst_struct*);
 
 /**************************************************************************************/
 
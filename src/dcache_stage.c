@@ -103,6 +103,7 @@ void init_dcache_stage(uns8 proc_id, const char* name) {
   dc->sd.name = (char*)name;
   dc->sd.max_op_count = STAGE_MAX_OP_COUNT;
   dc->sd.ops = (Op**)malloc(sizeof(Op*) * STAGE_MAX_OP_COUNT);
+  stage_data_init_age_order(&dc->sd);
 
   /* initialize the cache structure */
   init_cache(&dc->dcache, "DCACHE", DCACHE_SIZE, DCACHE_ASSOC, DCACHE_LINE_SIZE, sizeof(Dcache_Data), DCACHE_REPL);
@@ -129,6 +130,7 @@ void reset_dcache_stage(void) {
   for (ii = 0; ii < STAGE_MAX_OP_COUNT; ii++)
     dc->sd.ops[ii] = NULL;
   dc->sd.op_count = 0;
+  stage_data_age_order_clear(&dc->sd);
   dc->idle_cycle = 0;
 }
 
@@ -146,6 +148,7 @@ void recover_dcache_stage() {
       ASSERT(dc->proc_id, op->off_path);
       dc->sd.ops[ii] = NULL;
       dc->sd.op_count--;
+      stage_data_age_order_remove(&dc->sd, ii);
     }
   }
   dc->idle_cycle = cycle_count + 1;
@@ -181,6 +184,7 @@ void update_dcache_stage(Stage_Data* src_sd) {
       dc->sd.ops[ii] = NULL;
       dc->sd.op_count--;
       ASSERT(dc->proc_id, dc->sd.op_count >= 0);
+      stage_data_age_order_remove(&dc->sd, ii);
     }
 
     /* check if the op from the src_stage is ready */
@@ -202,35 +206,26 @@ void update_dcache_stage(Stage_Data* src_sd) {
     dc->sd.ops[ii] = op;
     dc->sd.op_count++;
     ASSERT(dc->proc_id, dc->sd.op_count <= dc->sd.max_op_count);
+    stage_data_age_order_insert(&dc->sd, ii);
     dcache_stage_remove_src_op(src_sd, ii);
     ASSERTM(dc->proc_id, cycle_count >= op_get_exec_cycle(op), "o:%s  %s\n", unsstr64(op->op_num),
             Op_State_str(op->state));
   }
 
   /* phase 2 - check the dcache port availability and do dcache access */
-  int start_op_count = dc->sd.op_count;
-  Counter last_oldest_op_num = 0;
-  for (uns ii = 0; ii < start_op_count; ii++) {
-    /* update in program order (make things easier) */
-    uns oldest_index = 0;
-    Counter oldest_op_num = MAX_CTR;
-    // TODO: adjust this O(n2) algorithm by getting the program order outside first
-    for (uns jj = 0; jj < dc->sd.max_op_count; jj++) {
-      if (dc->sd.ops[jj] && dc->sd.ops[jj]->op_num > last_oldest_op_num && dc->sd.ops[jj]->op_num < oldest_op_num) {
-        oldest_op_num = dc->sd.ops[jj]->op_num;
-        oldest_index = jj;
-      }
-    }
-    last_oldest_op_num = oldest_op_num;
-
-    ASSERT(dc->proc_id, oldest_op_num < MAX_CTR);
-    Op* op = dc->sd.ops[oldest_index];
+  /* update in program order (make things easier) */
+  ASSERT(dc->proc_id, dc->sd.age_order_count == dc->sd.op_count);
+  for (int pos = 0; pos < dc->sd.age_order_count; pos++) {
+    uns slot = dc->sd.age_order[pos];
+    Op* op = dc->sd.ops[slot];
 
     // if the op is replaying, squish it
     if (op->replay && op_get_exec_cycle(op) == MAX_CTR) {
-      dc->sd.ops[oldest_index] = NULL;
+      dc->sd.ops[slot] = NULL;
       dc->sd.op_count--;
       ASSERT(dc->proc_id, dc->sd.op_count >= 0);
+      stage_data_age_order_remove(&dc->sd, slot);
+      pos--;
       continue;
     }
 
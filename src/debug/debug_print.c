@@ -414,9 +414,11 @@ void print_short_op_array(FILE* stream, Op* ops[], uns array_length) {
 }
 
 /**************************************************************************************/
-/* disasm_op: */
+/* disasm_op_impl: when mem_placeholder is set, the load/store address
+   annotation is replaced by DISASM_MEM_PLACEHOLDER so the result only depends
+   on the static uop. */
 
-char* disasm_op(Op* op, Flag wide) {
+static char* disasm_op_impl(Op* op, Flag wide, Flag mem_placeholder) {
   static char buf[MAX_STR_LENGTH + 1];
 
   const char* opcode;
@@ -435,17 +437,38 @@ char* disasm_op(Op* op, Flag wide) {
   if (wide) {
     i += sprintf(&buf[i], "(");
     i += print_reg_array(&buf[i], op->uop->srcs, op->uop->num_src_regs);
-    if (op->uop->mem_type == MEM_LD && op->oracle_info.mem_size > 0) {
-      i += sprintf(&buf[i], " %d@%08x", op->oracle_info.mem_size, (int)op->oracle_info.va);
+    if (op->uop->mem_type == MEM_LD) {
+      if (mem_placeholder)
+        i += sprintf(&buf[i], "%c", DISASM_MEM_PLACEHOLDER);
+      else if (op->oracle_info.mem_size > 0)
+        i += sprintf(&buf[i], " %d@%08x", op->oracle_info.mem_size, (int)op->oracle_info.va);
     }
     if (op->uop->num_src_regs + op->uop->num_dest_regs > 0)
       i += sprintf(&buf[i], " ->");
     i += print_reg_array(&buf[i], op->uop->dests, op->uop->num_dest_regs);
-    if (op->uop->mem_type == MEM_ST && op->oracle_info.mem_size > 0) {
-      i += sprintf(&buf[i], " %d@%08x", op->oracle_info.mem_size, (int)op->oracle_info.va);
+    if (op->uop->mem_type == MEM_ST) {
+      if (mem_placeholder)
+        i += sprintf(&buf[i], "%c", DISASM_MEM_PLACEHOLDER);
+      else if (op->oracle_info.mem_size > 0)
+        i += sprintf(&buf[i], " %d@%08x", op->oracle_info.mem_size, (int)op->oracle_info.va);
     }
     i += sprintf(&buf[i], " )");
   }
 
   return buf;
 }
+
+/**************************************************************************************/
+/* disasm_op: */
+
+char* disasm_op(Op* op, Flag wide) {
+  return disasm_op_impl(op, wide, FALSE);
+}
+
+/**************************************************************************************/
+/* disasm_op_template: wide disassembly with the memory annotation left as a
+   placeholder (see DISASM_MEM_PLACEHOLDER). */
+
+char* disasm_op_template(Op* op) {
+  return disasm_op_impl(op, TRUE, TRUE);
+}
@@ -41,6 +41,13 @@ extern const char* const tcache_state_names[];
 extern const char* const cf_type_names[];
 extern const char* const sm_state_names[];
 
+/**************************************************************************************/
+/* Defines */
+
+/* Stands in for the " <size>@<addr>" load/store annotation of disasm_op() in
+   the strings returned by disasm_op_template() */
+#define DISASM_MEM_PLACEHOLDER '\001'
+
 /**************************************************************************************/
 /* Prototypes */
 
@@ -54,6 +61,7 @@ void print_op_field(FILE*, Op*, uns);
 void print_field_tail(FILE*, uns);
 void print_field_head(FILE*, uns);
 char* disasm_op(Op*, Flag wide);
+char* disasm_op_template(Op*);
 char* disasm_reg(uns);
 
 /**************************************************************************************/
@@ -0,0 +1,100 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : debug/host_prof.c
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Sampled host-time profiling of the simulator's own regions.
+ ***************************************************************************************/
+
+#include "debug/host_prof.h"
+
+#include <string.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+
+#include "debug/debug.param.h"
+
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Enums */
+
+DEFINE_ENUM(Host_Prof_Region, HOST_PROF_REGION_LIST);
+
+/**************************************************************************************/
+/* Global Variables */
+
+Flag host_prof_active = FALSE;
+uns64 host_prof_ticks[HOST_PROF_NUM_ELEMS];
+
+static uns64 host_prof_cycle_start;
+static uns64 host_prof_cycle_num;
+
+/**************************************************************************************/
+/* host_prof_init: */
+
+void host_prof_init(void) {
+  memset(host_prof_ticks, 0, sizeof(host_prof_ticks));
+  host_prof_active    = FALSE;
+  host_prof_cycle_num = 0;
+  if (!HOST_PROF)
+    return;
+
+  ASSERTM(0, HOST_PROF_SAMPLE_PERIOD > 0, "HOST_PROF_SAMPLE_PERIOD must be non-zero\n");
+  // the region stats are indexed by region, check they match the region list
+  for (uns ii = 0; ii < HOST_PROF_NUM_ELEMS; ii++) {
+    char name[MAX_STR_LENGTH + 1];
+    sprintf(name, "HOST_PROF_%s_TICKS", Host_Prof_Region_str(ii));
+    ASSERTM(0, !strcmp(global_stat_array[0][HOST_PROF_MEMORY_TICKS + ii].name, name),
+            "HOST_PROF stats out of order at %s\n", name);
+  }
+}
+
+/**************************************************************************************/
+/* host_prof_cycle_begin: */
+
+void host_prof_cycle_begin(void) {
+  if (!HOST_PROF)
+    return;
+  host_prof_active = ++host_prof_cycle_num % HOST_PROF_SAMPLE_PERIOD == 0;
+  if (host_prof_active)
+    host_prof_cycle_start = host_prof_now();
+}
+
+/**************************************************************************************/
+/* host_prof_cycle_end: host time is a property of the whole simulator, so it is
+   accounted to core 0's stats. */
+
+void host_prof_cycle_end(void) {
+  if (!host_prof_active)
+    return;
+
+  INC_STAT_EVENT(0, HOST_PROF_TOTAL_TICKS, host_prof_now() - host_prof_cycle_start);
+  STAT_EVENT(0, HOST_PROF_SAMPLED_CYCLES);
+  for (uns ii = 0; ii < HOST_PROF_NUM_ELEMS; ii++) {
+    INC_STAT_EVENT(0, HOST_PROF_MEMORY_TICKS + ii, host_prof_ticks[ii]);
+    host_prof_ticks[ii] = 0;
+  }
+  host_prof_active = FALSE;
+}
@@ -0,0 +1,110 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : debug/host_prof.h
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Sampled host-time profiling of the simulator's own regions
+ *                (pipeline stages, memory system, frontend).
+ ***************************************************************************************/
+
+#ifndef __HOST_PROF_H__
+#define __HOST_PROF_H__
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "globals/enum.h"
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Types */
+
+/* Regions may nest (e.g. FRONTEND_FETCH runs inside DECOUPLED_FE, and the
+   MEM_* regions inside MEMORY), so their times are inclusive. The HOST_PROF_*_TICKS
+   stats in core.stat.def must be kept in this order. */
+#define HOST_PROF_REGION_LIST(elem)                                                                        \
+  elem(MEMORY) elem(PREF) elem(MEM_QUEUES) elem(MEM_FILLS) elem(RAMULATOR) elem(MEM_REQS) elem(CORE_FILLS) \
+      elem(DCACHE) elem(EXEC) elem(NODE) elem(MAP) elem(IDQ) elem(UOP_QUEUE) elem(DECODE) elem(ICACHE)      \
+          elem(DECOUPLED_FE) elem(FDIP) elem(EIP) elem(FRONTEND_FETCH)
+
+DECLARE_ENUM(Host_Prof_Region, HOST_PROF_REGION_LIST, HOST_PROF_);
+
+/**************************************************************************************/
+/* Global Variables */
+
+extern Flag host_prof_active;  // TRUE only during sampled cycles
+extern uns64 host_prof_ticks[HOST_PROF_NUM_ELEMS];
+
+/**************************************************************************************/
+/* Macros */
+
+/* Wrap a statement so that its host time is accounted to region. Outside of
+   sampled cycles the cost is a single predictable branch. */
+#define HOST_PROF_REGION(region, stmt)                   \
+  do {                                                   \
+    uns64 host_prof_start_ = host_prof_begin();          \
+    stmt;                                                \
+    host_prof_end(HOST_PROF_##region, host_prof_start_); \
+  } while (0)
+
+/**************************************************************************************/
+/* Prototypes */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void host_prof_init(void);
+/* Decide whether the coming simulated cycle is sampled */
+void host_prof_cycle_begin(void);
+/* Move the sampled cycle's ticks into the stats */
+void host_prof_cycle_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+static inline uns64 host_prof_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uns64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static inline uns64 host_prof_begin(void) {
+  return host_prof_active ? host_prof_now() : 0;
+}
+
+static inline void host_prof_end(Host_Prof_Region region, uns64 start) {
+  if (start)
+    host_prof_ticks[region] += host_prof_now() - start;
+}
+
+/**************************************************************************************/
+
+#endif /* __HOST_PROF_H__ */
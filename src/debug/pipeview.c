@@ -28,10 +28,15 @@
 
 #include "debug/pipeview.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "globals/assert.h"
 #include "globals/global_defs.h"
+#include "globals/utils.h"
 
 #include "debug/debug_print.h"
+#include "libs/hash_lib.h"
 
 #include "core.param.h"
 #include "general.param.h"
@@ -46,12 +51,73 @@ O3PipeView:<event>:<timestamp>
 <event> can be map, issue, sched, etc.
 All events for a uop must be on consecutive lines
 
+Binary format (PIPEVIEW_BINARY, little-endian, see bin/pipeview_convert.py):
+Pipeview_Bin_Header, followed by records that each start with a one byte tag:
+'S' <uns32 id> <uns16 len> <len bytes>  disasm template (see disasm_op_template)
+'O' <Pipeview_Bin_Op>                    one retired or flushed op
+A template is always written before the first op that references it.
+
 ***************************************************************************************/
 
+/**************************************************************************************/
+/* Types: */
+
+#define PIPEVIEW_BIN_VERSION 2
+
+typedef enum Pipeview_Cycle_enum {
+  PV_FETCH,
+  PV_MAP,
+  PV_ISSUE,
+  PV_RDY,
+  PV_SCHED,
+  PV_EXEC,
+  PV_DCACHE,
+  PV_DONE,
+  PV_RETIRE,
+  PV_NOW,  // cycle_count when the op was printed (flush/end of off-path ops)
+  PV_NUM_CYCLES
+} Pipeview_Cycle;
+
+#define PV_FLAG_OFF_PATH 0x1
+#define PV_FLAG_SRCS_RDY 0x2
+
+typedef struct Pipeview_Bin_Header_struct {
+  char magic[8];  // "SCARABPV"
+  uns32 version;
+  uns32 proc_id;
+  uns32 decode_cycles;
+  uns32 map_cycles;
+} Pipeview_Bin_Header;
+
+typedef struct Pipeview_Bin_Op_struct {
+  uns64 unique_num;
+  uns64 addr;
+  uns64 va;
+  uns32 disasm_id;
+  uns32 mem_size;
+  uns8 uop_idx;
+  uns8 flags;
+  uns8 pad[6];
+  uns64 cycles[PV_NUM_CYCLES];
+} Pipeview_Bin_Op;
+
+typedef struct Pipeview_Disasm_struct {
+  char* text;
+  uns32 id;
+} Pipeview_Disasm;
+
+typedef struct Pipeview_File_struct {
+  FILE* file;
+  Flag is_pipe;
+  char* buf;
+  Hash_Table disasm_table;  // disasm template -> id, one namespace per file
+  uns32 num_disasm;
+} Pipeview_File;
+
 /**************************************************************************************/
 /* Global variables: */
 
-static FILE** files = NULL;
+static Pipeview_File* files = NULL;
 
 /**************************************************************************************/
 /* Constants: */
@@ -63,18 +129,26 @@ static const char* PREFIX = "O3PipeView";
 
 void print_header(FILE*, Op*);
 void print_event(FILE*, Op*, const char*, Counter);
+static void pipeview_open_binary(Pipeview_File*, uns);
+static void pipeview_write_binary_op(Pipeview_File*, Op*);
+static uns32 pipeview_get_disasm_id(Pipeview_File*, Op*);
+static Flag pipeview_disasm_eq(void const*, void const*);
 
 /**************************************************************************************/
 /* pipeview_init: */
 
 void pipeview_init(void) {
-  files = malloc(sizeof(FILE*) * NUM_CORES);
+  files = calloc(NUM_CORES, sizeof(Pipeview_File));
   if (PIPEVIEW) {
     for (uns proc_id = 0; proc_id < NUM_CORES; ++proc_id) {
-      char filename[MAX_STR_LENGTH + 1];
-      sprintf(filename, "%s.%d.trace", PIPEVIEW_FILE, proc_id);
-      files[proc_id] = fopen(filename, "w");
-      ASSERT(proc_id, files[proc_id]);
+      if (PIPEVIEW_BINARY) {
+        pipeview_open_binary(&files[proc_id], proc_id);
+      } else {
+        char filename[MAX_STR_LENGTH + 1];
+        sprintf(filename, "%s.%d.trace", PIPEVIEW_FILE, proc_id);
+        files[proc_id].file = fopen(filename, "w");
+      }
+      ASSERT(proc_id, files[proc_id].file);
     }
   }
 }
@@ -86,7 +160,12 @@ void pipeview_print_op(struct Op_struct* op) {
   if (!DEBUG_RANGE_COND(op->proc_id))
     return;
 
-  FILE* file = files[op->proc_id];
+  if (PIPEVIEW_BINARY) {
+    pipeview_write_binary_op(&files[op->proc_id], op);
+    return;
+  }
+
+  FILE* file = files[op->proc_id].file;
   print_header(file, op);
   if (op->off_path) {
     print_event(file, op, "fetch_offpath", op_get_fetch_cycle(op));
@@ -125,7 +204,15 @@ void pipeview_print_op(struct Op_struct* op) {
 void pipeview_done(void) {
   if (PIPEVIEW) {
     for (uns proc_id = 0; proc_id < NUM_CORES; ++proc_id) {
-      fclose(files[proc_id]);
+      Pipeview_File* pv = &files[proc_id];
+      if (pv->is_pipe) {
+        int status = pclose(pv->file);
+        if (status != 0)
+          FATAL_ERROR(proc_id, "Pipeview compressor '%s' failed (status %d)\n", PIPEVIEW_COMPRESSOR, status);
+      } else {
+        fclose(pv->file);
+      }
+      free(pv->buf);
     }
   }
 }
@@ -149,3 +236,113 @@ void print_header(FILE* file, Op* op) {
   fprintf(file, "%s:new:%lld:%llx:%d:%lld:%s\n", PREFIX, op_get_fetch_cycle(op), op->inst->addr, 0,
           op->unique_num_per_proc, disasm_op(op, TRUE));
 }
+
+/**************************************************************************************/
+/* pipeview_open_binary: opens the per-core binary stream. The records go through a
+   large stdio buffer and, when PIPEVIEW_COMPRESSOR is set, into a compressor
+   process that runs concurrently with the simulation. */
+
+static void pipeview_open_binary(Pipeview_File* pv, uns proc_id) {
+  char filename[MAX_STR_LENGTH + 1];
+  sprintf(filename, "%s.%d.pvb", PIPEVIEW_FILE, proc_id);
+
+  if (PIPEVIEW_COMPRESSOR && PIPEVIEW_COMPRESSOR[0]) {
+    // popen only fails if the shell cannot start, so check the compressor itself up front
+    char cmd[2 * MAX_STR_LENGTH + 1];
+    sprintf(cmd, "command -v %.*s > /dev/null 2>&1", (int)strcspn(PIPEVIEW_COMPRESSOR, " \t"), PIPEVIEW_COMPRESSOR);
+    if (system(cmd) != 0)
+      FATAL_ERROR(proc_id, "Pipeview compressor '%s' not found\n", PIPEVIEW_COMPRESSOR);
+    sprintf(cmd, "%s > %s", PIPEVIEW_COMPRESSOR, filename);
+    pv->file    = popen(cmd, "w");
+    pv->is_pipe = TRUE;
+  } else {
+    pv->file = fopen(filename, "wb");
+  }
+  ASSERTM(proc_id, pv->file, "Could not open pipeview file %s\n", filename);
+
+  if (PIPEVIEW_BUF_SIZE) {
+    pv->buf = malloc(PIPEVIEW_BUF_SIZE);
+    setvbuf(pv->file, pv->buf, _IOFBF, PIPEVIEW_BUF_SIZE);
+  }
+
+  init_complex_hash_table(&pv->disasm_table, "pipeview disasm", 1024, sizeof(Pipeview_Disasm), pipeview_disasm_eq);
+
+  Pipeview_Bin_Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "SCARABPV", sizeof(header.magic));
+  header.version       = PIPEVIEW_BIN_VERSION;
+  header.proc_id       = proc_id;
+  header.decode_cycles = DECODE_CYCLES;
+  header.map_cycles    = MAP_CYCLES;
+  fwrite(&header, sizeof(header), 1, pv->file);
+}
+
+/**************************************************************************************/
+/* pipeview_write_binary_op: binary counterpart of the text events in
+   pipeview_print_op. The derived events (decode, *_done, ready, end) are
+   reconstructed by the converter. */
+
+static void pipeview_write_binary_op(Pipeview_File* pv, Op* op) {
+  Pipeview_Bin_Op rec;
+  memset(&rec, 0, sizeof(rec));
+
+  rec.unique_num = op->unique_num_per_proc;
+  rec.addr       = op->inst->addr;
+  rec.va         = op->oracle_info.va;
+  rec.disasm_id  = pipeview_get_disasm_id(pv, op);
+  rec.uop_idx    = op->uop->uop_seq_num;
+  rec.mem_size   = op->oracle_info.mem_size;
+  if (op->off_path)
+    rec.flags |= PV_FLAG_OFF_PATH;
+  if (op_sources_not_rdy_is_clear(op))
+    rec.flags |= PV_FLAG_SRCS_RDY;
+  else
+    ASSERT(op->proc_id, op->off_path);
+  if (!op->off_path)
+    ASSERT(op->proc_id, op_get_retire_cycle(op) <= cycle_count);
+
+  rec.cycles[PV_FETCH]  = op_get_fetch_cycle(op);
+  rec.cycles[PV_MAP]    = op_get_map_cycle(op);
+  rec.cycles[PV_ISSUE]  = op_get_issue_cycle(op);
+  rec.cycles[PV_RDY]    = op_get_rdy_cycle(op);
+  rec.cycles[PV_SCHED]  = op_get_sched_cycle(op);
+  rec.cycles[PV_EXEC]   = op_get_exec_cycle(op);
+  rec.cycles[PV_DCACHE] = op_get_dcache_cycle(op);
+  rec.cycles[PV_DONE]   = op_get_done_cycle(op);
+  rec.cycles[PV_RETIRE] = op_get_retire_cycle(op);
+  rec.cycles[PV_NOW]    = cycle_count;
+
+  fputc('O', pv->file);
+  fwrite(&rec, sizeof(rec), 1, pv->file);
+}
+
+/**************************************************************************************/
+/* pipeview_get_disasm_id: returns the id of the op's disasm template, writing
+   a definition record the first time the template is seen. */
+
+static uns32 pipeview_get_disasm_id(Pipeview_File* pv, Op* op) {
+  Pipeview_Disasm probe;
+  probe.text = disasm_op_template(op);
+
+  uns64 key = 14695981039346656037ULL;  // FNV-1a
+  for (const char* c = probe.text; *c; ++c)
+    key = (key ^ (uns8)*c) * 1099511628211ULL;
+
+  Flag new_entry;
+  Pipeview_Disasm* entry = complex_hash_table_access_create(&pv->disasm_table, key, &probe, &new_entry);
+  if (new_entry) {
+    entry->text = strdup(probe.text);
+    entry->id   = pv->num_disasm++;
+
+    uns16 len = strlen(entry->text);
+    fputc('S', pv->file);
+    fwrite(&entry->id, sizeof(entry->id), 1, pv->file);
+    fwrite(&len, sizeof(len), 1, pv->file);
+    fwrite(entry->text, 1, len, pv->file);
+  }
+  return entry->id;
+}
+
+static Flag pipeview_disasm_eq(void const* entry, void const* probe) {
+  return !strcmp(((Pipeview_Disasm const*)entry)->text, ((Pipeview_Disasm const*)probe)->text);
+}
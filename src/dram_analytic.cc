@@ -0,0 +1,145 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : dram_analytic.cc
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Analytic DRAM timing model (see dram_analytic.h)
+ ***************************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include "globals/assert.h"
+#include "globals/utils.h"
+
+#include "ramulator.param.h"
+
+#include "statistics.h"
+}
+
+#include "dram_analytic.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define DDR_PREFETCH_SIZE 8  // column accesses per burst, as in Ramulator's DDR4 spec
+
+/**************************************************************************************/
+
+Dram_Analytic::Dram_Analytic(bool count_power_events) : count_power_events(count_power_events) {
+  ASSERTM(0, RAMULATOR_COLS > DDR_PREFETCH_SIZE, "dram_analytic: too few columns (%u)\n", RAMULATOR_COLS);
+  tx_bits = LOG2(DDR_PREFETCH_SIZE * BUS_WIDTH_IN_BYTES);
+  channel_bits = LOG2(RAMULATOR_CHANNELS);
+  column_bits = LOG2(RAMULATOR_COLS) - LOG2(DDR_PREFETCH_SIZE);
+  rank_bits = LOG2(RAMULATOR_RANKS);
+  bankgroup_bits = LOG2(RAMULATOR_BANKGROUPS);
+  bank_bits = LOG2(RAMULATOR_BANKS);
+  banks_per_channel = RAMULATOR_RANKS * RAMULATOR_BANKGROUPS * RAMULATOR_BANKS;
+
+  banks.resize(RAMULATOR_CHANNELS * banks_per_channel);
+  channels.resize(RAMULATOR_CHANNELS);
+
+  offset[ROW_HIT] = DRAM_ANALYTIC_HIT_OFFSET;
+  offset[ROW_CLOSED] = DRAM_ANALYTIC_CLOSED_OFFSET;
+  offset[ROW_CONFLICT] = DRAM_ANALYTIC_CONFLICT_OFFSET;
+  queue_scale = DRAM_ANALYTIC_QUEUE_SCALE;
+}
+
+/* Same bit order as Ramulator's RoBaRaCoCh mapping with use_rest_of_addr_as_row_addr: channel, column, rank,
+ * bank group and bank from the low bits up, and everything above them is the row. */
+void Dram_Analytic::decode(uns64 addr, uns* channel, uns* bank, int64* row) const {
+  addr >>= tx_bits;
+  *channel = addr & N_BIT_MASK(channel_bits);
+  addr >>= channel_bits + column_bits;
+  uns rank = addr & N_BIT_MASK(rank_bits);
+  addr >>= rank_bits;
+  uns bankgroup = addr & N_BIT_MASK(bankgroup_bits);
+  addr >>= bankgroup_bits;
+  uns bank_in_group = addr & N_BIT_MASK(bank_bits);
+  addr >>= bank_bits;
+  *bank = *channel * banks_per_channel + (rank * RAMULATOR_BANKGROUPS + bankgroup) * RAMULATOR_BANKS + bank_in_group;
+  *row = (int64)addr;
+}
+
+uns Dram_Analytic::channel_of(uns64 addr) const {
+  return (addr >> tx_bits) & N_BIT_MASK(channel_bits);
+}
+
+bool Dram_Analytic::can_accept(uns64 addr, bool is_write, Counter cycle) {
+  Channel& ch = channels[channel_of(addr)];
+  auto& queue = is_write ? ch.writes : ch.reads;
+  while (!queue.empty() && queue.top() <= cycle)
+    queue.pop();
+  return queue.size() < (is_write ? RAMULATOR_WRITEQ_ENTRIES : RAMULATOR_READQ_ENTRIES);
+}
+
+Dram_Analytic::Access Dram_Analytic::access(uns64 addr, bool is_write, uns proc_id, Counter cycle) {
+  uns channel_id, bank_id;
+  int64 row;
+  decode(addr, &channel_id, &bank_id, &row);
+  Channel& ch = channels[channel_id];
+  Bank& bank = banks[bank_id];
+  Access result;
+
+  Counter start = MAX2(cycle, bank.ready);
+  Counter column = start;
+  if (bank.open_row == row) {
+    result.outcome = ROW_HIT;
+  } else {
+    Counter activate = start;
+    if (bank.open_row >= 0) {
+      result.outcome = ROW_CONFLICT;
+      activate = MAX2(start, bank.act_cycle + RAMULATOR_TRAS) + RAMULATOR_TRP;
+      if (count_power_events)
+        STAT_EVENT(proc_id, POWER_DRAM_PRECHARGE);
+    } else {
+      result.outcome = ROW_CLOSED;
+    }
+    if (count_power_events)
+      STAT_EVENT(proc_id, POWER_DRAM_ACTIVATE);
+    bank.open_row = row;
+    bank.act_cycle = activate;
+    column = activate + RAMULATOR_TRCD;
+  }
+  if (!is_write)
+    column = MAX2(column, ch.write_end + RAMULATOR_TWTR);
+
+  Counter cas = is_write ? RAMULATOR_TCWL : RAMULATOR_TCL;
+  Counter data_start = MAX2(column + cas, ch.bus_free);
+  Counter data_end = data_start + RAMULATOR_TBL;
+  ch.bus_free = data_end;
+  if (is_write)
+    ch.write_end = data_end;
+  bank.ready = data_start - cas + RAMULATOR_TCCD;
+  if (count_power_events)
+    STAT_EVENT(proc_id, is_write ? POWER_DRAM_WRITE : POWER_DRAM_READ);
+
+  result.queue = (start - cycle) + (data_start - column - cas);
+  result.base = data_end - cycle - result.queue;
+  int64 latency = (int64)result.base + offset[result.outcome] + llround(queue_scale * result.queue);
+  result.done = cycle + MAX2(latency, (int64)1);
+
+  (is_write ? ch.writes : ch.reads).push(result.done);
+  return result;
+}
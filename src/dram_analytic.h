@@ -0,0 +1,92 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : dram_analytic.h
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Analytic DRAM timing model, selected with --dram_model analytic as a
+ *                fast alternative to Ramulator.
+ *
+ *                Every request is timed once, when it is enqueued: the model keeps the
+ *                open row and the earliest next command of every bank and the data bus
+ *                occupancy of every channel, so the latency covers row hits, closed rows,
+ *                row conflicts, bank/bus queueing and read-after-write turnaround. The
+ *                latency is the unqueued command timing plus a per-outcome offset plus a
+ *                scaled queueing delay; the offsets and the scale are fit against
+ *                Ramulator with --dram_analytic_calibrate (see ramulator.cc).
+ ***************************************************************************************/
+
+#ifndef __DRAM_ANALYTIC_H__
+#define __DRAM_ANALYTIC_H__
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "globals/global_types.h"
+
+class Dram_Analytic {
+ public:
+  enum Outcome { ROW_HIT, ROW_CLOSED, ROW_CONFLICT, NUM_OUTCOMES };
+
+  struct Access {
+    Counter done;     // DRAM cycle the data transfer ends, after calibration
+    Outcome outcome;
+    Counter base;     // unqueued command timing, in DRAM cycles
+    Counter queue;    // cycles spent waiting for the bank or the data bus
+  };
+
+  /* count_power_events is false when Ramulator already counts them (calibration) */
+  explicit Dram_Analytic(bool count_power_events);
+
+  /* False if the read (write) queue of the channel holding addr is full at cycle */
+  bool can_accept(uns64 addr, bool is_write, Counter cycle);
+  /* Times the request issued at cycle and updates the bank and channel state */
+  Access access(uns64 addr, bool is_write, uns proc_id, Counter cycle);
+
+ private:
+  struct Bank {
+    int64 open_row = -1;
+    Counter act_cycle = 0;
+    Counter ready = 0;  // earliest cycle of the next column command
+  };
+
+  struct Channel {
+    Counter bus_free = 0;
+    Counter write_end = 0;  // end of the last write burst, for tWTR
+    // completion cycles of the requests holding a queue entry
+    std::priority_queue<Counter, std::vector<Counter>, std::greater<Counter>> reads, writes;
+  };
+
+  uns channel_of(uns64 addr) const;
+  void decode(uns64 addr, uns* channel, uns* bank, int64* row) const;
+
+  uns tx_bits, channel_bits, column_bits, rank_bits, bankgroup_bits, bank_bits;
+  uns banks_per_channel;
+  std::vector<Bank> banks;
+  std::vector<Channel> channels;
+  int64 offset[NUM_OUTCOMES];
+  double queue_scale;
+  bool count_power_events;
+};
+
+#endif  // __DRAM_ANALYTIC_H__
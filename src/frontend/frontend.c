@@ -32,6 +32,8 @@
 #include "globals/global_defs.h"
 #include "globals/global_vars.h"
 
+#include "debug/host_prof.h"
+
 #include "core.param.h"
 #include "general.param.h"
 
@@ -115,7 +117,7 @@ Flag frontend_can_fetch_op(uns proc_id, uns bp_id) {
 }
 
 void frontend_fetch_op(uns proc_id, uns bp_id, Op* op) {
-  frontend->fetch_op(proc_id, bp_id, op);
+  HOST_PROF_REGION(FRONTEND_FETCH, frontend->fetch_op(proc_id, bp_id, op));
 }
 
 void frontend_redirect(uns proc_id, uns bp_id, uns64 inst_uid, Addr fetch_addr) {
@@ -138,6 +140,12 @@ void frontend_retire(uns proc_id, uns64 inst_uid) {
   DEBUG(proc_id, "Retiring inst_uid %lld end\n", inst_uid);
 }
 
+Flag frontend_warmup_inst(uns proc_id, Warmup_Inst* inst) {
+  if (!frontend->warmup_inst)
+    return FALSE;
+  return frontend->warmup_inst(proc_id, inst);
+}
+
 void collect_op_stats(Op* op) {
   if (!op->off_path) {
     STAT_EVENT(op->proc_id, ST_OP_ONPATH);
@@ -30,6 +30,22 @@
 
 #include "globals/global_types.h"
 
+#include "ctype_pin_inst.h"
+
+/*************************************************************/
+/* Types */
+
+/* An on-path instruction reduced to what functional warmup touches: its fetch
+   address and the addresses of its demand loads and stores (cmp addresses) */
+typedef struct Warmup_Inst_struct {
+  Addr addr;
+  uns num_ld;
+  uns num_st;
+  Addr ld_va[MAX_LD_NUM];
+  Addr st_va[MAX_ST_NUM];
+  Flag exit;  // last instruction of the program
+} Warmup_Inst;
+
 /*************************************************************/
 /* External frontend interface */
 
@@ -59,6 +75,12 @@ void frontend_recover(uns proc_id, uns bp_id, uns64 inst_uid);
 /* Let the frontend know that this instruction is retired) */
 void frontend_retire(uns proc_id, uns64 inst_uid);
 
+/* Consume the next on-path instruction as a Warmup_Inst without generating its
+   uops. Returns FALSE, consuming nothing, when the frontend has no such path or
+   the instruction needs its uops (e.g. it trains the branch predictor); fetch
+   it with frontend_fetch_op then. */
+Flag frontend_warmup_inst(uns proc_id, Warmup_Inst* inst);
+
 /* Collect statistics for the given op */
 void collect_op_stats(Op* op);
 
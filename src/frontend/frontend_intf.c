@@ -41,14 +41,15 @@
 #endif
 
 Frontend_Impl frontend_table[] = {
-#define FRONTEND_IMPL(id, name, prefix) \
-  {name,                                \
-   prefix##_next_fetch_addr,            \
-   prefix##_can_fetch_op,               \
-   prefix##_fetch_op,                   \
-   prefix##_redirect,                   \
-   prefix##_recover,                    \
-   prefix##_retire},
+#define FRONTEND_IMPL(id, name, prefix, warmup_inst) \
+  {name,                                             \
+   prefix##_next_fetch_addr,                         \
+   prefix##_can_fetch_op,                            \
+   prefix##_fetch_op,                                \
+   prefix##_redirect,                                \
+   prefix##_recover,                                 \
+   prefix##_retire,                                  \
+   warmup_inst},
 #include "frontend/frontend_table.def"
 #undef FRONTEND_IMPL
 };
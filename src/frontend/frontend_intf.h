@@ -34,6 +34,7 @@
 /* Forward Declarations */
 
 struct Op_struct;
+struct Warmup_Inst_struct;
 
 /*************************************************************/
 /* External frontend interface */
@@ -64,10 +65,14 @@ typedef struct Frontend_Intf_struct {
 
   /* Let the frontend know that this instruction is retired) */
   void (*retire)(uns proc_id, uns64 inst_uid);
+
+  /* Consume the next on-path instruction without generating its uops (may be
+     NULL, see frontend_warmup_inst) */
+  Flag (*warmup_inst)(uns proc_id, struct Warmup_Inst_struct* inst);
 } Frontend_Impl;
 
 typedef enum Frontend_Id_enum {
-#define FRONTEND_IMPL(id, name, prefix) FE_##id,
+#define FRONTEND_IMPL(id, name, prefix, warmup_inst) FE_##id,
 #include "frontend/frontend_table.def"
 #undef FRONTEND_IMPL
   NUM_FRONTENDS
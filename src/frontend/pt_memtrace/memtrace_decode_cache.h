@@ -0,0 +1,104 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : frontend/pt_memtrace/memtrace_decode_cache.h
+ * Author       : HPS Research Group
+ * Date         : 10/19/2026
+ * Description  : Bounded per-reader cache of decoded static instructions, keyed by PC.
+ *                Buffered InstInfos point into the entries, so the caller passes an
+ *                in_use predicate and referenced entries are never freed.
+ ***************************************************************************************/
+
+#ifndef MEMTRACE_DECODE_CACHE_H
+#define MEMTRACE_DECODE_CACHE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+template <typename Entry>
+class MemtraceDecodeCache {
+ public:
+  // max_entries == 0 leaves the cache unbounded
+  explicit MemtraceDecodeCache(size_t max_entries) : max_entries_(max_entries) {}
+
+  Entry* find(uint64_t pc) {
+    auto iter = map_.find(pc);
+    return iter == map_.end() ? nullptr : iter->second.get();
+  }
+
+  Entry* emplace(uint64_t pc, Entry&& entry) {
+    auto& slot = map_[pc];
+    slot.reset(new Entry(std::move(entry)));
+    return slot.get();
+  }
+
+  // Drops the entry at pc (new code at the PC). An entry that is still
+  // referenced is moved aside and freed once in_use no longer holds for it.
+  template <typename InUse>
+  void invalidate(uint64_t pc, InUse in_use) {
+    auto iter = map_.find(pc);
+    if (iter == map_.end())
+      return;
+    if (in_use(iter->second.get()))
+      retired_.push_back(std::move(iter->second));
+    map_.erase(iter);
+  }
+
+  // Evicts one unreferenced entry if the cache is full. Victims are taken
+  // round-robin over the hash buckets. Returns true if an entry was evicted.
+  template <typename InUse>
+  bool makeRoom(InUse in_use) {
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                  [&in_use](const std::unique_ptr<Entry>& entry) { return !in_use(entry.get()); }),
+                   retired_.end());
+    if (!max_entries_ || map_.size() < max_entries_)
+      return false;
+    const size_t num_buckets = map_.bucket_count();
+    for (size_t ii = 0; ii < num_buckets; ii++) {
+      const size_t bucket = evict_bucket_++ % num_buckets;
+      auto victim = std::find_if(map_.begin(bucket), map_.end(bucket),
+                                 [&in_use](const auto& entry) { return !in_use(entry.second.get()); });
+      if (victim != map_.end(bucket)) {
+        map_.erase(victim->first);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  size_t size() const { return map_.size(); }
+  size_t retired() const { return retired_.size(); }
+
+ private:
+  size_t max_entries_;
+  size_t evict_bucket_ = 0;
+  // Entries are heap-allocated so their addresses survive rehashing and retirement
+  std::unordered_map<uint64_t, std::unique_ptr<Entry>> map_;
+  std::vector<std::unique_ptr<Entry>> retired_;
+};
+
+#endif
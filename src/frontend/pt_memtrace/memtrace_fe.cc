@@ -199,7 +199,7 @@ int memtrace_trace_read(int proc_id, ctype_pin_inst* next_onpath_pi) {
   } while (insi->pid != prior_pid || insi->tid != prior_tid);
 
   // Static info (basic_info, deps, simd, cf, etc.) is pre-built in
-  // processInst / processDrIsaInst and cached via ctype_inst_map.
+  // processInst / processDrIsaInst and cached in the reader's decode cache.
   assert(insi->info != nullptr);
   memcpy(next_onpath_pi, insi->info, sizeof(ctype_pin_inst));
   fill_in_dynamic_info(next_onpath_pi, insi);
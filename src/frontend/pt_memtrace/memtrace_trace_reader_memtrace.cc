@@ -28,6 +28,7 @@
 
 #include "frontend/pt_memtrace/memtrace_trace_reader_memtrace.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -300,7 +301,8 @@ TraceReaderMemtrace::TraceReaderMemtrace(const std::string& _trace, uint32_t _bu
       mt_seq_(0),
       mt_prior_isize_(0),
       mt_using_info_a_(true),
-      mt_warn_target_(0) {
+      mt_warn_target_(0),
+      decode_cache_(MEMTRACE_DECODE_CACHE_ENTRIES) {
   init(_trace);
 }
 
@@ -308,6 +310,10 @@ TraceReaderMemtrace::~TraceReaderMemtrace() {
   if (mt_warn_target_ > 0) {
     warn("Set %lu conditional branches to 'not-taken' due to pid/tid gaps\n", mt_warn_target_);
   }
+  if (decode_cache_hits_ + decode_cache_misses_ > 0) {
+    warn("Decode cache: %lu hits, %lu misses, %lu invalidated by new encodings, %lu evicted\n", decode_cache_hits_,
+         decode_cache_misses_, decode_cache_invalidations_, decode_cache_evictions_);
+  }
 }
 
 void TraceReaderMemtrace::init(const std::string& _trace) {
@@ -407,6 +413,7 @@ bool TraceReaderMemtrace::initTrace() {
   if (type & dynamorio::drmemtrace::OFFLINE_FILE_TYPE_ARCH_REGDEPS) {
     dr_isa_mode_t dummy;
     dr_set_isa_mode(dcontext_, DR_ISA_REGDEPS, &dummy);
+    is_regdeps_ = true;
   } else {
     warn(
         "Warning: Scarab expects the trace file type to include OFFLINE_FILE_TYPE_ARCH_REGDEPS (0x%lx), but got "
@@ -417,6 +424,11 @@ bool TraceReaderMemtrace::initTrace() {
   // Handle region of interest (instruction-count based)
   if (MEMTRACE_ROI_BEGIN) {
     ASSERT(0, MEMTRACE_ROI_BEGIN < MEMTRACE_ROI_END || MEMTRACE_ROI_END == 0);
+    // zipfile traces skip whole chunks by seeking to the chunk's archive component; the other
+    // formats decompress and walk every record up to the ROI
+    if (!dynamic_cast<zipfile_file_reader_t*>(reader_.get()))
+      warn("Skipping %lu instructions of a non-zip trace linearly, zip chunked traces seek faster\n",
+           (unsigned long)(MEMTRACE_ROI_BEGIN - 1));
     reader_->skip_instructions(static_cast<uint64_t>(MEMTRACE_ROI_BEGIN) - 1);
     roi_end_ = MEMTRACE_ROI_END ? static_cast<uint64_t>(MEMTRACE_ROI_END) : 0;
   }
@@ -428,7 +440,35 @@ bool TraceReaderMemtrace::initTrace() {
   return true;
 }
 
-std::unordered_map<uint64_t, std::tuple<int, bool, bool, bool, ctype_pin_inst>> ctype_inst_map;
+// An entry is referenced by the prior instruction until its branch target is
+// patched, and by every InstInfo copied into ins_buffer until it is consumed.
+bool TraceReaderMemtrace::decodeEntryInUse(const DecodeEntry* _entry, const InstInfo* _prior) const {
+  const ctype_pin_inst* inst = &std::get<MAP_XED>(*_entry);
+  if (_prior->info == inst)
+    return true;
+  return std::any_of(ins_buffer.begin(), ins_buffer.end(), [inst](const InstInfo& buf) { return buf.info == inst; });
+}
+
+// Looks up the decoded entry for the current instruction record. Returns false
+// if processInst/processDrIsaInst must (re)build it: first sight of the PC, an
+// entry evicted by the MEMTRACE_DECODE_CACHE_ENTRIES bound, or new code at the PC
+// (DR sets encoding_is_new when the bytes at a PC change, e.g. self-modifying code).
+bool TraceReaderMemtrace::lookupDecodeCache(const InstInfo* _prior) {
+  DecodeEntry* entry = decode_cache_.find(mt_ref_.instr.addr);
+  if (entry && !mt_ref_.instr.encoding_is_new) {
+    decode_cache_hits_++;
+    return true;
+  }
+  auto in_use = [this, _prior](const DecodeEntry* _entry) { return decodeEntryInUse(_entry, _prior); };
+  decode_cache_misses_++;
+  if (entry) {
+    decode_cache_invalidations_++;
+    decode_cache_.invalidate(mt_ref_.instr.addr, in_use);
+  }
+  if (decode_cache_.makeRoom(in_use))
+    decode_cache_evictions_++;
+  return false;
+}
 
 bool TraceReaderMemtrace::getNextInstruction__(InstInfo* _info, InstInfo* _prior) {
   uint32_t prior_isize = mt_prior_isize_;
@@ -450,13 +490,17 @@ bool TraceReaderMemtrace::getNextInstruction__(InstInfo* _info, InstInfo* _prior
     switch (mt_state_) {
       case (MTState::INST):
         if (type_is_instr(mt_ref_.instr.type)) {
-          instr_reset(dcontext_, &probe.instr);
-          decode(dcontext_, mt_ref_.instr.encoding, &probe.instr);
-          const bool is_regdeps = (instr_get_isa_mode(&probe.instr) == DR_ISA_REGDEPS);
-          if (is_regdeps) {
-            processDrIsaInst(_info, 0, &probe.instr);
+          // The DR decode is only consumed when a REGDEPS entry is (re)built;
+          // XED traces are decoded by processInst itself on a cache miss.
+          const bool cached = lookupDecodeCache(_prior);
+          if (is_regdeps_) {
+            if (!cached) {
+              instr_reset(dcontext_, &probe.instr);
+              decode(dcontext_, mt_ref_.instr.encoding, &probe.instr);
+            }
+            processDrIsaInst(_info, 0, cached ? nullptr : &probe.instr);
           } else {
-            processInst(_info, &probe.instr);
+            processInst(_info, nullptr);
           }
           if (mt_mem_ops_ > 0) {
             mt_state_ = MTState::MEM1;
@@ -467,8 +511,8 @@ bool TraceReaderMemtrace::getNextInstruction__(InstInfo* _info, InstInfo* _prior
           // a repeated rep — MAP_REP is not set for DR_ISA_REGDEPS (see processDrIsaInst tuple), so only assert for XED
           // path
           if (!_prior->is_dr_ins) {
-            bool is_rep = std::get<MAP_REP>(ctype_inst_map.at(_prior->pc));
-            assert(is_rep && ((uint32_t)mt_ref_.instr.pid == _prior->pid) &&
+            [[maybe_unused]] const DecodeEntry* prior_entry = decode_cache_.find(_prior->pc);
+            assert(prior_entry && std::get<MAP_REP>(*prior_entry) && ((uint32_t)mt_ref_.instr.pid == _prior->pid) &&
                    ((uint32_t)mt_ref_.instr.tid == _prior->tid) && (mt_ref_.instr.addr == _prior->pc));
           }
           // do not need to re-process
@@ -559,8 +603,8 @@ PATCH_REP:
   _info->valid &= complete;
   // Compute the branch target information for the prior instruction
   if (_info->valid) {
-    auto ctype_prior_iter = ctype_inst_map.find(_prior->pc);
-    bool is_rep = (ctype_prior_iter != ctype_inst_map.end()) ? std::get<MAP_REP>(ctype_prior_iter->second) : false;
+    const DecodeEntry* prior_entry = decode_cache_.find(_prior->pc);
+    bool is_rep = prior_entry ? std::get<MAP_REP>(*prior_entry) : false;
     bool non_seq = _info->pc != (_prior->pc + prior_isize);
 
     if (_prior->taken) {  // currently set iif branch
@@ -899,35 +943,30 @@ void TraceReaderMemtrace::processDrIsaInst(InstInfo* _info, bool has_another_mem
   assert(mt_ref_.instr.size);
   bool unknown_type, cond_branch;
   _info->pc = mt_ref_.instr.addr;
-  if (mt_ref_.instr.encoding_is_new) {
-    ctype_inst_map.erase(mt_ref_.instr.addr);
-  }
-  auto ctype_inst_iter = ctype_inst_map.find(mt_ref_.instr.addr);
-  if (mt_ref_.instr.encoding_is_new) {
+  DecodeEntry* entry = decode_cache_.find(mt_ref_.instr.addr);
+  if (!entry) {
     assert(predecoded != nullptr);
     ctype_pin_inst cinst = {};
 
     fill_in_basic_info(&cinst, predecoded, mt_ref_.instr.size, mt_ref_.instr.type);
     add_dependency_info(&cinst, predecoded);
     cinst.encoding_is_new = mt_ref_.instr.encoding_is_new;
-    ctype_inst_map.emplace(mt_ref_.instr.addr,
-                           std::make_tuple(cinst.num_ld + cinst.num_st, false, cinst.cf_type, false, cinst));
-    ctype_inst_iter = ctype_inst_map.find(mt_ref_.instr.addr);
+    entry = decode_cache_.emplace(mt_ref_.instr.addr,
+                                  std::make_tuple(cinst.num_ld + cinst.num_st, false, cinst.cf_type, false, cinst));
   } else {
-    assert(ctype_inst_iter != ctype_inst_map.end());
-    std::get<MAP_XED>(ctype_inst_iter->second).encoding_is_new = mt_ref_.instr.encoding_is_new;
+    std::get<MAP_XED>(*entry).encoding_is_new = mt_ref_.instr.encoding_is_new;
   }
 
-  tie(mt_mem_ops_, unknown_type, cond_branch, std::ignore, std::ignore) = ctype_inst_iter->second;
+  tie(mt_mem_ops_, unknown_type, cond_branch, std::ignore, std::ignore) = *entry;
   mt_prior_isize_ = mt_ref_.instr.size;
   _info->is_dr_ins = true;
-  _info->info = &(std::get<MAP_XED>(ctype_inst_iter->second));
+  _info->info = &(std::get<MAP_XED>(*entry));
   _info->pid = mt_ref_.instr.pid;
   _info->tid = mt_ref_.instr.tid;
   _info->target = 0;  // Set when the next instruction is evaluated
   // Set as taken if it's a branch.
   // Conditional branches are patched when the next instruction is evaluated.
-  _info->taken = std::get<MAP_XED>(ctype_inst_iter->second).cf_type;
+  _info->taken = std::get<MAP_XED>(*entry).cf_type;
   _info->mem_addr[0] = 0;
   _info->mem_addr[1] = 0;
   _info->mem_used[0] = false;
@@ -945,15 +984,12 @@ void TraceReaderMemtrace::processDrIsaInst(InstInfo* _info, bool has_another_mem
 }
 
 void TraceReaderMemtrace::processInst(InstInfo* _info, [[maybe_unused]] instr_t* predecoded_dr) {
-  // Same bytes as predecoded_dr; XED decode below is still required for mem-op/REP/SIMD/x87/cf helpers.
+  // XED decode below is required for mem-op/REP/SIMD/x87/cf helpers; predecoded_dr is not used.
   _info->pc = mt_ref_.instr.addr;
   mt_prior_isize_ = mt_ref_.instr.size;
 
-  if (mt_ref_.instr.encoding_is_new) {
-    ctype_inst_map.erase(mt_ref_.instr.addr);
-  }
-  auto ctype_inst_iter = ctype_inst_map.find(mt_ref_.instr.addr);
-  if (ctype_inst_iter == ctype_inst_map.end()) {
+  DecodeEntry* entry = decode_cache_.find(mt_ref_.instr.addr);
+  if (!entry) {
     // XED decode into a stack-local inst (only the ctype_pin_inst is cached)
     xed_decoded_inst_t xed_inst;
     xed_decoded_inst_zero_set_mode(&xed_inst, &xed_state_);
@@ -1018,22 +1054,21 @@ void TraceReaderMemtrace::processInst(InstInfo* _info, [[maybe_unused]] instr_t*
     fill_in_cf_info(&cinst, xed_ins);
     cinst.encoding_is_new = mt_ref_.instr.encoding_is_new;
 
-    ctype_inst_map.emplace(mt_ref_.instr.addr,
-                           std::make_tuple(n_used_mem_ops, unknown_type, cinst.cf_type != NOT_CF, is_rep, cinst));
-    ctype_inst_iter = ctype_inst_map.find(mt_ref_.instr.addr);
+    entry = decode_cache_.emplace(
+        mt_ref_.instr.addr, std::make_tuple(n_used_mem_ops, unknown_type, cinst.cf_type != NOT_CF, is_rep, cinst));
   } else {
-    std::get<MAP_XED>(ctype_inst_iter->second).encoding_is_new = mt_ref_.instr.encoding_is_new;
+    std::get<MAP_XED>(*entry).encoding_is_new = mt_ref_.instr.encoding_is_new;
   }
 
   bool unknown_type, cond_branch;
-  tie(mt_mem_ops_, unknown_type, cond_branch, std::ignore, std::ignore) = ctype_inst_iter->second;
+  tie(mt_mem_ops_, unknown_type, cond_branch, std::ignore, std::ignore) = *entry;
 
   _info->is_dr_ins = false;
-  _info->info = &(std::get<MAP_XED>(ctype_inst_iter->second));
+  _info->info = &(std::get<MAP_XED>(*entry));
   _info->pid = mt_ref_.instr.pid;
   _info->tid = mt_ref_.instr.tid;
   _info->target = 0;
-  _info->taken = std::get<MAP_XED>(ctype_inst_iter->second).cf_type != NOT_CF;
+  _info->taken = std::get<MAP_XED>(*entry).cf_type != NOT_CF;
   _info->mem_addr[0] = 0;
   _info->mem_addr[1] = 0;
   _info->mem_used[0] = false;
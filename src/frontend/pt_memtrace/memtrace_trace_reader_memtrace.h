@@ -30,6 +30,7 @@
 
 #include "globals/assert.h"
 
+#include "frontend/pt_memtrace/memtrace_decode_cache.h"
 #include "frontend/pt_memtrace/memtrace_trace_reader.h"
 
 #undef ASSERT
@@ -41,9 +42,14 @@
 
 class TraceReaderMemtrace : public TraceReader {
  public:
+  // (memory ops, unknown type, cond/cf, rep, decoded inst), indexed by MAP_*
+  using DecodeEntry = std::tuple<int, bool, bool, bool, ctype_pin_inst>;
+
   const InstInfo* getNextInstruction() override;
   TraceReaderMemtrace(const std::string& _trace, uint32_t _bufsize);
   ~TraceReaderMemtrace();
+  uint64_t decodeCacheEvictions() const { return decode_cache_evictions_; }
+  uint64_t decodeCacheInvalidations() const { return decode_cache_invalidations_; }
 
  private:
   bool initTrace() override;
@@ -51,6 +57,8 @@ class TraceReaderMemtrace : public TraceReader {
   void init(const std::string& _trace);
   static const char* parse_buildid_string(const char* src, OUT void** data);
   bool getNextInstruction__(InstInfo* _info, InstInfo* _prior);
+  bool lookupDecodeCache(const InstInfo* _prior);
+  bool decodeEntryInUse(const DecodeEntry* _entry, const InstInfo* _prior) const;
   /// predecoded_dr: DR decode from the trace probe (same bytes); XED still decodes below.
   void processInst(InstInfo* _info, instr_t* predecoded_dr);
   /// When non-null and encoding_is_new, use this instead of decoding again (caller-owned).
@@ -64,6 +72,7 @@ class TraceReaderMemtrace : public TraceReader {
   void* dcontext_ = nullptr;
   unsigned int knob_verbose_ = 0;
   bool trace_has_encodings_ = false;
+  bool is_regdeps_ = false;
 
   enum class MTState {
     INST,
@@ -90,6 +99,14 @@ class TraceReaderMemtrace : public TraceReader {
   bool mt_using_info_a_ = true;
   ctype_pin_inst gap_patch_jmp_ = {};
   uint64_t mt_warn_target_ = 0;
+
+  // Decoded static instructions. Private to this reader, since buffered
+  // InstInfo::info pointers must stay valid until this reader consumes them.
+  MemtraceDecodeCache<DecodeEntry> decode_cache_;
+  uint64_t decode_cache_hits_ = 0;
+  uint64_t decode_cache_misses_ = 0;
+  uint64_t decode_cache_invalidations_ = 0;
+  uint64_t decode_cache_evictions_ = 0;
 };
 
 #endif
@@ -220,7 +220,7 @@ void pt_setup(uns proc_id) {
   std::string path(pt_trace_files[proc_id]);
   std::string trace(path);
 
-  pt_trace_readers[proc_id] = new TraceReaderPT(trace);
+  pt_trace_readers[proc_id] = new TraceReaderPT(proc_id, trace);
 
   // FFWD
   const InstInfo* insi = pt_trace_readers[proc_id]->nextInstruction();
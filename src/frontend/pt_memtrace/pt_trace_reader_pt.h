@@ -27,24 +27,41 @@
  *                GNU General Public License as published by the Free Software
  *                Foundation, version 2.
  * Description  : Interface to read gziped Intel processor trace
+ *
+ *                Two trace encodings are read, both gzip-compressed:
+ *                - text: one "<pc hex>  <size> <byte hex> ..." line per instruction.
+ *                - binary (bin/pt_trace_convert.py): the PT_BINARY_MAGIC header, then
+ *                  one record per instruction. A record is a LEB128 varint holding
+ *                  zigzag(pc - (previous pc + previous size)) << 1 | has_bytes; when
+ *                  has_bytes is set, a size byte and the instruction bytes follow and
+ *                  are remembered for that pc, otherwise the bytes last given for the
+ *                  pc are reused. Straight-line code already seen is 1 byte per inst.
  ***************************************************************************************/
 #ifndef __PT_TRACE_READER_PT_H__
 #define __PT_TRACE_READER_PT_H__
+#include <cstring>
 #include <map>
-#include <sstream>
 #include <stdlib.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <zlib.h>
 
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
 #include "general.param.h"
 
 #include "frontend/pt_memtrace/memtrace_trace_reader.h"
+#include "frontend/pt_memtrace/trace_seek_index.h"
 
 #include "ctype_pin_inst.h"
 
 #define GZ_BUFFER_SIZE 80
-#define panic(...) printf(__VA_ARGS__)
+#define PT_BINARY_MAGIC "SCPTBIN1"  // 8 bytes, no terminator in the file
+#define PT_BINARY_MAGIC_SIZE 8
+#define PT_BINARY_BUFFER_SIZE (1 << 16)
 
 struct PTInst {
   uint64_t pc;
@@ -54,7 +71,9 @@ struct PTInst {
 
 class TraceReaderPT : public TraceReader {
  private:
+  uns proc_id = 0;
   gzFile raw_file = NULL;
+  TraceSeekReader *seek_reader = nullptr;  // replaces raw_file when starting at PT_ROI_BEGIN
   InstInfo inst_info_a = {};
   InstInfo inst_info_b = {};
   PTInst pt_inst_a = {}, pt_inst_b = {};
@@ -63,9 +82,142 @@ class TraceReaderPT : public TraceReader {
   std::map<uint64_t, uint64_t> *prev_to_new_bbl_address_map = nullptr;
   uint64_t num_nops_in_trace = 0, num_inserted_nops = 0;
   uint64_t num_direct_brs_in_trace = 0, num_inserted_direct_brs = 0;
-  std::vector<std::string> parsed = {};
   ctype_pin_inst patch_inst_{};
 
+  /* Binary encoding state */
+  struct PTInstBytes {
+    uint8_t size;
+    uint8_t inst_bytes[16];
+  };
+  bool binary = false;
+  std::vector<uint8_t> bin_buffer;
+  size_t bin_pos = 0, bin_len = 0;
+  uint64_t bin_next_pc = 0;  // pc + size of the previous record
+  std::unordered_map<uint64_t, PTInstBytes> bin_dict;
+
+  static int hex_value(char c) {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  }
+
+  /* Parses a hex number (optionally 0x-prefixed) at p and advances p past it; false if there is none */
+  static bool parse_hex(const char *&p, uint64_t &value) {
+    while (*p == ' ')
+      p++;
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X') && hex_value(p[2]) >= 0)
+      p += 2;
+    if (hex_value(*p) < 0)
+      return false;
+    value = 0;
+    for (int digit; (digit = hex_value(*p)) >= 0; p++)
+      value = value << 4 | digit;
+    return true;
+  }
+
+  /* Parses a text trace line in place */
+  static bool parse_text_line(const char *p, PTInst &inst) {
+    uint64_t value;
+    if (!parse_hex(p, value))
+      return false;
+    inst.pc = value;
+    while (*p == ' ')
+      p++;
+    unsigned size = 0;
+    for (; *p >= '0' && *p <= '9'; p++)
+      size = size * 10 + (*p - '0');
+    if (size == 0 || size > sizeof(inst.inst_bytes))
+      return false;
+    inst.size = size;
+    for (unsigned i = 0; i < size; i++) {
+      if (!parse_hex(p, value))
+        return false;
+      inst.inst_bytes[i] = value;
+    }
+    return true;
+  }
+
+  /* Called when a read comes up empty: a clean end of the trace returns, a damaged stream is fatal */
+  void check_end_of_trace() {
+    if (seek_reader) {
+      if (seek_reader->failed())
+        FATAL_ERROR(proc_id, "TraceReaderPT: corrupt or truncated gzip stream\n");
+      return;
+    }
+    int err = Z_OK;
+    const char *msg = gzerror(raw_file, &err);
+    if (err != Z_OK)
+      FATAL_ERROR(proc_id, "TraceReaderPT: corrupt or truncated gzip stream: %s\n", msg);
+  }
+
+  bool read_text_record(PTInst &inst) {
+    char buffer[GZ_BUFFER_SIZE];
+    char *read = seek_reader ? seek_reader->gets(buffer, GZ_BUFFER_SIZE) : gzgets(raw_file, buffer, GZ_BUFFER_SIZE);
+    if (read == Z_NULL) {
+      check_end_of_trace();
+      return false;
+    }
+    if (!parse_text_line(buffer, inst))
+      FATAL_ERROR(proc_id, "TraceReaderPT: malformed GZ File line: %s\n", buffer);
+    return true;
+  }
+
+  bool read_binary_byte(uint8_t &byte) {
+    if (bin_pos == bin_len) {
+      int len = gzread(raw_file, bin_buffer.data(), bin_buffer.size());
+      if (len <= 0) {
+        check_end_of_trace();
+        return false;
+      }
+      bin_pos = 0;
+      bin_len = len;
+    }
+    byte = bin_buffer[bin_pos++];
+    return true;
+  }
+
+  /* Returns false only at the end of the trace; a truncated or corrupt record is fatal */
+  bool read_binary_record(PTInst &inst) {
+    uint64_t value = 0;
+    uint8_t byte;
+    for (int shift = 0;; shift += 7) {
+      if (!read_binary_byte(byte)) {
+        if (shift == 0)
+          return false;
+        FATAL_ERROR(proc_id, "TraceReaderPT: truncated binary record after pc %lx\n", bin_next_pc);
+      }
+      if (shift >= 64)
+        FATAL_ERROR(proc_id, "TraceReaderPT: corrupt binary record after pc %lx\n", bin_next_pc);
+      value |= (uint64_t)(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        break;
+    }
+    uint64_t zigzag = value >> 1;
+    inst.pc = bin_next_pc + (uint64_t)((zigzag >> 1) ^ -(zigzag & 1));
+    PTInstBytes *entry;
+    if (value & 1) {
+      entry = &bin_dict[inst.pc];
+      bool ok = read_binary_byte(entry->size) && entry->size && entry->size <= sizeof(entry->inst_bytes);
+      for (uint8_t i = 0; ok && i < entry->size; i++)
+        ok = read_binary_byte(entry->inst_bytes[i]);
+      if (!ok)
+        FATAL_ERROR(proc_id, "TraceReaderPT: truncated or corrupt binary record at pc %lx\n", inst.pc);
+    } else {
+      auto it = bin_dict.find(inst.pc);
+      if (it == bin_dict.end())
+        FATAL_ERROR(proc_id, "TraceReaderPT: binary record at pc %lx has no instruction bytes\n", inst.pc);
+      entry = &it->second;
+    }
+    inst.size = entry->size;
+    memcpy(inst.inst_bytes, entry->inst_bytes, inst.size);
+    bin_next_pc = inst.pc + inst.size;
+    return true;
+  }
+
  public:
   bool read_next_line(PTInst &inst) {
     static uns64 num_nops_at_start = 0;
@@ -78,31 +230,8 @@ class TraceReaderPT : public TraceReader {
     }
     if (raw_file == NULL)
       return false;
-    char buffer[GZ_BUFFER_SIZE];
-    if (gzgets(raw_file, buffer, GZ_BUFFER_SIZE) == Z_NULL)
+    if (!(binary ? read_binary_record(inst) : read_text_record(inst)))
       return false;
-    std::string line = buffer;
-
-    parsed.clear();
-    std::stringstream check1(line);
-    std::string intermediate;
-    while (getline(check1, intermediate, ' ')) {
-      parsed.emplace_back(intermediate);
-    }
-    if (parsed.size() < 3)
-      panic("TraceReaderPT: GZ File line has less than 3 items");
-    assert(parsed[1].length() == 0);
-    inst.pc = strtoul(parsed[0].c_str(), NULL, 16);
-    inst.size = strtoul(parsed[2].c_str(), NULL, 10);
-
-    int found = 0;
-    assert(inst.size);
-    for (uint8_t i = 3; found < inst.size; i++) {
-      if (parsed[i].length() == 0) {
-        continue;
-      }
-      inst.inst_bytes[found++] = strtoul(parsed[i].c_str(), NULL, 16);
-    }
 
     if (enable_code_bloat_effect && (prev_to_new_bbl_address_map != nullptr)) {
       uint64_t result = inst.pc;
@@ -224,15 +353,24 @@ class TraceReaderPT : public TraceReader {
     }
     return false;
   }
-  TraceReaderPT(const std::string &_trace, bool _enable_code_bloat_effect = false,
-                std::map<uint64_t, uint64_t> *_prev_to_new_bbl_address_map = nullptr) {
+  TraceReaderPT(uns _proc_id, const std::string &_trace, bool _enable_code_bloat_effect = false,
+                std::map<uint64_t, uint64_t> *_prev_to_new_bbl_address_map = nullptr)
+      : proc_id(_proc_id) {
     raw_file = gzopen(_trace.c_str(), "rb");
-    if (!raw_file) {
-      panic("TraceReaderPT: Invalid GZ File");
-      throw "Could not open file";
-    }
+    if (!raw_file)
+      FATAL_ERROR(proc_id, "TraceReaderPT: could not open %s\n", _trace.c_str());
     enable_code_bloat_effect = _enable_code_bloat_effect;
     prev_to_new_bbl_address_map = _prev_to_new_bbl_address_map;
+    char magic[PT_BINARY_MAGIC_SIZE];
+    if (gzread(raw_file, magic, PT_BINARY_MAGIC_SIZE) == PT_BINARY_MAGIC_SIZE &&
+        !memcmp(magic, PT_BINARY_MAGIC, PT_BINARY_MAGIC_SIZE)) {
+      binary = true;
+      bin_buffer.resize(PT_BINARY_BUFFER_SIZE);
+    } else {
+      gzrewind(raw_file);
+    }
+    if (PT_ROI_BEGIN > 1)
+      seekToLine(_trace, PT_ROI_BEGIN - 1);
     has_trace_encodings_ = true;
     inst_info_a.valid = false;
     inst_info_a.fake_inst = false;
@@ -241,6 +379,25 @@ class TraceReaderPT : public TraceReader {
     init("");
     initTrace();
   }
+  void seekToLine(const std::string &_trace, uint64_t line) {
+    if (binary) {
+      // records depend on the ones before them, so skip by decoding
+      PTInst skipped;
+      for (uint64_t i = 0; i < line; i++) {
+        if (!read_binary_record(skipped))
+          FATAL_ERROR(proc_id, "TraceReaderPT: PT_ROI_BEGIN is past the end of the trace\n");
+      }
+      _DEBUG(proc_id, DEBUG_TRACE_READ, "Skipped %llu trace records to the ROI\n", (unsigned long long)line);
+      return;
+    }
+    TraceSeekIndex index;
+    if (TRACE_SEEK_INDEX)
+      index.load_or_build(_trace, TRACE_SEEK_INDEX_SPAN);
+    seek_reader = new TraceSeekReader(_trace);
+    if (!seek_reader->seek(index, line))
+      FATAL_ERROR(proc_id, "TraceReaderPT: PT_ROI_BEGIN is past the end of the trace\n");
+    _DEBUG(proc_id, DEBUG_TRACE_READ, "Skipped %llu trace lines to the ROI\n", (unsigned long long)line);
+  }
   int i = 0;
   const InstInfo *getNextInstruction() override {
     PTInst &next_line = (use_info_a ? pt_inst_a : pt_inst_b);
@@ -274,6 +431,7 @@ class TraceReaderPT : public TraceReader {
               << ", ratio: " << double(num_inserted_direct_brs) / double(num_direct_brs_in_trace) << std::endl;
     if (raw_file != NULL)
       gzclose(raw_file);
+    delete seek_reader;
   }
 };
 
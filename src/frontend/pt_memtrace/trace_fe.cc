@@ -10,6 +10,7 @@
 #include "bp/bp.param.h"
 
 #include "bp/bp.h"
+#include "frontend/frontend.h"
 #include "frontend/frontend_intf.h"
 #include "frontend/pt_memtrace/memtrace_fe.h"
 #include "frontend/pt_memtrace/pt_fe.h"
@@ -25,6 +26,7 @@
 /* Macros */
 
 #include "globals/assert.h"
+#include "globals/utils.h"
 
 #include "debug/debug.param.h"
 #include "debug/debug_macros.h"
@@ -246,6 +248,66 @@ int trace_read(int proc_id, ctype_pin_inst *next_onpath_pi) {
   return ret;
 }
 
+/* Reads the next on-path instruction into next_onpath_pi and records it in the replay buffer. Returns false at the end
+ * of the trace. */
+static bool read_next_onpath_inst(uns proc_id) {
+  int success = trace_read(proc_id, &next_onpath_pi[proc_id]);
+  if (!success) {
+    trace_read_done[proc_id] = TRUE;
+    reached_exit[proc_id] = TRUE;
+    return false;
+  }
+  uint64_t addr = next_onpath_pi[proc_id].instruction_addr;
+  auto find = pc_to_inst[proc_id].find(addr);
+  if (find == pc_to_inst[proc_id].end()) {
+    pc_to_inst[proc_id].insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
+  } else if (next_onpath_pi[proc_id].encoding_is_new) {
+    STAT_EVENT(proc_id, INST_MAP_UPDATE_ENCODING);
+    pc_to_inst[proc_id].erase(addr);
+    pc_to_inst[proc_id].insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
+  } else if (next_onpath_pi[proc_id].inst_binary_lsb != find->second.inst_binary_lsb ||
+             next_onpath_pi[proc_id].inst_binary_msb != find->second.inst_binary_msb) {
+    DEBUG(proc_id, "Previously seen PC references new instruction addr:%lx inst_size:%i lsb:%lx msb:%lx\n ", addr,
+          next_onpath_pi[proc_id].size, next_onpath_pi[proc_id].inst_binary_lsb,
+          next_onpath_pi[proc_id].inst_binary_msb);
+    // Handle jitted code
+    STAT_EVENT(proc_id, INST_MAP_UPDATE_JITTED);
+    pc_to_inst[proc_id].erase(addr);
+    pc_to_inst[proc_id].insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
+  } else if (next_onpath_pi[proc_id].instruction_next_addr != find->second.instruction_next_addr) {
+    ASSERT(proc_id, next_onpath_pi[proc_id].op_type == find->second.op_type);
+    if (next_onpath_pi[proc_id].cf_type) {
+      ASSERT(proc_id, next_onpath_pi[proc_id].cf_type == find->second.cf_type);
+      // This can fail for java pt traces
+      // ASSERT(proc_id, next_onpath_pi[proc_id].cf_type == CF_CBR ||
+      //                 next_onpath_pi[proc_id].cf_type >= CF_IBR ||
+      //                 next_onpath_pi[proc_id].last_inst_from_trace);
+    }
+    STAT_EVENT(proc_id, INST_MAP_UPDATE_NPC_INV + next_onpath_pi[proc_id].op_type);
+    pc_to_inst[proc_id].erase(addr);
+    pc_to_inst[proc_id].insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
+  } else if (!ctype_pin_inst_same_mem_vaddr(next_onpath_pi[proc_id], find->second)) {
+    ASSERT(proc_id, next_onpath_pi[proc_id].op_type == find->second.op_type);
+    STAT_EVENT(proc_id, INST_MAP_UPDATE_MEM_INV + next_onpath_pi[proc_id].op_type);
+    pc_to_inst[proc_id].erase(addr);
+    pc_to_inst[proc_id].insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
+  } else {
+    if (DEBUG_TRACE_READ && DEBUG_RANGE_COND(proc_id)) {
+      assert_ctype_pin_inst_same(proc_id, next_onpath_pi[proc_id], find->second);
+    }
+  }
+  // Poison the oracle memory addresses of the replay-buffer entry for this
+  // PC; they are only ever read back to replay off-path instructions.
+  if (POISON_REPLAY_BUFFER_ORACLE_VA) {
+    ctype_pin_inst &replay_entry = pc_to_inst[proc_id][addr];
+    for (uns i = 0; i < MAX_LD_NUM; i++)
+      replay_entry.ld_vaddr[i] = REPLAY_BUFFER_POISON_VA;
+    for (uns i = 0; i < MAX_ST_NUM; i++)
+      replay_entry.st_vaddr[i] = REPLAY_BUFFER_POISON_VA;
+  }
+  return true;
+}
+
 void ext_trace_fetch_op(uns proc_id, uns bp_id, Op *op) {
   // ext_trace_redirect should be called before fetching from the secondary fetch
   bool off_path_mode_ = off_path_mode[proc_id][bp_id];
@@ -264,62 +326,8 @@ void ext_trace_fetch_op(uns proc_id, uns bp_id, Op *op) {
 
   if (uop_generator_get_eom(proc_id)) {
     if (!off_path_mode_) {
-      int success = false;
-      success = trace_read(proc_id, &next_onpath_pi[proc_id]);
-      if (!success) {
-        trace_read_done[proc_id] = TRUE;
-        reached_exit[proc_id] = TRUE;
+      if (!read_next_onpath_inst(proc_id))
         op->exit = TRUE;
-      } else {
-        uint64_t addr = next_onpath_pi[proc_id].instruction_addr;
-        auto find = pc_to_inst[proc_id].find(addr);
-        if (find == pc_to_inst[proc_id].end()) {
-          pc_to_inst[proc_id].insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
-        } else if (next_onpath_pi[proc_id].encoding_is_new) {
-          STAT_EVENT(proc_id, INST_MAP_UPDATE_ENCODING);
-          pc_to_inst[proc_id].erase(addr);
-          pc_to_inst[proc_id].insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
-        } else if (next_onpath_pi[proc_id].inst_binary_lsb != find->second.inst_binary_lsb ||
-                   next_onpath_pi[proc_id].inst_binary_msb != find->second.inst_binary_msb) {
-          DEBUG(proc_id, "Previously seen PC references new instruction addr:%lx inst_size:%i lsb:%lx msb:%lx\n ", addr,
-                next_onpath_pi[proc_id].size, next_onpath_pi[proc_id].inst_binary_lsb,
-                next_onpath_pi[proc_id].inst_binary_msb);
-          // Handle jitted code
-          STAT_EVENT(proc_id, INST_MAP_UPDATE_JITTED);
-          pc_to_inst[proc_id].erase(addr);
-          pc_to_inst[proc_id].insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
-        } else if (next_onpath_pi[proc_id].instruction_next_addr != find->second.instruction_next_addr) {
-          ASSERT(proc_id, next_onpath_pi[proc_id].op_type == find->second.op_type);
-          if (next_onpath_pi[proc_id].cf_type) {
-            ASSERT(proc_id, next_onpath_pi[proc_id].cf_type == find->second.cf_type);
-            // This can fail for java pt traces
-            // ASSERT(proc_id, next_onpath_pi[proc_id].cf_type == CF_CBR ||
-            //                 next_onpath_pi[proc_id].cf_type >= CF_IBR ||
-            //                 next_onpath_pi[proc_id].last_inst_from_trace);
-          }
-          STAT_EVENT(proc_id, INST_MAP_UPDATE_NPC_INV + next_onpath_pi[proc_id].op_type);
-          pc_to_inst[proc_id].erase(addr);
-          pc_to_inst[proc_id].insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
-        } else if (!ctype_pin_inst_same_mem_vaddr(next_onpath_pi[proc_id], find->second)) {
-          ASSERT(proc_id, next_onpath_pi[proc_id].op_type == find->second.op_type);
-          STAT_EVENT(proc_id, INST_MAP_UPDATE_MEM_INV + next_onpath_pi[proc_id].op_type);
-          pc_to_inst[proc_id].erase(addr);
-          pc_to_inst[proc_id].insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
-        } else {
-          if (DEBUG_TRACE_READ && DEBUG_RANGE_COND(proc_id)) {
-            assert_ctype_pin_inst_same(proc_id, next_onpath_pi[proc_id], find->second);
-          }
-        }
-        // Poison the oracle memory addresses of the replay-buffer entry for this
-        // PC; they are only ever read back to replay off-path instructions.
-        if (POISON_REPLAY_BUFFER_ORACLE_VA) {
-          ctype_pin_inst &replay_entry = pc_to_inst[proc_id][addr];
-          for (uns i = 0; i < MAX_LD_NUM; i++)
-            replay_entry.ld_vaddr[i] = REPLAY_BUFFER_POISON_VA;
-          for (uns i = 0; i < MAX_ST_NUM; i++)
-            replay_entry.st_vaddr[i] = REPLAY_BUFFER_POISON_VA;
-        }
-      }
     } else {
       off_path_generate_inst(proc_id, off_path_addr_, next_offpath_pi_);
     }
@@ -328,6 +336,35 @@ void ext_trace_fetch_op(uns proc_id, uns bp_id, Op *op) {
         next_onpath_pi[proc_id].instruction_addr, next_offpath_pi_->instruction_addr);
 }
 
+/* Warmup fast path: hands over the addresses of the next on-path instruction and reads the one after it, skipping uop
+ * generation. Control-flow instructions train the branch predictor on their uops, and string, gather/scatter and fake
+ * instructions do not map to one access per address, so those are left to ext_trace_fetch_op. */
+Flag ext_trace_warmup_inst(uns proc_id, Warmup_Inst *inst) {
+  const ctype_pin_inst *pi = &next_onpath_pi[proc_id];
+  if (!uop_generator_get_bom(proc_id) || off_path_mode[proc_id][0] || pi->cf_type != NOT_CF || pi->is_string ||
+      pi->is_gather_scatter || pi->fake_inst)
+    return FALSE;
+
+  inst->addr = convert_to_cmp_addr(proc_id, pi->instruction_addr);
+  inst->num_ld = 0;
+  inst->num_st = 0;
+  for (uns i = 0; i < pi->num_ld; i++) {
+    Addr va = convert_to_cmp_addr(proc_id, pi->ld_vaddr[i]);
+    if (va == 0)
+      FATAL_ERROR(proc_id, "Access to 0x0\n");
+    if (!pi->is_prefetch)  // software prefetches do not warm the dcache
+      inst->ld_va[inst->num_ld++] = va;
+  }
+  for (uns i = 0; i < pi->num_st; i++) {
+    Addr va = convert_to_cmp_addr(proc_id, pi->st_vaddr[i]);
+    if (va == 0)
+      FATAL_ERROR(proc_id, "Access to 0x0\n");
+    inst->st_va[inst->num_st++] = va;
+  }
+  inst->exit = !read_next_onpath_inst(proc_id);
+  return TRUE;
+}
+
 Flag ext_trace_can_fetch_op(uns proc_id, uns bp_id) {
   if (!bp_id && !off_path_mode[proc_id])
     return !(uop_generator_get_eom(proc_id) && trace_read_done[proc_id]);
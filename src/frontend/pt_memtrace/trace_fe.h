@@ -37,6 +37,7 @@
 struct Trace_Uop_struct;
 typedef struct Trace_Uop_struct Trace_Uop;
 struct Op_struct;
+struct Warmup_Inst_struct;
 
 /**************************************************************************************/
 /* Prototypes */
@@ -59,6 +60,7 @@ void ext_trace_fetch_op(uns proc_id, uns bp_id, Op *op);
 void ext_trace_redirect(uns proc_id, uns bp_id, uns64 inst_uid, Addr fetch_addr);
 void ext_trace_recover(uns proc_id, uns bp_id, uns64 inst_uid);
 void ext_trace_retire(uns proc_id, uns64 inst_uid);
+Flag ext_trace_warmup_inst(uns proc_id, struct Warmup_Inst_struct *inst);
 void ext_trace_init();
 void ext_trace_done(void);
 void ext_trace_extract_basic_block_vectors();
@@ -0,0 +1,373 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : frontend/pt_memtrace/trace_seek_index.cc
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Access-point index over gzip traces, after zlib's examples/zran.c
+ ***************************************************************************************/
+
+#include "frontend/pt_memtrace/trace_seek_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SEEK_INDEX_MAGIC "SCARABSI"
+#define SEEK_INDEX_VERSION 1
+#define SEEK_WINDOW_SIZE 32768
+#define SEEK_CHUNK_SIZE (1 << 16)
+#define GZIP_WINDOW_BITS 47  // max window, gzip or zlib header
+#define RAW_WINDOW_BITS -15
+#define GZIP_TRAILER_SIZE 8
+
+static bool stat_trace(const std::string& trace, uint64_t* size, int64_t* mtime) {
+  struct stat st;
+  if (stat(trace.c_str(), &st) != 0)
+    return false;
+  *size = st.st_size;
+  *mtime = st.st_mtime;
+  return true;
+}
+
+template <typename T>
+static bool read_val(FILE* file, T* val) {
+  return fread(val, sizeof(T), 1, file) == 1;
+}
+
+template <typename T>
+static void write_val(FILE* file, const T& val) {
+  fwrite(&val, sizeof(T), 1, file);
+}
+
+/**************************************************************************************/
+/* TraceSeekIndex */
+
+bool TraceSeekIndex::load_or_build(const std::string& trace, uint64_t span) {
+  span_lines = span;
+  if (!stat_trace(trace, &trace_size, &trace_mtime))
+    return false;
+
+  const std::string path = trace + ".sidx";
+  if (load(path, span))
+    return true;
+
+  std::cout << "Building seek index for " << trace << std::endl;
+  if (!build(trace, span)) {
+    std::cout << "Could not build seek index for " << trace << ", seeking linearly" << std::endl;
+    points.clear();
+    return false;
+  }
+  std::cout << "Seek index: " << points.size() << " access points over " << total_lines << " lines" << std::endl;
+  save(path);
+  return true;
+}
+
+const Trace_Seek_Point* TraceSeekIndex::find(uint64_t line) const {
+  auto it = std::upper_bound(points.begin(), points.end(), line,
+                             [](uint64_t l, const Trace_Seek_Point& p) { return l < p.first_line; });
+  if (it == points.begin())
+    return nullptr;
+  return &*(it - 1);
+}
+
+bool TraceSeekIndex::load(const std::string& path, uint64_t span) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+
+  char magic[8];
+  uint32_t version, num_points;
+  uint64_t size, file_span;
+  int64_t mtime;
+  bool ok = fread(magic, sizeof(magic), 1, file) == 1 && !memcmp(magic, SEEK_INDEX_MAGIC, sizeof(magic)) &&
+            read_val(file, &version) && version == SEEK_INDEX_VERSION && read_val(file, &num_points) &&
+            read_val(file, &size) && read_val(file, &mtime) && read_val(file, &file_span) &&
+            read_val(file, &total_lines);
+  // a trace rewritten in place or a different span invalidates the index
+  ok = ok && size == trace_size && mtime == trace_mtime && file_span == span;
+
+  points.clear();
+  for (uint32_t ii = 0; ok && ii < num_points; ii++) {
+    Trace_Seek_Point point;
+    uint32_t window_len;
+    ok = read_val(file, &point.in_offset) && read_val(file, &point.first_line) && read_val(file, &point.bits) &&
+         read_val(file, &point.mid_line) && read_val(file, &window_len);
+    if (ok) {
+      point.window.resize(window_len);
+      ok = fread(point.window.data(), 1, window_len, file) == window_len;
+      points.push_back(std::move(point));
+    }
+  }
+  fclose(file);
+
+  if (!ok)
+    points.clear();
+  return ok;
+}
+
+bool TraceSeekIndex::build(const std::string& trace, uint64_t span) {
+  FILE* file = fopen(trace.c_str(), "rb");
+  if (!file)
+    return false;
+
+  z_stream strm = {};
+  if (inflateInit2(&strm, GZIP_WINDOW_BITS) != Z_OK) {
+    fclose(file);
+    return false;
+  }
+
+  std::vector<uint8_t> input(SEEK_CHUNK_SIZE);
+  std::vector<uint8_t> window(SEEK_WINDOW_SIZE);
+  std::vector<uint8_t> history(SEEK_WINDOW_SIZE);
+  uint64_t totin = 0;
+  uint64_t lines = 0;
+  bool line_start = true;
+  int ret = Z_OK;
+
+  points.clear();
+  strm.avail_out = 0;
+  while (ret == Z_OK || ret == Z_BUF_ERROR || ret == Z_STREAM_END) {
+    strm.avail_in = fread(input.data(), 1, input.size(), file);
+    strm.next_in = input.data();
+    if (strm.avail_in == 0)
+      break;
+
+    do {
+      if (strm.avail_out == 0) {
+        strm.avail_out = SEEK_WINDOW_SIZE;
+        strm.next_out = window.data();
+      }
+      uint8_t* out_start = strm.next_out;
+      totin += strm.avail_in;
+      ret = inflate(&strm, Z_BLOCK);
+      totin -= strm.avail_in;
+      if (ret != Z_OK && ret != Z_BUF_ERROR && ret != Z_STREAM_END)
+        break;
+
+      for (uint8_t* p = out_start; p < strm.next_out; p++) {
+        p = (uint8_t*)memchr(p, '\n', strm.next_out - p);
+        if (!p)
+          break;
+        lines++;
+      }
+      if (strm.next_out != out_start)
+        line_start = strm.next_out[-1] == '\n';
+
+      if (ret == Z_STREAM_END) {
+        // concatenated gzip members, as written by parallel compressors
+        inflateReset(&strm);
+        continue;
+      }
+
+      // a block boundary: nothing but the 32KB history carries over
+      const uint64_t first_line = line_start ? lines : lines + 1;
+      if ((strm.data_type & 128) && !(strm.data_type & 64) &&
+          (points.empty() || first_line >= points.back().first_line + span)) {
+        const uint32_t left = strm.avail_out;
+        memcpy(history.data(), window.data() + SEEK_WINDOW_SIZE - left, left);
+        memcpy(history.data() + left, window.data(), SEEK_WINDOW_SIZE - left);
+
+        Trace_Seek_Point point;
+        point.in_offset = totin;
+        point.first_line = first_line;
+        point.bits = strm.data_type & 7;
+        point.mid_line = !line_start;
+        uLongf window_len = compressBound(SEEK_WINDOW_SIZE);
+        point.window.resize(window_len);
+        if (compress2(point.window.data(), &window_len, history.data(), SEEK_WINDOW_SIZE, Z_BEST_SPEED) != Z_OK) {
+          ret = Z_MEM_ERROR;
+          break;
+        }
+        point.window.resize(window_len);
+        points.push_back(std::move(point));
+      }
+    } while (strm.avail_in != 0);
+  }
+
+  const bool ok = !ferror(file) && (ret == Z_OK || ret == Z_BUF_ERROR || ret == Z_STREAM_END);
+  total_lines = line_start ? lines : lines + 1;
+  inflateEnd(&strm);
+  fclose(file);
+  return ok;
+}
+
+void TraceSeekIndex::save(const std::string& path) const {
+  // concurrent runs over the same trace may race to build the index; rename makes the last one win cleanly
+  const std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+  FILE* file = fopen(tmp_path.c_str(), "wb");
+  if (!file) {
+    std::cout << "Could not write seek index " << path << ", it will be rebuilt next run" << std::endl;
+    return;
+  }
+
+  fwrite(SEEK_INDEX_MAGIC, 8, 1, file);
+  write_val(file, (uint32_t)SEEK_INDEX_VERSION);
+  write_val(file, (uint32_t)points.size());
+  write_val(file, trace_size);
+  write_val(file, trace_mtime);
+  write_val(file, span_lines);
+  write_val(file, total_lines);
+  for (const Trace_Seek_Point& point : points) {
+    write_val(file, point.in_offset);
+    write_val(file, point.first_line);
+    write_val(file, point.bits);
+    write_val(file, point.mid_line);
+    write_val(file, (uint32_t)point.window.size());
+    fwrite(point.window.data(), 1, point.window.size(), file);
+  }
+
+  if (ferror(file) | fclose(file) || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::cout << "Could not write seek index " << path << ", it will be rebuilt next run" << std::endl;
+    unlink(tmp_path.c_str());
+  }
+}
+
+/**************************************************************************************/
+/* TraceSeekReader */
+
+TraceSeekReader::TraceSeekReader(const std::string& trace)
+    : in_buf(SEEK_CHUNK_SIZE), out_buf(SEEK_CHUNK_SIZE) {
+  file = fopen(trace.c_str(), "rb");
+  eof = !file || inflateInit2(&strm, GZIP_WINDOW_BITS) != Z_OK;
+}
+
+TraceSeekReader::~TraceSeekReader() {
+  inflateEnd(&strm);
+  if (file)
+    fclose(file);
+}
+
+bool TraceSeekReader::seek(const TraceSeekIndex& index, uint64_t line) {
+  if (eof)
+    return false;
+
+  const Trace_Seek_Point* point = index.find(line);
+  if (!point)
+    return skip_lines(line);
+
+  std::vector<uint8_t> history(SEEK_WINDOW_SIZE);
+  uLongf history_len = SEEK_WINDOW_SIZE;
+  if (uncompress(history.data(), &history_len, point->window.data(), point->window.size()) != Z_OK ||
+      fseeko(file, point->in_offset - (point->bits ? 1 : 0), SEEK_SET) != 0 ||
+      inflateReset2(&strm, RAW_WINDOW_BITS) != Z_OK) {
+    eof = true;
+    return false;
+  }
+  strm.avail_in = 0;
+  out_pos = out_len = 0;
+  raw = true;
+  if (point->bits) {
+    int byte = getc(file);
+    if (byte == EOF) {
+      eof = true;
+      return false;
+    }
+    inflatePrime(&strm, point->bits, byte >> (8 - point->bits));
+  }
+  inflateSetDictionary(&strm, history.data(), history_len);
+
+  if (point->mid_line && !skip_lines(1))
+    return false;
+  return skip_lines(line - point->first_line);
+}
+
+char* TraceSeekReader::gets(char* buf, int len) {
+  int num = 0;
+  while (num < len - 1) {
+    if (out_pos == out_len && !fill())
+      break;
+    const size_t avail = std::min(out_len - out_pos, (size_t)(len - 1 - num));
+    const uint8_t* start = out_buf.data() + out_pos;
+    const uint8_t* nl = (const uint8_t*)memchr(start, '\n', avail);
+    const size_t take = nl ? nl - start + 1 : avail;
+    memcpy(buf + num, start, take);
+    num += take;
+    out_pos += take;
+    if (nl)
+      break;
+  }
+  buf[num] = '\0';
+  return num ? buf : nullptr;
+}
+
+bool TraceSeekReader::fill() {
+  out_pos = out_len = 0;
+  while (!out_len && !eof) {
+    if (strm.avail_in == 0) {
+      strm.avail_in = fread(in_buf.data(), 1, in_buf.size(), file);
+      strm.next_in = in_buf.data();
+      if (strm.avail_in == 0) {
+        eof = true;
+        error = in_member;
+        break;
+      }
+    }
+    strm.next_out = out_buf.data();
+    strm.avail_out = out_buf.size();
+    int ret = inflate(&strm, Z_NO_FLUSH);
+    out_len = out_buf.size() - strm.avail_out;
+    in_member = ret != Z_STREAM_END;
+
+    if (ret == Z_STREAM_END) {
+      if (raw) {
+        // a resumed bare deflate stream leaves the member trailer unread
+        for (uint32_t skip = GZIP_TRAILER_SIZE; skip && !eof;) {
+          if (strm.avail_in == 0) {
+            strm.avail_in = fread(in_buf.data(), 1, in_buf.size(), file);
+            strm.next_in = in_buf.data();
+            eof = error = strm.avail_in == 0;
+          }
+          const uint32_t num = std::min(skip, strm.avail_in);
+          strm.next_in += num;
+          strm.avail_in -= num;
+          skip -= num;
+        }
+        raw = false;
+        inflateReset2(&strm, GZIP_WINDOW_BITS);
+      } else {
+        inflateReset(&strm);
+      }
+    } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      eof = error = true;
+    }
+  }
+  return out_len > 0;
+}
+
+bool TraceSeekReader::skip_lines(uint64_t count) {
+  while (count) {
+    if (out_pos == out_len && !fill())
+      return false;
+    const uint8_t* start = out_buf.data() + out_pos;
+    const uint8_t* nl = (const uint8_t*)memchr(start, '\n', out_len - out_pos);
+    if (nl) {
+      out_pos += nl - start + 1;
+      count--;
+    } else {
+      out_pos = out_len;
+    }
+  }
+  return true;
+}
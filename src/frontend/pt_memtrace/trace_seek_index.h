@@ -0,0 +1,100 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : frontend/pt_memtrace/trace_seek_index.h
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Random access into gzip-compressed, line-per-instruction traces.
+ *
+ *                The index holds deflate access points (compressed offset, bit
+ *                offset and the 32KB window preceding it) roughly every
+ *                TRACE_SEEK_INDEX_SPAN lines. It is built by one sequential pass
+ *                the first time a trace is seeked and saved next to the trace as
+ *                <trace>.sidx, so later runs over the same trace (e.g. every
+ *                SimPoint of a workload) only inflate from the nearest access
+ *                point instead of from the start of the file.
+ ***************************************************************************************/
+#ifndef __TRACE_SEEK_INDEX_H__
+#define __TRACE_SEEK_INDEX_H__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+struct Trace_Seek_Point {
+  uint64_t in_offset;      // compressed byte holding the first bit of the block
+  uint64_t first_line;     // index of the first complete line after the point
+  uint8_t bits;            // bits of the byte at in_offset - 1 belonging to the block
+  uint8_t mid_line;        // the point splits a line; drop output up to the first '\n'
+  std::vector<uint8_t> window;  // deflate-compressed 32KB history
+};
+
+class TraceSeekIndex {
+ public:
+  /* Loads <trace>.sidx if it matches the trace, otherwise builds it and tries to save it */
+  bool load_or_build(const std::string& trace, uint64_t span);
+  const Trace_Seek_Point* find(uint64_t line) const;
+  uint64_t num_lines() const { return total_lines; }
+
+ private:
+  bool load(const std::string& path, uint64_t span);
+  bool build(const std::string& trace, uint64_t span);
+  void save(const std::string& path) const;
+
+  std::vector<Trace_Seek_Point> points;
+  uint64_t span_lines = 0;
+  uint64_t trace_size = 0;
+  int64_t trace_mtime = 0;
+  uint64_t total_lines = 0;
+};
+
+/* Line reader over a gzip trace that can start at any line using a TraceSeekIndex */
+class TraceSeekReader {
+ public:
+  TraceSeekReader(const std::string& trace);
+  ~TraceSeekReader();
+  /* Positions the reader at the start of line (0-based); false if the trace is shorter */
+  bool seek(const TraceSeekIndex& index, uint64_t line);
+  /* Same contract as gzgets: reads up to len - 1 bytes, stopping after a '\n' */
+  char* gets(char* buf, int len);
+  /* True if reading stopped on a corrupt or truncated stream rather than its end */
+  bool failed() const { return error; }
+
+ private:
+  bool fill();
+  bool skip_lines(uint64_t count);
+
+  FILE* file = nullptr;
+  z_stream strm = {};
+  bool raw = false;  // inflating a bare deflate stream resumed from an access point
+  bool eof = false;
+  bool error = false;
+  bool in_member = false;  // inside a gzip member, so the file must not end here
+  std::vector<uint8_t> in_buf;
+  std::vector<uint8_t> out_buf;
+  size_t out_pos = 0;
+  size_t out_len = 0;
+};
+
+#endif  // __TRACE_SEEK_INDEX_H__
@@ -98,3 +98,21 @@ Static_Op_Info *cpp_static_op_access_create(int core, uint64_t addr, uint64_t ls
     return &inserted.first->second;
   }
 }
+
+// Uop translations: keyed by {addr, binary} (op_idx fixed at 0), one per macro-instruction.
+std::unordered_map<key, Uop_Translation, hash_fn> per_core_uop_translation_map[MAX_NUM_PROCS];
+
+Uop_Translation *cpp_uop_translation_access_create(int core, uint64_t addr, uint64_t lsb_bytes, uint64_t msb_bytes,
+                                                   unsigned char *new_entry) {
+  *new_entry = false;
+  key _key(addr, lsb_bytes, msb_bytes, 0);
+  auto &hash_map = per_core_uop_translation_map[core];
+  auto lookup = hash_map.find(_key);
+  if (lookup != hash_map.end()) {
+    return &lookup->second;
+  } else {
+    auto inserted = hash_map.emplace(_key, Uop_Translation{});
+    *new_entry = inserted.second;
+    return &inserted.first->second;
+  }
+}
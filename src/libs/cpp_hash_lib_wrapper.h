@@ -21,6 +21,17 @@ Static_Inst_Info *cpp_static_inst_access_create(int core, uint64_t addr, uint64_
 Static_Op_Info *cpp_static_op_access_create(int core, uint64_t addr, uint64_t lsb_bytes, uint64_t msb_bytes,
                                             uint8_t op_idx, unsigned char *new_entry);
 
+// Per-macro-instruction uop translation: everything a repeat execution needs, behind one lookup.
+typedef struct Uop_Translation_struct {
+  uns8 num_uop;  // 0 until the first execution has been cracked
+  Inst_Info* infos[STATIC_INST_MAX_UOPS];
+  Static_Inst_Info* static_inst;  // static_inst->uops[] holds the per-uop static info
+} Uop_Translation;
+
+// Uop translation cache, keyed by {addr, binary}.
+Uop_Translation *cpp_uop_translation_access_create(int core, uint64_t addr, uint64_t lsb_bytes, uint64_t msb_bytes,
+                                                   unsigned char *new_entry);
+
 #ifdef __cplusplus
 }
 #endif
@@ -50,6 +50,7 @@
 /**************************************************************************************/
 /* Prototypes */
 
+static inline uns list_entry_size(List*);
 static inline List_Entry* get_list_entry(List*);
 static inline void free_list_entry(List*, List_Entry*);
 static inline void verify_list_counts(List*);
@@ -106,7 +107,7 @@ void clear_list(List* list) {
     List_Entry *temp0, *temp1;
     for (temp0 = list->head; temp0 != NULL; temp0 = temp1) {
       temp1 = temp0->next;
-      free(temp0);
+      sfree(list_entry_size(list), temp0);
     }
     list->head = NULL;
     list->tail = NULL;
@@ -156,7 +157,7 @@ void clip_list_at_current(List* list) {
       List_Entry *temp0, *temp1;
       for (temp0 = list->current->next; temp0 != NULL; temp0 = temp1) {
         temp1 = temp0->next;
-        free(temp0);
+        sfree(list_entry_size(list), temp0);
       }
     }
     list->tail = list->current;
@@ -166,6 +167,13 @@ void clip_list_at_current(List* list) {
   verify_list_counts(list);
 }
 
+/**************************************************************************************/
+/* list_entry_size: */
+
+static inline uns list_entry_size(List* list) {
+  return sizeof(List_Entry) + list->data_size - sizeof(char);
+}
+
 /**************************************************************************************/
 /* alloc_list_entry: */
 
@@ -181,7 +189,7 @@ static inline List_Entry* get_list_entry(List* list) {
       return temp;
     }
 
-    size = sizeof(List_Entry) + list->data_size - sizeof(char);
+    size = list_entry_size(list);
 
     ASSERT(0, FREE_LIST_ALLOC_SIZE > 1);
     rval = (List_Entry*)malloc(size * FREE_LIST_ALLOC_SIZE);
@@ -202,9 +210,8 @@ static inline List_Entry* get_list_entry(List* list) {
     }
     temp->next = NULL;
   } else {
-    size = sizeof(List_Entry) + list->data_size - sizeof(char);
-    rval = (List_Entry*)malloc(size);
-    ASSERT(0, rval);
+    /* entries of lists without a free list come from the smalloc size classes */
+    rval = (List_Entry*)smalloc(list_entry_size(list));
     list->total_count++;
   }
 
@@ -252,7 +259,7 @@ static inline void free_list_entry(List* list, List_Entry* entry) {
     list->free = entry;
     list->free_count++;
   } else {
-    free(entry);
+    sfree(list_entry_size(list), entry);
     list->total_count--;
   }
   list->count--;
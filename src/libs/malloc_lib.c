@@ -35,86 +35,128 @@
 #include "debug/debug_macros.h"
 
 /* Defines */
-#define MAX_SMALLOC 32768
-#define WRAPPER_BLOCK 1024
+#define NUM_SIZE_CLASSES (SMALLOC_MAX_SIZE / SMALLOC_ALIGN)
 #define SMALLOC_BLOCK (0x1 << 20)
 
+/* A freed block, linked into the free list of its size class */
+typedef struct SMalloc_Free_struct {
+  struct SMalloc_Free_struct* next;
+} SMalloc_Free;
+
+typedef struct SMalloc_Class_Stats_struct {
+  unsigned long long allocs;
+  unsigned long long frees;
+  unsigned long long peak_live;
+} SMalloc_Class_Stats;
+
 /* Global Variables */
-static char* raw_mem_ptr = NULL;
-static int raw_mem_size = 0;
-static SMalloc_Entry* wrapper_free_list = NULL;
-static SMalloc_Entry* smalloc_free_list[MAX_SMALLOC];
+static char* slab_ptr = NULL;
+static int slab_size = 0; /* bytes left in the current slab */
+static SMalloc_Free* smalloc_free_list[NUM_SIZE_CLASSES];
+static SMalloc_Class_Stats class_stats[NUM_SIZE_CLASSES];
+static SMalloc_Stats stats;
 
-static inline SMalloc_Entry* get_wrapper();
-static inline void free_wrapper(SMalloc_Entry* wrap);
+static inline uns size_class(int nbytes);
+static inline void new_slab(void);
 
 /**************************************************************************************/
-/* get_wrapper */
-static inline SMalloc_Entry* get_wrapper() {
-  SMalloc_Entry* tmp;
-
-  if (wrapper_free_list == NULL) {
-    char* wrap_mem = (char*)malloc(sizeof(SMalloc_Entry) * WRAPPER_BLOCK);
-    SMalloc_Entry* cur_wrap;
-    int ii;
-    ASSERT(0, wrap_mem);
-    for (ii = 0; ii < WRAPPER_BLOCK; ii++) {
-      cur_wrap = (SMalloc_Entry*)wrap_mem;
-      cur_wrap->next = wrapper_free_list;
-      wrapper_free_list = cur_wrap;
-      wrap_mem += sizeof(SMalloc_Entry);
-    }
-  }
-  tmp = wrapper_free_list;
-  wrapper_free_list = wrapper_free_list->next;
-  return tmp;
+/* size_class: class cc holds blocks of (cc + 1) * SMALLOC_ALIGN bytes */
+static inline uns size_class(int nbytes) {
+  return nbytes <= SMALLOC_ALIGN ? 0 : (nbytes - 1) / SMALLOC_ALIGN;
 }
 
 /**************************************************************************************/
-/* free_wrapper */
-static inline void free_wrapper(SMalloc_Entry* wrap) {
-  wrap->next = wrapper_free_list;
-  wrapper_free_list = wrap;
+/* new_slab */
+static inline void new_slab(void) {
+  /* the rest of the old slab becomes a free block of its own size class */
+  if (slab_size >= SMALLOC_ALIGN) {
+    SMalloc_Free* tail = (SMalloc_Free*)slab_ptr;
+    uns cc = size_class(slab_size);
+    ASSERT(0, (cc + 1) * SMALLOC_ALIGN == slab_size);
+    tail->next = smalloc_free_list[cc];
+    smalloc_free_list[cc] = tail;
+  }
+  slab_ptr = (char*)malloc(SMALLOC_BLOCK);
+  ASSERT(0, slab_ptr);
+  slab_size = SMALLOC_BLOCK;
+  stats.slabs++;
 }
 
 /**************************************************************************************/
 /* smalloc */
 void* smalloc(int nbytes) {
-  SMalloc_Entry* tmp;
-  void* ptr = NULL;
-
-  ASSERT(0, nbytes < MAX_SMALLOC);
-  if (smalloc_free_list[nbytes]) {
-    tmp = smalloc_free_list[nbytes];
-    smalloc_free_list[nbytes] = smalloc_free_list[nbytes]->next;
-    ptr = tmp->data;
-    free_wrapper(tmp);
+  void* ptr;
+
+  ASSERT(0, nbytes >= 0);
+  stats.allocs++;
+  if (nbytes >= SMALLOC_MAX_SIZE) {
+    stats.large_allocs++;
+    ptr = malloc(nbytes);
+    ASSERT(0, ptr);
+    return ptr;
+  }
+
+  uns cc = size_class(nbytes);
+  int size = (cc + 1) * SMALLOC_ALIGN;
+  if (smalloc_free_list[cc]) {
+    ptr = smalloc_free_list[cc];
+    smalloc_free_list[cc] = smalloc_free_list[cc]->next;
   } else { /* need to allocate some memory */
-    if (nbytes > raw_mem_size) {
-      while (raw_mem_size >= sizeof(SMalloc_Entry)) { /* never can have too many wrappers */
-        tmp = (SMalloc_Entry*)raw_mem_ptr;
-        free_wrapper(tmp);
-        raw_mem_ptr += sizeof(SMalloc_Entry);
-        raw_mem_size -= sizeof(SMalloc_Entry);
-      }
-      /* Yes, we waste up to 7 bytes per SMALLOC_BLOCK allocation */
-      raw_mem_ptr = (char*)malloc(SMALLOC_BLOCK);
-      ASSERT(0, raw_mem_ptr);
-      raw_mem_size = SMALLOC_BLOCK;
-    }
-    ptr = raw_mem_ptr;
-    raw_mem_ptr += nbytes;
-    raw_mem_size -= nbytes;
+    if (size > slab_size)
+      new_slab();
+    ptr = slab_ptr;
+    slab_ptr += size;
+    slab_size -= size;
   }
-  ASSERT(0, ptr);
+
+  SMalloc_Class_Stats* cs = &class_stats[cc];
+  cs->allocs++;
+  if (cs->allocs - cs->frees > cs->peak_live)
+    cs->peak_live = cs->allocs - cs->frees;
+  stats.live_bytes += size;
+  if (stats.live_bytes > stats.peak_live_bytes)
+    stats.peak_live_bytes = stats.live_bytes;
   return ptr;
 }
 
 /**************************************************************************************/
-/* sfree */
+/* sfree: nbytes must be the size passed to smalloc */
 void sfree(int nbytes, void* item) {
-  SMalloc_Entry* wrapper = get_wrapper();
-  wrapper->next = smalloc_free_list[nbytes];
-  wrapper->data = item;
-  smalloc_free_list[nbytes] = wrapper;
+  stats.frees++;
+  if (nbytes >= SMALLOC_MAX_SIZE) {
+    free(item);
+    return;
+  }
+
+  uns cc = size_class(nbytes);
+  SMalloc_Free* block = (SMalloc_Free*)item;
+  block->next = smalloc_free_list[cc];
+  smalloc_free_list[cc] = block;
+
+  class_stats[cc].frees++;
+  stats.live_bytes -= (cc + 1) * SMALLOC_ALIGN;
+}
+
+/**************************************************************************************/
+/* smalloc_get_stats */
+const SMalloc_Stats* smalloc_get_stats(void) {
+  return &stats;
+}
+
+/**************************************************************************************/
+/* smalloc_print_stats */
+void smalloc_print_stats(FILE* stream) {
+  uns cc;
+
+  fprintf(stream, "smalloc: %llu allocs, %llu frees, %llu large, %llu slabs (%llu KB), live %llu KB, peak %llu KB\n",
+          stats.allocs, stats.frees, stats.large_allocs, stats.slabs, stats.slabs * (SMALLOC_BLOCK >> 10),
+          stats.live_bytes >> 10, stats.peak_live_bytes >> 10);
+  fprintf(stream, "%8s %14s %14s %12s %12s\n", "size", "allocs", "frees", "live", "peak_live");
+  for (cc = 0; cc < NUM_SIZE_CLASSES; cc++) {
+    SMalloc_Class_Stats* cs = &class_stats[cc];
+    if (cs->allocs == 0)
+      continue;
+    fprintf(stream, "%8u %14llu %14llu %12llu %12llu\n", (cc + 1) * SMALLOC_ALIGN, cs->allocs, cs->frees,
+            cs->allocs - cs->frees, cs->peak_live);
+  }
 }
@@ -29,17 +29,27 @@
 #ifndef __MALLOC_LIB_H__
 #define __MALLOC_LIB_H__
 
-typedef struct SMalloc_Raw_struct {
-  char* ptr;
-  int cur_size;
-} SMalloc_Raw;
+#include <stdio.h>
 
-typedef struct SMalloc_Entry_struct {
-  void* data;
-  struct SMalloc_Entry_struct* next;
-} SMalloc_Entry;
+/* Requests are served from 1MB slabs, rounded up to SMALLOC_ALIGN-byte size
+   classes. Each class has its own free list, threaded through the freed blocks
+   themselves. Requests of SMALLOC_MAX_SIZE bytes or more go to malloc. */
+#define SMALLOC_ALIGN 8
+#define SMALLOC_MAX_SIZE 32768
+
+typedef struct SMalloc_Stats_struct {
+  unsigned long long allocs;          /* smalloc calls */
+  unsigned long long frees;           /* sfree calls */
+  unsigned long long live_bytes;      /* handed out and not yet freed, rounded to size classes */
+  unsigned long long peak_live_bytes;
+  unsigned long long slabs;           /* slabs taken from the system allocator */
+  unsigned long long large_allocs;    /* requests passed through to malloc */
+} SMalloc_Stats;
 
 void* smalloc(int nbytes);
 void sfree(int nbytes, void* item);
 
+const SMalloc_Stats* smalloc_get_stats(void);
+void smalloc_print_stats(FILE* stream);
+
 #endif /* #ifndef __MALLOC_LIB_H__ */
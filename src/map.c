@@ -642,12 +642,12 @@ void add_to_wake_up_lists(Op* op, void (*wake_action)(Op*, Op*, uns)) {
       }
 
       if (TRACK_L1_MISS_DEPS) {
-        // An op can occupy multiple entries in the wakeup list of another op
-        if (src_op->engine_info.l1_miss && !src_op->engine_info.l1_miss_satisfied)
-          op->engine_info.dep_on_l1_miss = TRUE;
-
-        if (src_op->engine_info.dep_on_l1_miss)
+        // An op can occupy multiple entries in the wakeup list of another op, and each one is counted
+        if ((src_op->engine_info.l1_miss && !src_op->engine_info.l1_miss_satisfied) ||
+            src_op->engine_info.dep_on_l1_miss) {
+          op->engine_info.l1_miss_dep_srcs++;
           op->engine_info.dep_on_l1_miss = TRUE;
+        }
       }
 
       if (src_op->wake_up_signaled[src_info->type]) {
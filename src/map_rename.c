@@ -81,6 +81,9 @@ void reg_table_produce(struct reg_table *reg_table, int self_reg_id, Op *op, uns
 void reg_table_arch_init(struct reg_table *reg_table, struct reg_table *parent_reg_table, uns reg_table_size,
                          int reg_type, int reg_table_type);
 
+// copy-on-write save of an SRT entry into the active checkpoint
+static inline void reg_file_checkpoint_srt_entry(int reg_type, int reg_id);
+
 /**************************************************************************************/
 /* Inline Methods */
 
@@ -402,6 +405,8 @@ static inline void reg_file_write_dst(Op *op, int self_reg_table_type, int paren
     reg_table->entries[self_reg_id].num_refs++;
 
     // update the parent table to ensure the latest assignment
+    if (parent_reg_table_type == REG_TABLE_TYPE_ARCHITECTURAL)
+      reg_file_checkpoint_srt_entry(reg_type, parent_reg_id);
     reg_table->parent_reg_table->entries[parent_reg_id].child_reg_id = self_reg_id;
 
     // update the dst register id into the op
@@ -542,10 +547,15 @@ static inline void reg_file_release_prev(Op *op, int *reg_table_types, int reg_t
 
 static inline void reg_file_init_checkpoint() {
   for (uns ii = 0; ii < REG_FILE_REG_TYPE_NUM; ++ii) {
-    map_data->reg_file[ii]->reg_checkpoint = (struct reg_checkpoint *)malloc(sizeof(struct reg_checkpoint));
-    map_data->reg_file[ii]->reg_checkpoint->entries = (struct reg_table_entry *)malloc(
-        sizeof(struct reg_table_entry) * map_data->reg_file[ii]->reg_table[REG_TABLE_TYPE_ARCHITECTURAL]->size);
-    map_data->reg_file[ii]->reg_checkpoint->is_valid = FALSE;
+    uns srt_size = map_data->reg_file[ii]->reg_table[REG_TABLE_TYPE_ARCHITECTURAL]->size;
+    struct reg_checkpoint *checkpoint = (struct reg_checkpoint *)malloc(sizeof(struct reg_checkpoint));
+    checkpoint->entries = (struct reg_table_entry *)malloc(sizeof(struct reg_table_entry) * srt_size);
+    checkpoint->logged_reg_ids = (int *)malloc(sizeof(int) * srt_size);
+    checkpoint->num_logged = 0;
+    checkpoint->version = 0;
+    checkpoint->logged_version = (Counter *)calloc(srt_size, sizeof(Counter));
+    checkpoint->is_valid = FALSE;
+    map_data->reg_file[ii]->reg_checkpoint = checkpoint;
   }
 }
 
@@ -553,31 +563,51 @@ static inline void reg_file_init_checkpoint() {
   Scarab currently does not support early flushes and will only trigger a flush if the
   oldest mispredicted branch is resolved
   Therefore, only maintain one checkpoint of that mispredicted branch for recovering SRT
+
+  The snapshot itself is O(1): SRT entries are saved lazily by reg_file_checkpoint_srt_entry()
+  before their first write after the checkpoint
 */
 static inline void reg_file_snapshot_srt() {
   for (uns ii = 0; ii < REG_FILE_REG_TYPE_NUM; ++ii) {
-    struct reg_table *srt = map_data->reg_file[ii]->reg_table[REG_TABLE_TYPE_ARCHITECTURAL];
     struct reg_checkpoint *checkpoint = map_data->reg_file[ii]->reg_checkpoint;
-    memcpy(checkpoint->entries, srt->entries, sizeof(struct reg_table_entry) * srt->size);
 
     ASSERT(map_data->proc_id, !checkpoint->is_valid);
+    checkpoint->version++;
+    checkpoint->num_logged = 0;
     checkpoint->is_valid = TRUE;
   }
 }
 
+/* save the SRT entry into the active checkpoint before it is overwritten */
+static inline void reg_file_checkpoint_srt_entry(int reg_type, int reg_id) {
+  struct reg_checkpoint *checkpoint = map_data->reg_file[reg_type]->reg_checkpoint;
+  if (!checkpoint->is_valid || checkpoint->logged_version[reg_id] == checkpoint->version)
+    return;
+
+  struct reg_table *srt = map_data->reg_file[reg_type]->reg_table[REG_TABLE_TYPE_ARCHITECTURAL];
+  ASSERT(map_data->proc_id, checkpoint->num_logged < srt->size);
+  checkpoint->logged_version[reg_id] = checkpoint->version;
+  checkpoint->entries[checkpoint->num_logged] = srt->entries[reg_id];
+  checkpoint->logged_reg_ids[checkpoint->num_logged] = reg_id;
+  checkpoint->num_logged++;
+}
+
 /*
   Scarab currently does not support early flushes and will only trigger a flush if the oldest
   mispredicted branch is resolved
   Therefore, only need to recover the SRT to the checkpoint without off_path operands before
-  the mispredicted branch
+  the mispredicted branch, i.e., restore the entries written since the checkpoint
 */
 static inline void reg_file_rollback_srt() {
   for (uns ii = 0; ii < REG_FILE_REG_TYPE_NUM; ++ii) {
     struct reg_table *srt = map_data->reg_file[ii]->reg_table[REG_TABLE_TYPE_ARCHITECTURAL];
     struct reg_checkpoint *checkpoint = map_data->reg_file[ii]->reg_checkpoint;
-    memcpy(srt->entries, checkpoint->entries, sizeof(struct reg_table_entry) * srt->size);
-
     ASSERT(map_data->proc_id, checkpoint->is_valid);
+
+    for (uns jj = 0; jj < checkpoint->num_logged; ++jj) {
+      srt->entries[checkpoint->logged_reg_ids[jj]] = checkpoint->entries[jj];
+    }
+    checkpoint->num_logged = 0;
     checkpoint->is_valid = FALSE;
   }
 }
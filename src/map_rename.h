@@ -169,8 +169,14 @@ struct reg_checkpoint {
   // metadata for validation of the special checkpoint mechanism in Scarab
   Flag is_valid;
 
-  // only map on-path op for recovery
-  struct reg_table_entry *entries;
+  // copy-on-write undo log: an SRT entry is saved here on its first write after the checkpoint
+  struct reg_table_entry *entries;  // saved entries, in the order they were first written
+  int *logged_reg_ids;              // the SRT reg id of each saved entry
+  uns num_logged;
+
+  // versioning to save each entry only once per checkpoint
+  Counter version;          // incremented by every snapshot
+  Counter *logged_version;  // per SRT entry, the checkpoint version it was last saved for
 };
 
 struct reg_file {
@@ -199,6 +199,10 @@ struct Mem_Req_struct {
   Counter dram_core_service_cycles_at_start; /* "Virtual clock" timestamp */
   uns fdip_pref_off_path;         /*set if the mem_req is requested by FDIP on the actual wrong path prediction*/
   Counter cyc_hit_by_demand_load; /*set if the mem_req (requested by FDIP) is hit by a demand load*/
+  Flag store_indexed;             /* is this request in the in-flight store index (see scan_stores)? */
+  Addr store_index_key;           /* bucket it is linked into */
+  struct Mem_Req_struct* store_index_prev;
+  struct Mem_Req_struct* store_index_next;
 };
 
 /**************************************************************************************/
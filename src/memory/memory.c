@@ -40,6 +40,7 @@
 #include "debug/debug.param.h"
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
+#include "debug/host_prof.h"
 #include "debug/memview.h"
 
 #include "core.param.h"
@@ -79,6 +80,7 @@
 
 #define MLC(proc_id) (mem->uncores[proc_id].mlc)
 #define L1(proc_id) (mem->uncores[proc_id].l1)
+#define STORE_INDEX_BUCKET_BITS 6  // bytes per in-flight store index bucket: 64
 
 /**************************************************************************************/
 /* Global Variables */
@@ -113,9 +115,10 @@ static void update_memory_queues(void);
 static void update_on_chip_memory_stats(void);
 
 static void mark_ops_as_l1_miss(Mem_Req* req);
-static void mark_l1_miss_deps(Op* op);
-static void unmark_l1_miss_deps(Op* op);
+static Flag waiting_for_l1_miss(Op* op);
+static void update_l1_miss_deps(Op* op, Flag was_waiting);
 static void update_mem_req_occupancy_counter(Mem_Req_Type type, int delta);
+static void mem_store_index_update(Mem_Req* req);
 
 int mem_compare_priority(const void* a, const void* b);
 void mem_start_mlc_access(Mem_Req* req);
@@ -300,6 +303,7 @@ void init_memory() {
   }
   mem->num_req_buffers_per_core = calloc(NUM_CORES, sizeof(uns));
   init_list(&mem->req_buffer_free_list, "REQ BUF FREE LIST", sizeof(int), TRUE);
+  init_hash_table(&mem->store_index, "STORE REQ INDEX", mem->total_mem_req_buffers * 2, sizeof(Mem_Req*));
 
   if (ROUND_ROBIN_TO_L1) {
     mem->l1_in_buffer_core = (List*)malloc(sizeof(List) * NUM_CORES);
@@ -478,7 +482,9 @@ void reset_memory() {
     int* free_list_entry = sl_list_add_tail(&mem->req_buffer_free_list);
     *free_list_entry = ii;
     mem->req_buffer[ii].state = MRS_INV;
+    mem->req_buffer[ii].store_indexed = FALSE;
   }
+  hash_table_clear(&mem->store_index);
 
   mem->req_count = 0;
 
@@ -572,6 +578,7 @@ void mem_free_reqbuf(Mem_Req* req) {
   ASSERT(req->proc_id, req->reserved_entry_count == 0);
 
   req->state = MRS_INV;
+  mem_store_index_update(req);
   mem->req_count--;
   ASSERT(req->proc_id, mem->req_count >= 0);
   clear_list(&req->op_ptrs);
@@ -816,33 +823,33 @@ void update_memory() {
 
     perf_pred_cycle();
 
-    pref_update();
-    update_memory_queues();
+    HOST_PROF_REGION(PREF, pref_update());
+    HOST_PROF_REGION(MEM_QUEUES, update_memory_queues());
     update_on_chip_memory_stats();
 
-    mem_process_mlc_fill_reqs();
-    mem_process_l1_fill_reqs();
+    HOST_PROF_REGION(MEM_FILLS, mem_process_mlc_fill_reqs());
+    HOST_PROF_REGION(MEM_FILLS, mem_process_l1_fill_reqs());
   }
 
   if (freq_is_ready(FREQ_DOMAIN_MEMORY)) {
     cycle_count = freq_cycle_count(FREQ_DOMAIN_MEMORY);
 
     // dram_process_main_memory_reqs();
-    ramulator_tick();
+    HOST_PROF_REGION(RAMULATOR, ramulator_tick());
   }
 
   if (freq_is_ready(FREQ_DOMAIN_L1)) {
     cycle_count = freq_cycle_count(FREQ_DOMAIN_L1);
 
-    mem_process_bus_out_reqs();
-    mem_process_l1_reqs();
-    mem_process_mlc_reqs();
+    HOST_PROF_REGION(MEM_REQS, mem_process_bus_out_reqs());
+    HOST_PROF_REGION(MEM_REQS, mem_process_l1_reqs());
+    HOST_PROF_REGION(MEM_REQS, mem_process_mlc_reqs());
   }
 
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     if (freq_is_ready(FREQ_DOMAIN_CORES[proc_id])) {
       cycle_count = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
-      mem_process_core_fill_reqs(proc_id);
+      HOST_PROF_REGION(CORE_FILLS, mem_process_core_fill_reqs(proc_id));
     }
   }
 }
@@ -2429,21 +2436,66 @@ static void mem_process_core_fill_reqs(uns proc_id) {
 /**************************************************************************************/
 /* scan_stores: */
 
+/* Only the buckets that a store request containing addr can start in are
+ * searched: none is larger than store_index_max_size. */
 Flag scan_stores(Addr addr, uns size) {
-  uns ii;
-
-  for (ii = 0; ii < mem->total_mem_req_buffers; ii++) {
-    Mem_Req* req = &mem->req_buffer[ii];
-    if (req->state != MRS_INV && req->type == MRT_DSTORE && BYTE_CONTAIN(req->addr, req->size, addr, size)) {
-      uns load_proc_id = get_proc_id_from_cmp_addr(addr);
-      ASSERTM(req->proc_id, req->proc_id == load_proc_id, "Load from %d matched a store from %d!\n", load_proc_id,
-              req->proc_id);
-      return SUCCESS;
+  if (!mem->store_index_max_size)
+    return FAILURE;
+
+  Addr first_addr = addr >= mem->store_index_max_size - 1 ? addr - (mem->store_index_max_size - 1) : 0;
+  for (Addr key = first_addr >> STORE_INDEX_BUCKET_BITS; key <= addr >> STORE_INDEX_BUCKET_BITS; key++) {
+    Mem_Req** head = (Mem_Req**)hash_table_access(&mem->store_index, key);
+    for (Mem_Req* req = head ? *head : NULL; req; req = req->store_index_next) {
+      ASSERT(req->proc_id, req->state != MRS_INV && req->type == MRT_DSTORE);
+      if (BYTE_CONTAIN(req->addr, req->size, addr, size)) {
+        uns load_proc_id = get_proc_id_from_cmp_addr(addr);
+        ASSERTM(req->proc_id, req->proc_id == load_proc_id, "Load from %d matched a store from %d!\n", load_proc_id,
+                req->proc_id);
+        return SUCCESS;
+      }
     }
   }
   return FAILURE;
 }
 
+/**************************************************************************************/
+/* mem_store_index_update: */
+/* Keeps mem->store_index holding exactly the valid MRT_DSTORE requests, linked
+ * into the bucket of their start address. Call after a request's state, type
+ * or address changes. */
+
+static void mem_store_index_update(Mem_Req* req) {
+  Flag indexed = req->state != MRS_INV && req->type == MRT_DSTORE;
+  Addr key = req->addr >> STORE_INDEX_BUCKET_BITS;
+
+  if (req->store_indexed && (!indexed || req->store_index_key != key)) {
+    Mem_Req** head = (Mem_Req**)hash_table_access(&mem->store_index, req->store_index_key);
+    ASSERT(req->proc_id, head && *head);
+    if (req->store_index_prev)
+      req->store_index_prev->store_index_next = req->store_index_next;
+    else
+      *head = req->store_index_next;
+    if (req->store_index_next)
+      req->store_index_next->store_index_prev = req->store_index_prev;
+    if (!*head)
+      hash_table_access_delete(&mem->store_index, req->store_index_key);
+    req->store_indexed = FALSE;
+  }
+
+  if (indexed && !req->store_indexed) {
+    Flag new_entry;
+    Mem_Req** head = (Mem_Req**)hash_table_access_create(&mem->store_index, key, &new_entry);
+    req->store_index_key = key;
+    req->store_index_prev = NULL;
+    req->store_index_next = *head;
+    if (*head)
+      (*head)->store_index_prev = req;
+    *head = req;
+    req->store_indexed = TRUE;
+    mem->store_index_max_size = MAX2(mem->store_index_max_size, req->size);
+  }
+}
+
 /**************************************************************************************/
 /* mem_search_reqbuf: */
 
@@ -2773,13 +2825,13 @@ Flag mem_adjust_matching_request(Mem_Req* req, Mem_Req_Type type, Addr addr, uns
 
     if (!req->done_func)
       req->done_func = done_func;
-    if (req->l1_miss) {
+    Flag was_waiting = waiting_for_l1_miss(op);
+    if (req->l1_miss)
       op->engine_info.l1_miss = TRUE;
-      if (TRACK_L1_MISS_DEPS)
-        mark_l1_miss_deps(op);
-    }
 
     op->engine_info.l1_miss_satisfied = req->l1_miss_satisfied ? TRUE : op->engine_info.l1_miss_satisfied;
+    if (TRACK_L1_MISS_DEPS)
+      update_l1_miss_deps(op, was_waiting);
 
     // cmp FIXME prefetchers
     if (demand_hit_prefetch && type != MRT_DPRF && type != MRT_IPRF) {
@@ -2796,6 +2848,7 @@ Flag mem_adjust_matching_request(Mem_Req* req, Mem_Req_Type type, Addr addr, uns
       pref_ul1_pref_hit_late(req->proc_id, req->addr, req->loadPC, req->global_hist, req->prefetcher_id);
       req->demand_match_prefetch = TRUE;
       req->type = type;  // type promotion
+      mem_store_index_update(req);
       req->done_func = done_func;
       // if (DRAM_SCHED == DRAM_SCHED_FAIR_QUEUING_2LEVEL) {
       //    req->fq_start_time = MAX_CTR;
@@ -2822,6 +2875,7 @@ Flag mem_adjust_matching_request(Mem_Req* req, Mem_Req_Type type, Addr addr, uns
            bit of inaccuracy, but quick_release perf diff is
            minimal. */
         req->type = type;
+        mem_store_index_update(req);
         memview_req_changed_type(req);
       }
       qsort(req->queue->base, req->queue->entry_count, sizeof(Mem_Queue_Entry),
@@ -3207,6 +3261,7 @@ static void mem_init_new_req(Mem_Req* new_req, Mem_Req_Type type, Mem_Queue_Type
   new_req->priority = new_priority;
   new_req->size = size;
   ASSERT(new_req->proc_id, new_req->size <= VA_PAGE_SIZE_BYTES);
+  mem_store_index_update(new_req);
   new_req->reserved_entry_count = 0;
   // TODO: actually populate mem_flat_bank, mem_channel, and mem_bank by
   // grabbing that information from Ramulator
@@ -4593,9 +4648,10 @@ static void mark_ops_as_l1_miss(Mem_Req* req) {
     if (op->unique_num == *op_unique && op->op_pool_valid) {
       ASSERT(req->proc_id, req->proc_id == op->proc_id);
       if (op->req == req) {
+        Flag was_waiting = waiting_for_l1_miss(op);
         op->engine_info.l1_miss = TRUE;
         if (TRACK_L1_MISS_DEPS)
-          mark_l1_miss_deps(op);
+          update_l1_miss_deps(op, was_waiting);
       }
     }
     op_unique = (Counter*)list_next_element(&req->op_uniques);
@@ -4624,10 +4680,10 @@ void mark_ops_as_l1_miss_satisfied(Mem_Req* req) {
               req->addr, op->op_pool_valid, op->proc_id, op->op_num, op->off_path, op->uop->op_type, op->uop->mem_type);
 
       if (op->req == req) {
+        Flag was_waiting = waiting_for_l1_miss(op);
         op->engine_info.l1_miss_satisfied = TRUE;
-        if (TRACK_L1_MISS_DEPS) {
-          unmark_l1_miss_deps(op);
-        }
+        if (TRACK_L1_MISS_DEPS)
+          update_l1_miss_deps(op, was_waiting);
       }
     }
 
@@ -4636,84 +4692,68 @@ void mark_ops_as_l1_miss_satisfied(Mem_Req* req) {
 }
 
 /**************************************************************************************/
-/* mark_l1_miss_deps: */
-/* recursively go through the wake up lists of the op and mark ops as
- * l1_miss_dep */
-static void mark_l1_miss_deps(Op* op) {
-  Wake_Up_Entry* temp;
-
-  ASSERT(op->proc_id,
-         (op->engine_info.l1_miss && !op->engine_info.l1_miss_satisfied) || op->engine_info.dep_on_l1_miss);
-
-  for (temp = op->wake_up_head; temp; temp = temp->next) {
-    Op* dep_op = temp->op;
-    Counter dep_unique_num = temp->unique_num;
-
-    if (dep_op->unique_num == dep_unique_num && dep_op->op_pool_valid) {
-      ASSERT(op->proc_id, op->proc_id == dep_op->proc_id);
-      /*printf("MARK c: %s dep_op: %s %s %s %s op: %s %s %s %s\n",
-         unsstr64(cycle_count), unsstr64(dep_op->unique_num),
-         unsstr64(dep_op->exec_cycle), disasm_op(dep_op, TRUE),
-         unsstr64(dep_op->oracle_info.va), unsstr64(op->unique_num),
-         unsstr64(op->exec_cycle), disasm_op(op, TRUE),
-         unsstr64(op->oracle_info.va)); */
-      ASSERT(dep_op->proc_id, !dep_op->engine_info.l1_miss || dep_op->uop->mem_type == MEM_ST);
-      if (!dep_op->engine_info.dep_on_l1_miss) {
-        dep_op->engine_info.dep_on_l1_miss = TRUE;
-        mark_l1_miss_deps(dep_op);
-      }
-    }
-  }
+/* waiting_for_l1_miss: the op is an outstanding l1 miss or depends on one */
+
+static Flag waiting_for_l1_miss(Op* op) {
+  return (op->engine_info.l1_miss && !op->engine_info.l1_miss_satisfied) || op->engine_info.dep_on_l1_miss;
 }
 
 /**************************************************************************************/
-/* unmark_l1_miss_deps: */
-/* recursively go through the wake up lists of the op and unmark ops as
- * l1_miss_dep */
+/* update_l1_miss_deps: */
+/* Every op counts its wake up entries from sources that are waiting for an l1
+ * miss (l1_miss_dep_srcs), and is dep_on_l1_miss while the count is nonzero.
+ * When an op starts or stops waiting, the counts of its dependents change by
+ * one per entry, and only dependents whose own state flips are propagated
+ * further. All changes of one call go in the same direction, so every op
+ * flips at most once and the work is bounded by the wake up entries of the ops
+ * that actually change. An explicit work list replaces the recursion. */
+
+static void update_l1_miss_deps(Op* op, Flag was_waiting) {
+  static Op** work_list = NULL;
+  static uns work_list_size = 0;
+  Flag waiting = waiting_for_l1_miss(op);
+  uns num_work = 0;
+
+  if (waiting == was_waiting)
+    return;
 
-static void unmark_l1_miss_deps(Op* op) {
-  Wake_Up_Entry* temp;
+  if (!work_list) {
+    work_list_size = 256;
+    work_list = (Op**)malloc(sizeof(Op*) * work_list_size);
+  }
+  work_list[num_work++] = op;
 
-  ASSERT(op->proc_id,
-         op->engine_info.l1_miss_satisfied || (!op->engine_info.dep_on_l1_miss && op->engine_info.was_dep_on_l1_miss));
+  while (num_work) {
+    Op* src_op = work_list[--num_work];
+    Wake_Up_Entry* temp;
 
-  /* Go thru the wake up list and unmark ops if they are not dependent on
-   * another l1 miss */
-  for (temp = op->wake_up_head; temp; temp = temp->next) {
-    Op* dep_op = temp->op;
-    Counter dep_unique_num = temp->unique_num;
+    for (temp = src_op->wake_up_head; temp; temp = temp->next) {
+      Op* dep_op = temp->op;
 
-    if (dep_op->unique_num == dep_unique_num && dep_op->op_pool_valid) {
-      int ii;
-      Flag still_dep_on_l1_miss = FALSE;
-
-      ASSERT(op->proc_id, op->proc_id == dep_op->proc_id);
-      ASSERT(dep_op->proc_id, dep_op->engine_info.dep_on_l1_miss || dep_op->engine_info.was_dep_on_l1_miss);
-
-      if (dep_op->engine_info.dep_on_l1_miss) {
-        /* Determine if the op is dependent on another l1_miss */
-        for (ii = 0; ii < dep_op->num_srcs; ii++) {
-          Src_Info* src_info = &dep_op->src_info[ii];
-          Op* src_op = src_info->op;
-
-          if (src_op->unique_num == src_info->unique_num && src_op->op_pool_valid) {
-            if (src_op->unique_num != op->unique_num)
-              if ((src_op->engine_info.l1_miss && !src_op->engine_info.l1_miss_satisfied) ||
-                  src_op->engine_info.dep_on_l1_miss)
-                still_dep_on_l1_miss = TRUE;
-          }
-          if (still_dep_on_l1_miss)
-            break;
-        }
+      if (dep_op->unique_num != temp->unique_num || !dep_op->op_pool_valid)
+        continue;
+      ASSERT(src_op->proc_id, src_op->proc_id == dep_op->proc_id);
+      ASSERT(dep_op->proc_id, !dep_op->engine_info.l1_miss || dep_op->uop->mem_type == MEM_ST);
 
-        /* If the op is not dependent on another l1 miss, then go ahead and
-           unmark it and figure out if we need to unmark its dependents */
-        if (!still_dep_on_l1_miss) {
+      Flag dep_was_waiting = waiting_for_l1_miss(dep_op);
+      if (waiting) {
+        dep_op->engine_info.l1_miss_dep_srcs++;
+        dep_op->engine_info.dep_on_l1_miss = TRUE;
+      } else {
+        ASSERT(dep_op->proc_id, dep_op->engine_info.l1_miss_dep_srcs > 0);
+        if (--dep_op->engine_info.l1_miss_dep_srcs == 0) {
           dep_op->engine_info.dep_on_l1_miss = FALSE;
           dep_op->engine_info.was_dep_on_l1_miss = TRUE;
-          unmark_l1_miss_deps(dep_op);
         }
       }
+
+      if (waiting_for_l1_miss(dep_op) != dep_was_waiting) {
+        if (num_work == work_list_size) {
+          work_list_size *= 2;
+          work_list = (Op**)realloc(work_list, sizeof(Op*) * work_list_size);
+        }
+        work_list[num_work++] = dep_op;
+      }
     }
   }
 }
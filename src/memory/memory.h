@@ -140,6 +140,8 @@ typedef struct Memory_struct {
   /* miss buffer */
   Mem_Req* req_buffer;
   List req_buffer_free_list;
+  Hash_Table store_index; /* valid MRT_DSTORE reqs by address bucket -> first Mem_Req* of the bucket */
+  uns store_index_max_size;
   List* l1_in_buffer_core;
   uns total_mem_req_buffers;
   uns* num_req_buffers_per_core;
@@ -36,6 +36,8 @@
 /**************************************************************************************/
 /* Types */
 
+struct Warmup_Inst_struct;
+
 typedef enum Model_Id_enum {
   CMP_MODEL,
   DUMB_MODEL,
@@ -66,6 +68,7 @@ typedef struct Model_struct {
   void (*op_fetched_hook)(Op*);
   void (*op_retired_hook)(Op*);  // called just before the op is freed
   void (*warmup_func)(Op* op);   // called for warmup(may be NULL)
+  void (*warmup_inst_func)(uns proc_id, struct Warmup_Inst_struct* inst);  // warmup without uops (may be NULL)
 
   /*      void (*l0_cache_miss_hook)      (Op *); */
   /*      void (*resolve_mispredict_hook) (Op *); */
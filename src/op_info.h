@@ -94,6 +94,7 @@ struct Op_Info_struct {
   Flag l1_miss_satisfied;   // l1 miss caused by this op is already satisfied
   Flag dep_on_l1_miss;      // op is waiting for an l1_miss to be satisfied
   Flag was_dep_on_l1_miss;  // op was waiting for an l1_miss to be satisfied, but not any more
+  uns l1_miss_dep_srcs;     // wake up entries from sources still waiting for an l1_miss (dep_on_l1_miss if > 0)
 };
 
 /**************************************************************************************/
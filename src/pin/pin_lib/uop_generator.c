@@ -126,6 +126,8 @@ static void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop*
 static void convert_t_uop_to_info(uns8 proc_id, Trace_Uop* t_uop, Inst_Info* info);
 static void populate_static_inst_info(Static_Inst_Info* si, const Inst_Info* info, const ctype_pin_inst* pi);
 static void populate_static_op_info(Static_Op_Info* so, const Inst_Info* info);
+static void replay_uop_translation(uns8 proc_id, const Uop_Translation* xlat, ctype_pin_inst* pi,
+                                   Trace_Uop** trace_uop);
 static void convert_dyn_uop(uns8 proc_id, Inst_Info* info, ctype_pin_inst* pi, Trace_Uop* trace_uop, uns mem_size,
                             Flag is_last_uop);
 
@@ -840,6 +842,18 @@ void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace
     pi->st_vaddr[st] = convert_to_cmp_addr(proc_id, pi->st_vaddr[st]);
   }
 
+  // Repeat executions of a cracked macro only patch the dynamic fields. Gather/scatter uop counts
+  // depend on the mask, so those are cracked every time.
+  Uop_Translation* xlat = NULL;
+  if (!pi->fake_inst && !pi->is_gather_scatter) {
+    xlat = cpp_uop_translation_access_create(proc_id, pi->instruction_addr, pi->inst_binary_lsb, pi->inst_binary_msb,
+                                             &new_entry);
+    if (xlat->num_uop) {
+      replay_uop_translation(proc_id, xlat, pi, trace_uop);
+      return;
+    }
+  }
+
   if (pi->fake_inst) {
     ASSERT(proc_id, fake_templates_ready);
     info = &fake_inst_info_scratch[proc_id];
@@ -966,7 +980,32 @@ void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace
     }
     trace_uop[ii]->static_inst = si;
     trace_uop[ii]->static_op = so;
+    if (xlat)
+      xlat->infos[ii] = trace_uop[ii]->info;
   }
+  if (xlat) {
+    xlat->static_inst = trace_uop[0]->static_inst;
+    xlat->num_uop = num_uop;
+  }
+}
+
+// Attach the cached Inst_Info / static structs of every uop and fill in this execution's values.
+static void replay_uop_translation(uns8 proc_id, const Uop_Translation* xlat, ctype_pin_inst* pi,
+                                   Trace_Uop** trace_uop) {
+  const uns num_uop = xlat->num_uop;
+  for (uns ii = 0; ii < num_uop; ii++) {
+    Inst_Info* info = xlat->infos[ii];
+    ASSERT(proc_id, info->addr == pi->instruction_addr);
+    ASSERT(proc_id, info->trace_info.inst_size == pi->size);
+
+    trace_uop[ii]->info = info;
+    trace_uop[ii]->eom = FALSE;
+    trace_uop[ii]->static_inst = xlat->static_inst;
+    trace_uop[ii]->static_op = xlat->static_inst->uops[ii];
+    convert_dyn_uop(proc_id, info, pi, trace_uop[ii], info->table_info.mem_size, ii == num_uop - 1);
+  }
+  trace_uop[num_uop - 1]->eom = TRUE;
+  trace_uop[num_uop - 1]->npc = pi->instruction_next_addr;
 }
 
 // Fill the shared per-macro-instruction static struct from the built Inst_Info + pi.
@@ -29,6 +29,8 @@
 #include "power_intf.h"
 
 #include <stdio.h>
+#include <string.h>
+#include <strings.h>
 
 #include "globals/assert.h"
 #include "globals/global_defs.h"
@@ -58,12 +60,26 @@ typedef struct Value_struct {
   double scaled_value; /* Scaled to Scarab's V/f */
 } Value;
 
+#define NUM_POWER_STATS (POWER_STATS_END - POWER_STATS_BEGIN)
+
+/* In-process model of one domain: dynamic energy is linear in the POWER_* stats,
+   the other results are fixed (calibrated offline at the reference V/f) */
+typedef struct Power_Coeffs_struct {
+  double energy[NUM_POWER_STATS]; /* joules per event, indexed by stat - POWER_STATS_BEGIN */
+  double results[POWER_RESULT_NUM_ELEMS];
+  Flag results_set[POWER_RESULT_NUM_ELEMS];
+} Power_Coeffs;
+
 /**************************************************************************************/
 /* Local Prototypes */
 
 // static void dump_power_stats(void);
+static void read_power_coeffs(const char* filename);
+static void clear_values(void);
 static void run_power_model_exec(void);
 static void parse_power_model_results(void);
+static void compute_power_model_results(void);
+static void finish_power_model_results(void);
 static void update_energy_stats(void);
 static void scale_values(Power_Domain domain);
 static Freq_Domain_Id freq_domain(Power_Domain);
@@ -76,6 +92,7 @@ static const char* model_results_filename = "power_model_results";
 
 static Value values[POWER_DOMAIN_NUM_ELEMS][POWER_RESULT_NUM_ELEMS];
 static double elapsed_time;  // time elapsed in this interval, seconds
+static Power_Coeffs* coeffs;  // per domain, only with POWER_INTF_COEFF_FILE
 
 /**************************************************************************************/
 /* power_intf_init: */
@@ -89,6 +106,9 @@ void power_intf_init(void) {
   for (uns stat = POWER_STATS_BEGIN; stat <= POWER_STATS_END; ++stat) {
     ASSERT(0, GET_TOTAL_STAT_EVENT(0, stat) == 0);
   }
+
+  if (POWER_INTF_COEFF_FILE)
+    read_power_coeffs(POWER_INTF_COEFF_FILE);
 }
 
 /**************************************************************************************/
@@ -98,8 +118,14 @@ void power_intf_calc(void) {
   double fempto_elapsed_time = (double)GET_TOTAL_STAT_EVENT(0, POWER_TIME);
   elapsed_time = fempto_elapsed_time * 1.0e-15;
 
-  run_power_model_exec();
-  parse_power_model_results();
+  clear_values();
+  if (coeffs) {
+    compute_power_model_results();
+  } else {
+    run_power_model_exec();
+    parse_power_model_results();
+  }
+  finish_power_model_results();
   update_energy_stats();
 }
 
@@ -126,6 +152,73 @@ void power_intf_done(void) {
   power_intf_calc();
 }
 
+/**************************************************************************************/
+/* read_power_coeffs: Each line of the table is "<domain> <name> <value>", where
+ * domain is a Power_Domain or CORE (every core), and name is either a POWER_*
+ * stat (value in joules per event) or a Power_Result other than TOTAL and
+ * DYNAMIC (value in the result's unit, STATIC in watts). As with CACTI's
+ * output, MEMORY STATIC is per DRAM chip. '#' starts a comment. */
+
+void read_power_coeffs(const char* filename) {
+  FILE* file = fopen(filename, "r");
+  ASSERTM(0, file, "Could not open power coefficient file %s\n", filename);
+  coeffs = (Power_Coeffs*)calloc(POWER_DOMAIN_NUM_ELEMS, sizeof(Power_Coeffs));
+
+  char line[MAX_STR_LENGTH + 1];
+  char domain_str[MAX_STR_LENGTH + 1];
+  char name_str[MAX_STR_LENGTH + 1];
+  double value;
+  uns line_num = 0;
+
+  while (fgets(line, MAX_STR_LENGTH, file)) {
+    line_num++;
+    char* comment = strchr(line, '#');
+    if (comment)
+      *comment = '\0';
+    int num_matches = sscanf(line, "%s %s %le", domain_str, name_str, &value);
+    if (num_matches <= 0)
+      continue;
+    ASSERTM(0, num_matches == 3, "%s:%u: expected <domain> <name> <value>\n", filename, line_num);
+
+    uns first_domain, last_domain;
+    if (!strcasecmp(domain_str, "CORE")) {
+      first_domain = POWER_DOMAIN_CORE_0;
+      last_domain = POWER_DOMAIN_CORE_7;
+    } else {
+      first_domain = last_domain = Power_Domain_parse(domain_str);
+    }
+    ASSERTM(0, last_domain != POWER_DOMAIN_OTHER, "%s:%u: OTHER power comes from POWER_OTHER\n", filename,
+            line_num);
+
+    for (uns domain = first_domain; domain <= last_domain; ++domain) {
+      if (!strncmp(name_str, "POWER_", 6)) {
+        Stat_Enum stat = get_stat_idx(name_str);
+        ASSERTM(0, stat > POWER_STATS_BEGIN && stat < POWER_STATS_END, "%s:%u: %s is not a power stat\n",
+                filename, line_num, name_str);
+        coeffs[domain].energy[stat - POWER_STATS_BEGIN] = value;
+      } else {
+        Power_Result result = Power_Result_parse(name_str);
+        ASSERTM(0, result != POWER_RESULT_TOTAL && result != POWER_RESULT_DYNAMIC,
+                "%s:%u: %s is derived from the stats\n", filename, line_num, name_str);
+        coeffs[domain].results[result] = value;
+        coeffs[domain].results_set[result] = TRUE;
+      }
+    }
+  }
+
+  ASSERTM(0, feof(file) && !ferror(file), "Error reading %s\n", filename);
+  fclose(file);
+}
+
+void clear_values(void) {
+  /* Mark all values as unset */
+  for (uns domain = 0; domain < POWER_DOMAIN_NUM_ELEMS; ++domain) {
+    for (uns result = 0; result < POWER_RESULT_NUM_ELEMS; ++result) {
+      values[domain][result].set = FALSE;
+    }
+  }
+}
+
 void run_power_model_exec(void) {
   power_print_mcpat_xml_infile();
   power_print_cacti_cfg_infile();
@@ -140,13 +233,6 @@ void run_power_model_exec(void) {
 }
 
 void parse_power_model_results(void) {
-  /* Mark all values as unset */
-  for (uns domain = 0; domain < POWER_DOMAIN_NUM_ELEMS; ++domain) {
-    for (uns result = 0; result < POWER_RESULT_NUM_ELEMS; ++result) {
-      values[domain][result].set = FALSE;
-    }
-  }
-
   FILE* file = file_tag_fopen(NULL, model_results_filename, "r");
   ASSERTM(0, file, "Could not open %s\n", model_results_filename);
 
@@ -171,6 +257,56 @@ void parse_power_model_results(void) {
 
   ASSERTM(0, feof(file) && !ferror(file), "Error reading %s\n", model_results_filename);
   fclose(file);
+}
+
+/**************************************************************************************/
+/* compute_power_model_results: In-process replacement for McPAT/CACTI. Like
+ * the stats written to McPAT's input, core domains use their own core's
+ * counts and UNCORE/MEMORY the counts accumulated over all cores. */
+
+void compute_power_model_results(void) {
+  for (uns domain = 0; domain < POWER_DOMAIN_OTHER; ++domain) {
+    Flag is_core = domain <= POWER_DOMAIN_CORE_7;
+    uns proc_id = domain - POWER_DOMAIN_CORE_0;
+    if (is_core && proc_id >= NUM_CORES)
+      continue;
+
+    Power_Coeffs* domain_coeffs = &coeffs[domain];
+    double energy = 0.0;
+    for (uns ii = 1; ii < NUM_POWER_STATS; ++ii) {
+      if (domain_coeffs->energy[ii] == 0.0)
+        continue;
+      Stat_Enum stat = POWER_STATS_BEGIN + ii;
+      Counter count = is_core ? GET_TOTAL_STAT_EVENT(proc_id, stat) : GET_ACCUM_STAT_EVENT(stat);
+      energy += domain_coeffs->energy[ii] * (double)count;
+    }
+
+    for (uns result = 0; result < POWER_RESULT_NUM_ELEMS; ++result) {
+      if (domain_coeffs->results_set[result]) {
+        values[domain][result].intf_value = domain_coeffs->results[result];
+        values[domain][result].set = TRUE;
+      }
+    }
+    values[domain][POWER_RESULT_DYNAMIC].intf_value = elapsed_time > 0.0 ? energy / elapsed_time : 0.0;
+    values[domain][POWER_RESULT_DYNAMIC].set = TRUE;
+    if (!values[domain][POWER_RESULT_STATIC].set) {
+      values[domain][POWER_RESULT_STATIC].intf_value = 0.0;
+      values[domain][POWER_RESULT_STATIC].set = TRUE;
+    }
+    ASSERTM(0,
+            !POWER_INTF_ENABLE_SCALING || (values[domain][POWER_RESULT_VOLTAGE].set &&
+                                           values[domain][POWER_RESULT_MIN_VOLTAGE].set &&
+                                           values[domain][POWER_RESULT_FREQUENCY].set),
+            "Scaling %s power needs its VOLTAGE, MIN_VOLTAGE and FREQUENCY coefficients\n",
+            Power_Domain_str(domain));
+  }
+}
+
+/**************************************************************************************/
+/* finish_power_model_results: DRAM chip count, other system power, V/f
+ * scaling and totals, common to both backends */
+
+void finish_power_model_results(void) {
 
   /* Adjusting DRAM power */
   /* CACTI reports numbers for a single DRAM chip:
@@ -190,6 +326,8 @@ void parse_power_model_results(void) {
 
   /* Check if we need scaling */
   for (uns domain = 0; domain < POWER_DOMAIN_NUM_ELEMS; ++domain) {
+    if (!values[domain][POWER_RESULT_DYNAMIC].set)
+      continue;
     if (POWER_INTF_ENABLE_SCALING && domain != POWER_DOMAIN_OTHER) {
       scale_values(domain);
     } else {
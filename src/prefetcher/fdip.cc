@@ -12,6 +12,7 @@ extern "C" {
 #include "memory/memory.param.h"
 #include "prefetcher/pref.param.h"
 
+#include "libs/cache_lib.h"
 #include "memory/memory.h"
 #include "prefetcher/eip.h"
 
@@ -25,7 +26,6 @@ extern "C" {
 #include <memory>
 #include <tuple>
 #include <unordered_map>
-#include <unordered_set>
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_FDIP, ##args)
 #define FDIP_PREF_STAT_COUNT 12
 
@@ -61,6 +61,58 @@ typedef enum UTILITY_PREF_POLICY_enum {
   PREF_POL_END,  // add a new policy above this line
 } Utility_Pref_Policy;
 
+/* Per-cache-line table used by FDIP_Stat. With FDIP_PRINT_CL_INFO every line is
+   kept exactly so print_cl_info() can dump it; otherwise lines live in a
+   set-associative LRU table of FDIP_STAT_TABLE_ENTRIES entries so memory does
+   not grow with the code footprint. Values must be trivially copyable. */
+template <typename V>
+class FDIP_Line_Table {
+ public:
+  FDIP_Line_Table() : proc_id(0), exact(TRUE) {}
+  void init(uns _proc_id, const char* name) {
+    proc_id = _proc_id;
+    exact = FDIP_PRINT_CL_INFO;
+    if (!exact)
+      init_cache(&table, name, FDIP_STAT_TABLE_ENTRIES * ICACHE_LINE_SIZE, FDIP_STAT_TABLE_ASSOC, ICACHE_LINE_SIZE,
+                 sizeof(V), REPL_TRUE_LRU);
+  }
+  V* find(Addr line_addr) {
+    if (exact) {
+      auto it = lines.find(line_addr);
+      return it == lines.end() ? nullptr : &it->second;
+    }
+    Addr tbl_line_addr;
+    return (V*)cache_access(&table, line_addr, &tbl_line_addr, TRUE);
+  }
+  // Returns the entry for line_addr, inserting init_value if it is not present.
+  V* insert(Addr line_addr, const V& init_value, Flag* new_entry = nullptr) {
+    V* value = find(line_addr);
+    if (new_entry)
+      *new_entry = value == nullptr;
+    if (value)
+      return value;
+    if (exact)
+      return &lines.emplace(line_addr, init_value).first->second;
+    Addr tbl_line_addr, repl_line_addr;
+    value = (V*)cache_insert(&table, proc_id, line_addr, &tbl_line_addr, &repl_line_addr);
+    if (repl_line_addr)
+      STAT_EVENT(proc_id, FDIP_STAT_TABLE_REPLACEMENT);
+    *value = init_value;
+    return value;
+  }
+  // Only valid in exact mode (FDIP_PRINT_CL_INFO).
+  const unordered_map<Addr, V>& get_lines() const {
+    ASSERT(proc_id, exact);
+    return lines;
+  }
+
+ private:
+  uns proc_id;
+  Flag exact;
+  unordered_map<Addr, V> lines;
+  Cache table;
+};
+
 class FDIP_Stat {
  public:
   FDIP_Stat(uns _proc_id, uns _bp_id)
@@ -71,7 +123,13 @@ class FDIP_Stat {
         last_recover_cycle(0),
         cur_line_delay(0),
         ftq_occupancy_ops(0),
-        ftq_occupancy_blocks(0) {}
+        ftq_occupancy_blocks(0) {
+    cnt_useful.init(proc_id, "FDIP_STAT_CNT_USEFUL");
+    cnt_unuseful.init(proc_id, "FDIP_STAT_CNT_UNUSEFUL");
+    cnt_useful_signed.init(proc_id, "FDIP_STAT_CNT_USEFUL_SIGNED");
+    prefetched_cls_info.init(proc_id, "FDIP_STAT_PREFETCHED_CLS_INFO");
+    line_state.init(proc_id, "FDIP_STAT_LINE_STATE");
+  }
   void inc_prefetched_cls(Addr line_addr, Flag on_path, uns success);
   void not_prefetch(Addr line_addr);
   void print_cl_info(Icache_Stage* ic_ref);
@@ -92,13 +150,16 @@ class FDIP_Stat {
   // for assertions
   uns last_break_reason;
   Counter last_recover_cycle;
+  /* The FDIP_Line_Table members below drive prefetch decisions and stats and are
+     bounded unless FDIP_PRINT_CL_INFO is set. The std containers are only read by
+     print_cl_info() and are populated only when FDIP_PRINT_CL_INFO is set. */
   // <CL address, # of first demand load on-path hits of cache lines, flag for learning from a true miss> - useful count
-  unordered_map<Addr, pair<Counter, Flag>> cnt_useful;
+  FDIP_Line_Table<pair<Counter, Flag>> cnt_useful;
   // <CL address, # of first demand load on-path hits of cache lines, flag for learning from a true miss> - useful count
   // after warm-up
   unordered_map<Addr, pair<Counter, Flag>> cnt_useful_aw;
   // <CL address, # of evictions w/o hit of cache lines> - unuseful count
-  unordered_map<Addr, Counter> cnt_unuseful;
+  FDIP_Line_Table<Counter> cnt_unuseful;
   // <CL address, # of evictions w/o hit of cache lines> - unuseful count after warm-up
   unordered_map<Addr, Counter> cnt_unuseful_aw;
   // Increment if useful by UDP_WEIGHT_USEFUL, decrement if unuseful by UDP_WEIGHT_UNUSEFUL
@@ -106,9 +167,7 @@ class FDIP_Stat {
   // OPTIMISTIC POLICY : do not prefetch if < USEFUL_THRESHOLD, otherwise, prefetch (do not prefetch only when it was
   // unuseful at least once) CONSERVATIVE POLICY : prefetch if > USEFUL_THRESHOLD, otherwise, do not prefetch (prefetch
   // only when it was useful at least once)
-  unordered_map<Addr, int32_t> cnt_useful_signed;
-  // <CL addresses, retirement count> - on-path retired cache line count
-  unordered_map<Addr, Counter> cnt_useful_ret;
+  FDIP_Line_Table<int32_t> cnt_useful_signed;
   // <CL addresses, icache miss count>
   map<Addr, Counter> icache_miss;
   // <CL addresses, icache miss count> after warm-up
@@ -130,12 +189,10 @@ class FDIP_Stat {
   map<Addr, Counter> new_prefetched_cls_aw;
   // <CL address, cyc_access_by_fdip, conf_on/off-path, cyc_evicted_from_l1_by_demand_load, cyc_evicted_from_l1_by_FDIP>
   // - prefetched and access time information for timeliness analysis
-  unordered_map<Addr, pair<pair<Counter, Flag>, pair<Counter, Counter>>> prefetched_cls_info;
+  FDIP_Line_Table<pair<pair<Counter, Flag>, pair<Counter, Counter>>> prefetched_cls_info;
   // Per-cache-line usefulness history emitted by print_cl_info(). The vectors
   // are populated only when FDIP_PRINT_CL_INFO is enabled.
   unordered_map<Addr, vector<uns8>> usefulness_history;
-  // Tracks first recorded I-cache access independently of optional history output.
-  unordered_set<Addr> accessed_cachelines;
   // Per-cache-line hit/miss history emitted by print_cl_info(). Allocate and
   // populate entries only when FDIP_PRINT_CL_INFO is enabled.
   unordered_map<Addr, vector<uns8>> icache_access_history;
@@ -150,7 +207,13 @@ class FDIP_Stat {
     CACHELINE_EVENT_USEFUL = 1u << 5,
     CACHELINE_EVENT_EVICTED = 1u << 6,
   };
-  unordered_map<Addr, uint8_t> cacheline_events;
+  struct Line_State {
+    uint8_t warmup_events;  // CachelineEvent mask recorded during warm-up
+    Flag accessed;          // first recorded I-cache access seen
+    Flag missed;            // counted in UNIQUE_MISSED_LINES
+    Flag hit;               // counted in UNIQUE_HIT_LINES
+  };
+  FDIP_Line_Table<Line_State> line_state;
 
   // Complete per-cache-line event history emitted by print_cl_info(), including
   // event order, duplicates, and cycle timestamps. Populate it only when
@@ -505,37 +568,36 @@ void FDIP_Stat::print_cl_info(Icache_Stage* ic_ref) {
   multimap<Counter, Addr> prefetched_cls_sorted = flip_map(prefetched_cls);
   for (multimap<Counter, Addr>::const_iterator it = prefetched_cls_sorted.begin(); it != prefetched_cls_sorted.end();
        ++it) {
-    auto cnt_useful_iter = cnt_useful.find(it->second);
-    if (cnt_useful_iter == cnt_useful.end()) {
+    if (!cnt_useful.find(it->second)) {
       DEBUG(proc_id, "Unuseful 0x%llx prefetched %llu times\n", it->second, it->first);
     }
   }
 
-  unordered_map<Addr, int32_t>* cnt_learned_cl = &cnt_useful_signed;
+  const unordered_map<Addr, int32_t>* cnt_learned_cl = &cnt_useful_signed.get_lines();
   FILE* fp = fopen("per_line_icache_line_info.csv", "w");
   fprintf(fp, "cl_addr,useful_cnt,unuseful_cnt,prefetch_cnt,new_prefetch_cnt,icache_hit,icache_miss\n");
   for (auto it = cnt_learned_cl->begin(); it != cnt_learned_cl->end(); ++it) {
-    auto cnt_useful_iter = cnt_useful.find(it->first);
-    auto cnt_unuseful_iter = cnt_unuseful.find(it->first);
+    pair<Counter, Flag>* useful = cnt_useful.find(it->first);
+    Counter* unuseful = cnt_unuseful.find(it->first);
     auto cnt_prefetch_iter = prefetched_cls.find(it->first);
     auto cnt_new_prefetch_iter = new_prefetched_cls.find(it->first);
     auto hit_iter = icache_hit.find(it->first);
     auto miss_iter = icache_miss.find(it->first);
-    Counter _cnt_useful = (cnt_useful_iter != cnt_useful.end()) ? cnt_useful_iter->second.first : 0;
-    Counter _cnt_unuseful = (cnt_unuseful_iter != cnt_unuseful.end()) ? cnt_unuseful_iter->second : 0;
+    Counter _cnt_useful = useful ? useful->first : 0;
+    Counter _cnt_unuseful = unuseful ? *unuseful : 0;
     Counter cnt_prefetch = (cnt_prefetch_iter != prefetched_cls.end()) ? cnt_prefetch_iter->second : 0;
     Counter cnt_new_prefetch = (cnt_new_prefetch_iter != new_prefetched_cls.end()) ? cnt_new_prefetch_iter->second : 0;
     Counter num_hit = (hit_iter != icache_hit.end()) ? hit_iter->second : 0;
     Counter num_miss = (miss_iter != icache_miss.end()) ? miss_iter->second : 0;
     fprintf(fp, "%llx,%llu,%llu,%llu,%llu,%llu,%llu\n", it->first, _cnt_useful, _cnt_unuseful, cnt_prefetch,
             cnt_new_prefetch, num_hit, num_miss);
-    ASSERT(proc_id, (cnt_useful_iter != cnt_useful.end()) || (cnt_unuseful_iter != cnt_unuseful.end()));
+    ASSERT(proc_id, useful || unuseful);
   }
   fclose(fp);
 
   fp = fopen("per_line_icache_line_info_after_warmup.csv", "w");
   fprintf(fp, "cl_addr,useful_cnt,unuseful_cnt,prefetch_cnt,new_prefetch_cnt,icache_hit,icache_miss\n");
-  for (auto it = cnt_useful_signed.begin(); it != cnt_useful_signed.end(); ++it) {
+  for (auto it = cnt_learned_cl->begin(); it != cnt_learned_cl->end(); ++it) {
     auto cnt_useful_iter = cnt_useful_aw.find(it->first);
     auto cnt_unuseful_iter = cnt_unuseful_aw.find(it->first);
     auto cnt_prefetch_iter = prefetched_cls_aw.find(it->first);
@@ -608,11 +670,10 @@ void FDIP_Stat::print_cl_info(Icache_Stage* ic_ref) {
 }
 
 void FDIP_Stat::inc_cnt_useful_signed(Addr line_addr) {
-  auto it = cnt_useful_signed.find(line_addr);
-  if (it == cnt_useful_signed.end())
-    cnt_useful_signed.insert(pair<Addr, int64_t>(line_addr, UDP_USEFUL_THRESHOLD + UDP_WEIGHT_USEFUL));
-  else if (it->second + UDP_WEIGHT_USEFUL <= UDP_WEIGHT_POSITIVE_SATURATION)
-    it->second += UDP_WEIGHT_USEFUL;
+  Flag new_entry;
+  int32_t* cnt = cnt_useful_signed.insert(line_addr, UDP_USEFUL_THRESHOLD + UDP_WEIGHT_USEFUL, &new_entry);
+  if (!new_entry && *cnt + UDP_WEIGHT_USEFUL <= UDP_WEIGHT_POSITIVE_SATURATION)
+    *cnt += UDP_WEIGHT_USEFUL;
 
   if (FDIP_PRINT_CL_INFO) {
     const uns8 useful_value = g_fdip->get_warmed_up() ? 3 : 1;
@@ -621,62 +682,54 @@ void FDIP_Stat::inc_cnt_useful_signed(Addr line_addr) {
 }
 
 void FDIP_Stat::inc_cnt_unuseful(Addr line_addr) {
-  auto unuseful_iter = cnt_unuseful.find(line_addr);
-  if (unuseful_iter == cnt_unuseful.end()) {
+  Flag new_entry;
+  Counter* cnt = cnt_unuseful.insert(line_addr, 1, &new_entry);
+  if (new_entry)
     STAT_EVENT(proc_id, ICACHE_UNUSEFUL_FETCHES);
-    cnt_unuseful.insert(make_pair(std::move(line_addr), 1));
-  } else {
-    unuseful_iter->second++;
-  }
+  else
+    (*cnt)++;
 
   if (g_fdip->get_warmed_up()) {
-    auto it = cnt_unuseful_aw.find(line_addr);
-    if (it == cnt_unuseful_aw.end())
-      cnt_unuseful_aw.insert(make_pair(std::move(line_addr), 1));
-    else
-      it->second++;
-
-    if (FDIP_PRINT_CL_INFO)
+    if (FDIP_PRINT_CL_INFO) {
+      cnt_unuseful_aw[line_addr]++;
       cacheline_event_history[line_addr].push_back(make_pair('u', cycle_count));
+    }
   } else {
-    cacheline_events[line_addr] |= CACHELINE_EVENT_UNUSEFUL;
+    line_state.insert(line_addr, Line_State())->warmup_events |= CACHELINE_EVENT_UNUSEFUL;
   }
 }
 
 void FDIP_Stat::inc_cnt_useful(Addr line_addr, Flag pref_miss) {
-  auto useful_iter = cnt_useful.find(line_addr);
-  DEBUG(proc_id, "cnt_useful size %ld\n", cnt_useful.size());
-  if (useful_iter == cnt_useful.end()) {
+  Flag new_entry;
+  pair<Counter, Flag>* useful = cnt_useful.insert(line_addr, make_pair(1, pref_miss), &new_entry);
+  if (new_entry) {
     DEBUG(proc_id, "%llx useful line new insert\n", line_addr);
     STAT_EVENT(proc_id, ICACHE_USEFUL_FETCHES);
-    cnt_useful.insert(make_pair(std::move(line_addr), make_pair(1, pref_miss)));
   } else {
-    useful_iter->second.first++;
-    useful_iter->second.second = pref_miss;
+    useful->first++;
+    useful->second = pref_miss;
   }
-  DEBUG(proc_id, "cnt_useful size after inserted %ld\n", cnt_useful.size());
 
   if (g_fdip->get_warmed_up()) {
-    auto it = cnt_useful_aw.find(line_addr);
-    if (it == cnt_useful_aw.end())
-      cnt_useful_aw.insert(make_pair(std::move(line_addr), make_pair(1, pref_miss)));
-    else {
-      it->second.first++;
-      it->second.second = pref_miss;
-    }
-
     if (FDIP_PRINT_CL_INFO) {
+      auto it = cnt_useful_aw.find(line_addr);
+      if (it == cnt_useful_aw.end())
+        cnt_useful_aw.insert(make_pair(std::move(line_addr), make_pair(1, pref_miss)));
+      else {
+        it->second.first++;
+        it->second.second = pref_miss;
+      }
       cacheline_event_history[line_addr].push_back(make_pair('U', cycle_count));
     }
   } else {
-    cacheline_events[line_addr] |= CACHELINE_EVENT_USEFUL;
+    line_state.insert(line_addr, Line_State())->warmup_events |= CACHELINE_EVENT_USEFUL;
   }
 }
 
 void FDIP_Stat::probe_prefetched_cls(Addr line_addr) {
-  auto cl_iter = prefetched_cls_info.find(line_addr);
-  if (cl_iter != prefetched_cls_info.end())
-    cl_iter->second.first.first = cycle_count;
+  auto cl_info = prefetched_cls_info.find(line_addr);
+  if (cl_info)
+    cl_info->first.first = cycle_count;
 }
 
 void FDIP_Stat::not_prefetch(Addr line_addr) {
@@ -686,50 +739,46 @@ void FDIP_Stat::not_prefetch(Addr line_addr) {
       cacheline_event_history[line_addr].push_back(make_pair('p', onoff_cycle_count));
     }
   } else {
-    cacheline_events[line_addr] |= CACHELINE_EVENT_NOT_PREFETCHED;
+    line_state.insert(line_addr, Line_State())->warmup_events |= CACHELINE_EVENT_NOT_PREFETCHED;
   }
 }
 
 void FDIP_Stat::inc_icache_miss(Addr line_addr) {
-  auto cl_iter = icache_miss.find(line_addr);
-  if (cl_iter == icache_miss.end()) {
+  Line_State* state = line_state.insert(line_addr, Line_State());
+  if (!state->missed) {
     STAT_EVENT(proc_id, UNIQUE_MISSED_LINES);
-    icache_miss.insert(pair<Addr, Counter>(line_addr, 1));
-  } else
-    cl_iter->second++;
+    state->missed = TRUE;
+  }
+  if (FDIP_PRINT_CL_INFO)
+    icache_miss[line_addr]++;
 
   if (g_fdip->get_warmed_up()) {
-    auto it = icache_miss_aw.find(line_addr);
-    if (it == icache_miss_aw.end())
-      icache_miss_aw.insert(pair<Addr, Counter>(line_addr, 1));
-    else
-      it->second++;
-
     if (FDIP_PRINT_CL_INFO) {
+      icache_miss_aw[line_addr]++;
       cacheline_event_history[line_addr].push_back(make_pair('m', cycle_count));
     }
 
     cur_line_delay = cycle_count;
   } else {
-    cacheline_events[line_addr] |= CACHELINE_EVENT_ICACHE_MISS;
+    state->warmup_events |= CACHELINE_EVENT_ICACHE_MISS;
   }
 
   uns icache_val = g_fdip->get_warmed_up() ? 2 : 0;
-  const bool first_access = accessed_cachelines.insert(line_addr).second;
+  const bool first_access = !state->accessed;
+  state->accessed = TRUE;
   if (FDIP_PRINT_CL_INFO)
     icache_access_history[line_addr].push_back(icache_val);
   if (first_access) {
     if (icache_val == 2) {
-      auto it2 = cacheline_events.find(line_addr);
-      if (it2 != cacheline_events.end()) {
+      if (state->warmup_events) {
         STAT_EVENT(proc_id, ICACHE_FIRST_MISS_AFTER_WARMUP_SEEN_DURING_WARMUP);
-        const uint8_t state = it2->second;
-        const bool no_pref = state & CACHELINE_EVENT_NOT_PREFETCHED;
+        const uint8_t events = state->warmup_events;
+        const bool no_pref = events & CACHELINE_EVENT_NOT_PREFETCHED;
         // Preserve the legacy interpretation: the events produced by
         // inc_cnt_unuseful() and inc_cnt_useful() drive the opposite-named
         // first-miss predicates. Changing it would alter existing FDIP statistics.
-        const bool useful = state & CACHELINE_EVENT_UNUSEFUL;
-        const bool unuseful = state & CACHELINE_EVENT_USEFUL;
+        const bool useful = events & CACHELINE_EVENT_UNUSEFUL;
+        const bool unuseful = events & CACHELINE_EVENT_USEFUL;
         if (no_pref && !unuseful && !useful)
           STAT_EVENT(proc_id, ICACHE_FIRST_MISS_AFTER_WARMUP_NO_PREF_DURING_WARMUP);
         if (!no_pref && unuseful && !useful)
@@ -743,60 +792,44 @@ void FDIP_Stat::inc_icache_miss(Addr line_addr) {
 }
 
 void FDIP_Stat::inc_prefetched_cls(Addr line_addr, Flag on_path, uns success) {
-  auto cl_iter = prefetched_cls.find(line_addr);
-  if (cl_iter == prefetched_cls.end()) {
-    prefetched_cls.insert(pair<Addr, Counter>(line_addr, 1));
-    prefetched_cls_info.insert(
-        make_pair(std::move(line_addr), make_pair(make_pair(std::move(cycle_count), on_path), make_pair(0, 0))));
+  Flag new_entry;
+  auto cl_info = prefetched_cls_info.insert(line_addr, make_pair(make_pair(cycle_count, on_path), make_pair(0, 0)),
+                                            &new_entry);
+  if (new_entry) {
     DEBUG(proc_id, "%llx inserted into prefetched_cls at %llu\n", line_addr, cycle_count);
   } else {
-    cl_iter->second++;
-    auto cl_info_iter = prefetched_cls_info.find(line_addr);
-    ASSERT(proc_id, cl_info_iter != prefetched_cls_info.end());
-    cl_info_iter->second.first.first = cycle_count;
-    cl_info_iter->second.first.second = on_path;
-    DEBUG(proc_id, "%llx updated with cnt %llu in prefetched_cls at cyc %llu\n", line_addr, cl_iter->second,
-          cycle_count);
+    cl_info->first.first = cycle_count;
+    cl_info->first.second = on_path;
+    DEBUG(proc_id, "%llx updated in prefetched_cls at cyc %llu\n", line_addr, cycle_count);
   }
 
-  if (success == Mem_Queue_Req_Result::SUCCESS_NEW) {
-    auto cl_new_iter = new_prefetched_cls.find(line_addr);
-    if (cl_new_iter == new_prefetched_cls.end())
-      new_prefetched_cls.insert(pair<Addr, Counter>(line_addr, 1));
-    else
-      cl_new_iter->second++;
+  if (!FDIP_PRINT_CL_INFO) {
+    if (!g_fdip->get_warmed_up())
+      line_state.insert(line_addr, Line_State())->warmup_events |= CACHELINE_EVENT_PREFETCHED;
+    return;
   }
 
+  prefetched_cls[line_addr]++;
+  if (success == Mem_Queue_Req_Result::SUCCESS_NEW)
+    new_prefetched_cls[line_addr]++;
+
   if (g_fdip->get_warmed_up()) {
-    auto it = prefetched_cls_aw.find(line_addr);
-    if (it == prefetched_cls_aw.end())
-      prefetched_cls_aw.insert(pair<Addr, Counter>(line_addr, 1));
-    else
-      it->second++;
-
-    if (success == Mem_Queue_Req_Result::SUCCESS_NEW) {
-      it = new_prefetched_cls_aw.find(line_addr);
-      if (it == new_prefetched_cls_aw.end())
-        new_prefetched_cls_aw.insert(pair<Addr, Counter>(line_addr, 1));
-      else
-        it->second++;
-    }
+    prefetched_cls_aw[line_addr]++;
+    if (success == Mem_Queue_Req_Result::SUCCESS_NEW)
+      new_prefetched_cls_aw[line_addr]++;
 
-    if (FDIP_PRINT_CL_INFO) {
-      const Counter onoff_cycle_count = fdip_off_path(proc_id, bp_id) ? -cycle_count : cycle_count;
-      cacheline_event_history[line_addr].push_back(make_pair('P', onoff_cycle_count));
-    }
+    const Counter onoff_cycle_count = fdip_off_path(proc_id, bp_id) ? -cycle_count : cycle_count;
+    cacheline_event_history[line_addr].push_back(make_pair('P', onoff_cycle_count));
   } else {
-    cacheline_events[line_addr] |= CACHELINE_EVENT_PREFETCHED;
+    line_state.insert(line_addr, Line_State())->warmup_events |= CACHELINE_EVENT_PREFETCHED;
   }
 }
 
 void FDIP_Stat::dec_cnt_useful_signed(Addr line_addr) {
-  auto it = cnt_useful_signed.find(line_addr);
-  if (it == cnt_useful_signed.end())
-    cnt_useful_signed.insert(pair<Addr, int64_t>(line_addr, UDP_USEFUL_THRESHOLD - UDP_WEIGHT_UNUSEFUL));
-  else
-    it->second -= UDP_WEIGHT_UNUSEFUL;
+  Flag new_entry;
+  int32_t* cnt = cnt_useful_signed.insert(line_addr, UDP_USEFUL_THRESHOLD - UDP_WEIGHT_UNUSEFUL, &new_entry);
+  if (!new_entry)
+    *cnt -= UDP_WEIGHT_UNUSEFUL;
 
   if (FDIP_PRINT_CL_INFO) {
     const uns8 unuseful_value = g_fdip->get_warmed_up() ? 2 : 0;
@@ -805,38 +838,28 @@ void FDIP_Stat::dec_cnt_useful_signed(Addr line_addr) {
 }
 
 void FDIP_Stat::inc_icache_hit(Addr line_addr) {
-  auto cl_iter = icache_hit.find(line_addr);
-  if (cl_iter == icache_hit.end()) {
+  Line_State* state = line_state.insert(line_addr, Line_State());
+  if (!state->hit) {
     STAT_EVENT(proc_id, UNIQUE_HIT_LINES);
-    icache_hit.insert(pair<Addr, Counter>(line_addr, 1));
-  } else
-    cl_iter->second++;
+    state->hit = TRUE;
+  }
+  if (FDIP_PRINT_CL_INFO)
+    icache_hit[line_addr]++;
 
   if (g_fdip->get_warmed_up()) {
-    auto it = icache_hit_aw.find(line_addr);
-    if (it == icache_hit_aw.end())
-      icache_hit_aw.insert(pair<Addr, Counter>(line_addr, 1));
-    else
-      it->second++;
-
-    if (FDIP_PRINT_CL_INFO)
+    if (FDIP_PRINT_CL_INFO) {
+      icache_hit_aw[line_addr]++;
       cacheline_event_history[line_addr].push_back(make_pair('h', cycle_count));
-
-    if (cur_line_delay) {
-      auto it3 = per_line_delay_aw.find(line_addr);
-      if (it3 == per_line_delay_aw.end()) {
-        per_line_delay_aw.insert(make_pair(line_addr, cycle_count - cur_line_delay));
-      } else {
-        it3->second += cycle_count - cur_line_delay;
-      }
+      if (cur_line_delay)
+        per_line_delay_aw[line_addr] += cycle_count - cur_line_delay;
     }
     cur_line_delay = 0;
   } else {
-    cacheline_events[line_addr] |= CACHELINE_EVENT_ICACHE_HIT;
+    state->warmup_events |= CACHELINE_EVENT_ICACHE_HIT;
   }
 
   uns icache_val = g_fdip->get_warmed_up() ? 3 : 1;
-  accessed_cachelines.insert(line_addr);
+  state->accessed = TRUE;
   if (FDIP_PRINT_CL_INFO)
     icache_access_history[line_addr].push_back(icache_val);
 }
@@ -1106,6 +1129,8 @@ void FDIP::inc_prefetched_cls(Addr line_addr, uns success, Flag conf_off_path) {
 }
 
 void FDIP::inc_off_fetched_cls(Addr line_addr) {
+  if (!FDIP_PRINT_CL_INFO)
+    return;
   auto cl_iter = fdip_stat->off_fetched_cls.find(line_addr);
   if (cl_iter == fdip_stat->off_fetched_cls.end()) {
     fdip_stat->off_fetched_cls.insert(pair<Addr, Counter>(line_addr, cycle_count));
@@ -1118,42 +1143,43 @@ void FDIP::inc_off_fetched_cls(Addr line_addr) {
 
 void FDIP::evict_prefetched_cls(Addr line_addr, Flag by_fdip) {
   DEBUG(proc_id, "%llx evicted by %s\n", line_addr, by_fdip ? "FDIP" : "IFETCH");
-  auto cl_iter = fdip_stat->prefetched_cls_info.find(line_addr);
-  if (cl_iter != fdip_stat->prefetched_cls_info.end()) {
+  auto cl_info = fdip_stat->prefetched_cls_info.find(line_addr);
+  if (cl_info) {
     if (by_fdip) {
-      cl_iter->second.second.first = 0;
-      cl_iter->second.second.second = cycle_count;
+      cl_info->second.first = 0;
+      cl_info->second.second = cycle_count;
     } else {
-      cl_iter->second.second.first = cycle_count;
-      cl_iter->second.second.second = 0;
+      cl_info->second.first = cycle_count;
+      cl_info->second.second = 0;
     }
   }
 }
 
 uns FDIP::get_miss_reason(Addr line_addr) {
-  auto cl_iter = fdip_stat->prefetched_cls_info.find(line_addr);
-  if (cl_iter == fdip_stat->prefetched_cls_info.end()) {
-    auto tmp_iter = fdip_stat->prefetched_cls.find(line_addr);
+  auto cl_info = fdip_stat->prefetched_cls_info.find(line_addr);
+  if (!cl_info) {
+    // Without FDIP_PRINT_CL_INFO the line may also have aged out of the bounded table.
     DEBUG(proc_id, "%llx misses due to 'not prefetched ever'\n", line_addr);
-    ASSERT(proc_id, tmp_iter == fdip_stat->prefetched_cls.end());
+    ASSERT(proc_id,
+           !FDIP_PRINT_CL_INFO || fdip_stat->prefetched_cls.find(line_addr) == fdip_stat->prefetched_cls.end());
     return Imiss_Reason::IMISS_NOT_PREFETCHED;
   }
-  if (cl_iter->second.first.first < fdip_stat->last_recover_cycle) {
+  if (cl_info->first.first < fdip_stat->last_recover_cycle) {
     DEBUG(proc_id, "%llx misses due to 'not prefetched after last recover cycle'\n", line_addr);
     return Imiss_Reason::IMISS_NOT_PREFETCHED;
   }
 
-  if (cl_iter->second.first.first >= fdip_stat->last_recover_cycle) {
-    if (cl_iter->second.second.first > cl_iter->second.first.first) {
+  if (cl_info->first.first >= fdip_stat->last_recover_cycle) {
+    if (cl_info->second.first > cl_info->first.first) {
       DEBUG(proc_id, "%llx misses due to 'prefetched but evicted by a demand load'\n", line_addr);
       return Imiss_Reason::IMISS_TOO_EARLY_EVICTED_BY_IFETCH;
-    } else if (cl_iter->second.second.second > cl_iter->second.first.first) {
+    } else if (cl_info->second.second > cl_info->first.first) {
       DEBUG(proc_id, "%llx misses due to 'prefetched but evicted by FDIP'\n", line_addr);
       return Imiss_Reason::IMISS_TOO_EARLY_EVICTED_BY_FDIP;
     }
   }
 
-  if (cl_iter->second.first.second) {
+  if (cl_info->first.second) {
     DEBUG(proc_id, "%llx misses due to 'MSHR hit prefetched on path'\n", line_addr);
     return Imiss_Reason::IMISS_MSHR_HIT_PREFETCHED_ONPATH;
   }
@@ -1187,9 +1213,7 @@ void FDIP::determine_usefulness_by_inf_hash(Addr line_addr, Flag* emit_new_prefe
   } else {
     switch (FDIP_UTILITY_PREF_POLICY) {
       case Utility_Pref_Policy::PREF_CONV_FROM_USEFUL_SET: {
-        unordered_map<Addr, pair<Counter, Flag>>* cnt_useful = &(fdip_stat->cnt_useful);
-        auto iter = cnt_useful->find(hashed_line_addr);
-        if (iter == cnt_useful->end()) {
+        if (!fdip_stat->cnt_useful.find(hashed_line_addr)) {
           *emit_new_prefetch = FALSE;
         } else {
           *emit_new_prefetch = TRUE;
@@ -1197,9 +1221,7 @@ void FDIP::determine_usefulness_by_inf_hash(Addr line_addr, Flag* emit_new_prefe
         break;
       }
       case Utility_Pref_Policy::PREF_OPT_FROM_UNUSEFUL_SET: {
-        unordered_map<Addr, Counter>* cnt_unuseful = &(fdip_stat->cnt_unuseful);
-        auto iter = cnt_unuseful->find(hashed_line_addr);
-        if (iter == cnt_unuseful->end())
+        if (!fdip_stat->cnt_unuseful.find(hashed_line_addr))
           *emit_new_prefetch = TRUE;
         else {
           *emit_new_prefetch = FALSE;
@@ -1207,9 +1229,8 @@ void FDIP::determine_usefulness_by_inf_hash(Addr line_addr, Flag* emit_new_prefe
         break;
       }
       case Utility_Pref_Policy::PREF_CONV_FROM_THROTTLE_CNT: {
-        unordered_map<Addr, int32_t>* cnt = &(fdip_stat->cnt_useful_signed);
-        auto iter = cnt->find(hashed_line_addr);
-        if (iter != cnt->end() && iter->second > UDP_USEFUL_THRESHOLD)
+        int32_t* cnt = fdip_stat->cnt_useful_signed.find(hashed_line_addr);
+        if (cnt && *cnt > UDP_USEFUL_THRESHOLD)
           *emit_new_prefetch = TRUE;
         else {
           *emit_new_prefetch = FALSE;
@@ -1217,9 +1238,8 @@ void FDIP::determine_usefulness_by_inf_hash(Addr line_addr, Flag* emit_new_prefe
         break;
       }
       case Utility_Pref_Policy::PREF_OPT_FROM_THROTTLE_CNT: {
-        unordered_map<Addr, int32_t>* cnt = &(fdip_stat->cnt_useful_signed);
-        auto iter = cnt->find(hashed_line_addr);
-        if (iter != cnt->end() && iter->second < UDP_USEFUL_THRESHOLD) {
+        int32_t* cnt = fdip_stat->cnt_useful_signed.find(hashed_line_addr);
+        if (cnt && *cnt < UDP_USEFUL_THRESHOLD) {
           *emit_new_prefetch = FALSE;
         } else
           *emit_new_prefetch = TRUE;
@@ -1468,8 +1488,8 @@ void FDIP::dec_useful_lines_uc(Addr line_addr) {
 }
 
 void FDIP::assert_break_reason(Addr line_addr) {
-  auto useful_iter = fdip_stat->cnt_useful.find(line_addr);
-  if (useful_iter != fdip_stat->cnt_useful.end() && !useful_iter->second.second) {  // learned from a seniority-FTQ hit
+  pair<Counter, Flag>* useful = fdip_stat->cnt_useful.find(line_addr);
+  if (useful && !useful->second) {  // learned from a seniority-FTQ hit
     ASSERT(proc_id, fdip_stat->last_break_reason == BR_FULL_MEM_REQ_BUF);
   }
 }
@@ -1479,7 +1499,8 @@ void FDIP::add_evict_seq(Addr line_addr) {
     if (FDIP_PRINT_CL_INFO)
       fdip_stat->cacheline_event_history[line_addr].push_back(make_pair('e', cycle_count));
   } else {
-    fdip_stat->cacheline_events[line_addr] |= FDIP_Stat::CACHELINE_EVENT_EVICTED;
+    fdip_stat->line_state.insert(line_addr, FDIP_Stat::Line_State())->warmup_events |=
+        FDIP_Stat::CACHELINE_EVENT_EVICTED;
   }
 }
 
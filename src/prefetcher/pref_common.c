@@ -132,6 +132,9 @@ void pref_core_init(HWP_Core* pref_core) {
   pref_core->dl0req_queue = (Pref_Mem_Req*)calloc(PREF_DL0REQ_QUEUE_SIZE, sizeof(Pref_Mem_Req));
   pref_core->umlc_req_queue = (Pref_Mem_Req*)calloc(PREF_UMLC_REQ_QUEUE_SIZE, sizeof(Pref_Mem_Req));
   pref_core->ul1req_queue = (Pref_Mem_Req*)calloc(PREF_UL1REQ_QUEUE_SIZE, sizeof(Pref_Mem_Req));
+  init_hash_table(&pref_core->dl0req_queue_index, "dl0req_queue_index", PREF_DL0REQ_QUEUE_SIZE, sizeof(uns));
+  init_hash_table(&pref_core->umlc_req_queue_index, "umlc_req_queue_index", PREF_UMLC_REQ_QUEUE_SIZE, sizeof(uns));
+  init_hash_table(&pref_core->ul1req_queue_index, "ul1req_queue_index", PREF_UL1REQ_QUEUE_SIZE, sizeof(uns));
 
   pref_core->dl0req_queue_req_pos = -1;
   pref_core->dl0req_queue_send_pos = 0;
@@ -507,11 +510,30 @@ void pref_umlc_cache_fill(uns8 proc_id, Addr fill_addr, Flag prefetch, Addr evic
   }
 }
 
+/* Keeps a queue's line_index counts in step with slot being overwritten by a request for line_index */
+static void pref_queue_index_write(Hash_Table* index, const Pref_Mem_Req* slot, Addr line_index) {
+  Flag new_entry;
+  if (slot->line_index) {
+    uns* count = (uns*)hash_table_access(index, slot->line_index);
+    ASSERT(slot->proc_id, count && *count > 0);
+    if (--*count == 0)
+      hash_table_access_delete(index, slot->line_index);
+  }
+  uns* count = (uns*)hash_table_access_create(index, line_index, &new_entry);
+  *count = new_entry ? 1 : *count + 1;
+}
+
+static inline Flag pref_queue_index_contains(const Hash_Table* index, Addr line_index) {
+  return hash_table_access(index, line_index) != NULL;
+}
+
 Flag pref_dl0req_queue_filter(Addr line_addr) {
   if (!PREF_DL0REQ_QUEUE_FILTER_ON)
     return FALSE;
   uns proc_id = get_proc_id_from_cmp_addr(line_addr);
   Pref_Mem_Req* dl0req_queue = pref.cores[proc_id]->dl0req_queue;
+  if (!pref_queue_index_contains(&pref.cores[proc_id]->dl0req_queue_index, line_addr >> LOG2(DCACHE_LINE_SIZE)))
+    return FALSE;
   for (uns ii = 0; ii < PREF_DL0REQ_QUEUE_SIZE; ii++) {
     if (dl0req_queue[ii].valid &&
         (dl0req_queue[ii].line_addr >> LOG2(DCACHE_LINE_SIZE)) == (line_addr >> LOG2(DCACHE_LINE_SIZE))) {
@@ -528,6 +550,8 @@ Flag pref_umlc_req_queue_filter(Addr line_addr) {
     return FALSE;
   uns proc_id = get_proc_id_from_cmp_addr(line_addr);
   Pref_Mem_Req* umlc_req_queue = pref.cores[proc_id]->umlc_req_queue;
+  if (!pref_queue_index_contains(&pref.cores[proc_id]->umlc_req_queue_index, line_addr >> LOG2(DCACHE_LINE_SIZE)))
+    return FALSE;
   for (uns ii = 0; ii < PREF_UMLC_REQ_QUEUE_SIZE; ii++) {
     if (umlc_req_queue[ii].valid &&
         (umlc_req_queue[ii].line_addr >> LOG2(DCACHE_LINE_SIZE)) == (line_addr >> LOG2(DCACHE_LINE_SIZE))) {
@@ -544,6 +568,8 @@ Flag pref_ul1req_queue_filter(Addr line_addr) {
     return FALSE;
   uns proc_id = get_proc_id_from_cmp_addr(line_addr);
   Pref_Mem_Req* ul1req_queue = pref.cores[proc_id]->ul1req_queue;
+  if (!pref_queue_index_contains(&pref.cores[proc_id]->ul1req_queue_index, line_addr >> LOG2(DCACHE_LINE_SIZE)))
+    return FALSE;
   for (uns ii = 0; ii < PREF_UL1REQ_QUEUE_SIZE; ii++) {
     if (ul1req_queue[ii].valid &&
         (ul1req_queue[ii].line_addr >> LOG2(DCACHE_LINE_SIZE)) == (line_addr >> LOG2(DCACHE_LINE_SIZE))) {
@@ -558,6 +584,8 @@ Flag pref_ul1req_queue_filter(Addr line_addr) {
 Flag pref_ul1req_queue_match(Addr line_addr) {
   uns proc_id = get_proc_id_from_cmp_addr(line_addr);
   Pref_Mem_Req* ul1req_queue = pref.cores[proc_id]->ul1req_queue;
+  if (!pref_queue_index_contains(&pref.cores[proc_id]->ul1req_queue_index, line_addr >> LOG2(DCACHE_LINE_SIZE)))
+    return FALSE;
   for (uns ii = 0; ii < PREF_UL1REQ_QUEUE_SIZE; ii++) {
     if (ul1req_queue[ii].valid &&
         (ul1req_queue[ii].line_addr >> LOG2(DCACHE_LINE_SIZE)) == (line_addr >> LOG2(DCACHE_LINE_SIZE))) {
@@ -568,18 +596,15 @@ Flag pref_ul1req_queue_match(Addr line_addr) {
 }
 
 Flag pref_addto_dl0req_queue(uns8 proc_id, Addr line_index, uns8 prefetcher_id) {
-  int ii;
   Pref_Mem_Req new_req = {0};
   if (!line_index)  // addr = 0
     return TRUE;
   Pref_Mem_Req* dl0req_queue = pref.cores[proc_id]->dl0req_queue;
   int* dl0req_queue_req_pos = &pref.cores[proc_id]->dl0req_queue_req_pos;
   if (PREF_DL0REQ_ADD_FILTER_ON) {
-    for (ii = 0; ii < PREF_DL0REQ_QUEUE_SIZE; ii++) {
-      if (dl0req_queue[ii].line_index == line_index) {
-        STAT_EVENT(0, PREF_DL0REQ_QUEUE_MATCHED_REQ);
-        return TRUE;  // Hit another request
-      }
+    if (pref_queue_index_contains(&pref.cores[proc_id]->dl0req_queue_index, line_index)) {
+      STAT_EVENT(0, PREF_DL0REQ_QUEUE_MATCHED_REQ);
+      return TRUE;  // Hit another request
     }
   }
   if (dl0req_queue[(*dl0req_queue_req_pos + 1) % PREF_DL0REQ_QUEUE_SIZE].valid) {
@@ -597,23 +622,21 @@ Flag pref_addto_dl0req_queue(uns8 proc_id, Addr line_index, uns8 prefetcher_id)
 
   *dl0req_queue_req_pos = (*dl0req_queue_req_pos + 1) % PREF_DL0REQ_QUEUE_SIZE;
 
+  pref_queue_index_write(&pref.cores[proc_id]->dl0req_queue_index, &dl0req_queue[*dl0req_queue_req_pos], line_index);
   dl0req_queue[*dl0req_queue_req_pos] = new_req;
   return TRUE;
 }
 
 Flag pref_addto_umlc_req_queue(uns8 proc_id, Addr line_index, uns8 prefetcher_id) {
-  int ii;
   Pref_Mem_Req new_req = {0};
   if (!line_index)  // addr = 0
     return TRUE;
   Pref_Mem_Req* umlc_req_queue = pref.cores[proc_id]->umlc_req_queue;
   int* umlc_req_queue_req_pos = &pref.cores[proc_id]->umlc_req_queue_req_pos;
   if (PREF_UMLC_REQ_ADD_FILTER_ON) {
-    for (ii = 0; ii < PREF_UMLC_REQ_QUEUE_SIZE; ii++) {
-      if (umlc_req_queue[ii].line_index == line_index) {
-        STAT_EVENT(0, PREF_UMLC_REQ_QUEUE_MATCHED_REQ);
-        return TRUE;  // Hit another request
-      }
+    if (pref_queue_index_contains(&pref.cores[proc_id]->umlc_req_queue_index, line_index)) {
+      STAT_EVENT(0, PREF_UMLC_REQ_QUEUE_MATCHED_REQ);
+      return TRUE;  // Hit another request
     }
   }
   if (umlc_req_queue[(*umlc_req_queue_req_pos + 1) % PREF_UMLC_REQ_QUEUE_SIZE].valid) {
@@ -633,6 +656,8 @@ Flag pref_addto_umlc_req_queue(uns8 proc_id, Addr line_index, uns8 prefetcher_id
 
   *umlc_req_queue_req_pos = (*umlc_req_queue_req_pos + 1) % PREF_UMLC_REQ_QUEUE_SIZE;
 
+  pref_queue_index_write(&pref.cores[proc_id]->umlc_req_queue_index, &umlc_req_queue[*umlc_req_queue_req_pos],
+                         line_index);
   umlc_req_queue[*umlc_req_queue_req_pos] = new_req;
   return TRUE;
 }
@@ -643,7 +668,6 @@ Flag pref_addto_ul1req_queue(uns8 proc_id, Addr line_index, uns8 prefetcher_id)
 
 Flag pref_addto_ul1req_queue_set(uns8 proc_id, Addr line_index, uns8 prefetcher_id, uns distance, Addr loadPC,
                                  uns32 global_hist, Flag bw) {
-  int ii;
   Pref_Mem_Req new_req;
   Addr line_addr;
   if (!line_index)  // addr = 0
@@ -657,11 +681,9 @@ Flag pref_addto_ul1req_queue_set(uns8 proc_id, Addr line_index, uns8 prefetcher_
   pref_feed_back_info_update(prefetcher_id);
 
   if (PREF_UL1REQ_ADD_FILTER_ON) {
-    for (ii = 0; ii < PREF_UL1REQ_QUEUE_SIZE; ii++) {
-      if (ul1req_queue[ii].line_index == line_index) {
-        STAT_EVENT(0, PREF_UL1REQ_QUEUE_MATCHED_REQ);
-        return TRUE;  // Hit another request
-      }
+    if (pref_queue_index_contains(&pref.cores[proc_id]->ul1req_queue_index, line_index)) {
+      STAT_EVENT(0, PREF_UL1REQ_QUEUE_MATCHED_REQ);
+      return TRUE;  // Hit another request
     }
   }
   if (ul1req_queue[(*ul1req_queue_req_pos + 1) % PREF_UL1REQ_QUEUE_SIZE].valid) {
@@ -683,6 +705,7 @@ Flag pref_addto_ul1req_queue_set(uns8 proc_id, Addr line_index, uns8 prefetcher_
 
   *ul1req_queue_req_pos = (*ul1req_queue_req_pos + 1) % PREF_UL1REQ_QUEUE_SIZE;
 
+  pref_queue_index_write(&pref.cores[proc_id]->ul1req_queue_index, &ul1req_queue[*ul1req_queue_req_pos], line_index);
   ul1req_queue[*ul1req_queue_req_pos] = new_req;
   return TRUE;
 }
@@ -29,6 +29,7 @@
 #ifndef __PREF_COMMON_H__
 #define __PREF_COMMON_H__
 
+#include "libs/hash_lib.h"
 #include "memory/mem_req.h"
 
 #define PREF_TRACKERS_NUM 16
@@ -150,6 +151,11 @@ typedef struct HWP_Core_struct {
   Pref_Mem_Req* umlc_req_queue;  // MLC req queue
   Pref_Mem_Req* ul1req_queue;    // L2 req queue
 
+  // line_index -> number of slots holding it (valid or not), so duplicate checks skip the queue scan
+  Hash_Table dl0req_queue_index;
+  Hash_Table umlc_req_queue_index;
+  Hash_Table ul1req_queue_index;
+
   int dl0req_queue_req_pos;
   int dl0req_queue_send_pos;
 
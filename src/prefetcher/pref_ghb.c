@@ -72,6 +72,16 @@
 /**************************************************************************************/
 /* Macros */
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_PREF_GHB, ##args)
+#define GHB_INDEX_WORDS ((PREF_GHB_INDEX_N + 63) / 64)
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static void ghb_index_set_valid(Pref_GHB* ghb_hwp, int idx, Addr czone_tag);
+static void ghb_index_invalidate(Pref_GHB* ghb_hwp, int idx);
+static void ghb_index_set_last_access(Pref_GHB* ghb_hwp, int idx, uns last_access);
+static int ghb_index_victim(const Pref_GHB* ghb_hwp);
+
 ghb_prefetchers ghb_prefetchers_array;
 void pref_ghb_init(HWP* hwp) {
   if (!pref_hwp_enabled(hwp))
@@ -119,9 +129,13 @@ void init_ghb_core(HWP* hwp, Pref_GHB* ghb_hwp_core) {
     ghb_hwp_core[proc_id].delta_buffer = (int*)calloc(ghb_hwp_core[proc_id].deltab_size, sizeof(int));
     ghb_hwp_core[proc_id].pref_degree = PREF_GHB_DEGREE;
 
+    init_hash_table(&ghb_hwp_core[proc_id].czone_map, "ghb_czone_map", PREF_GHB_INDEX_N * 2, sizeof(int));
+    ghb_hwp_core[proc_id].invalid_entries = (uns64*)calloc(GHB_INDEX_WORDS, sizeof(uns64));
+    ghb_hwp_core[proc_id].max_last_access_idx = 0;
     for (ii = 0; ii < PREF_GHB_INDEX_N; ii++) {
       ghb_hwp_core[proc_id].index_table[ii].valid = FALSE;
       ghb_hwp_core[proc_id].index_table[ii].last_access = 0;
+      ghb_hwp_core[proc_id].invalid_entries[ii / 64] |= 1ULL << (ii % 64);
     }
     for (ii = 0; ii < PREF_GHB_BUFFER_N; ii++) {
       ghb_hwp_core[proc_id].ghb_buffer[ii].ghb_ptr = -1;
@@ -180,13 +194,12 @@ void pref_ghb_train(Pref_GHB* ghb_hwp, uns8 proc_id, Addr lineAddr, Addr loadPC,
   Addr currLineIndex = lineIndex;
   Addr index_tag = CZONE_TAG(lineAddr);
 
-  for (ii = 0; ii < PREF_GHB_INDEX_N; ii++) {
-    if (index_tag == ghb_hwp->index_table[ii].czone_tag && ghb_hwp->index_table[ii].valid) {
-      // got a hit in the index table
-      czone_idx = ii;
-      old_ptr = ghb_hwp->index_table[ii].ghb_ptr;
-      break;
-    }
+  int* czone_entry = (int*)hash_table_access(&ghb_hwp->czone_map, index_tag);
+  if (czone_entry) {
+    // got a hit in the index table
+    czone_idx = *czone_entry;
+    ASSERT(proc_id, ghb_hwp->index_table[czone_idx].valid && ghb_hwp->index_table[czone_idx].czone_tag == index_tag);
+    old_ptr = ghb_hwp->index_table[czone_idx].ghb_ptr;
   }
   if (czone_idx == -1) {
     if (is_hit) {  // ONLY TRAIN on hit
@@ -195,16 +208,7 @@ void pref_ghb_train(Pref_GHB* ghb_hwp, uns8 proc_id, Addr lineAddr, Addr loadPC,
 
     // Not present in index table.
     // Make new czone
-    // First look if any entry is unused
-    for (ii = 0; ii < PREF_GHB_INDEX_N; ii++) {
-      if (!ghb_hwp->index_table[ii].valid) {
-        czone_idx = ii;
-        break;
-      }
-      if (czone_idx == -1 || (ghb_hwp->index_table[czone_idx].last_access < ghb_hwp->index_table[ii].last_access)) {
-        czone_idx = ii;
-      }
-    }
+    czone_idx = ghb_index_victim(ghb_hwp);
   }
   if (old_ptr != -1 && ghb_hwp->ghb_buffer[old_ptr].miss_index == lineIndex) {
     return;
@@ -282,9 +286,8 @@ void pref_ghb_create_newentry(Pref_GHB* ghb_hwp, int idx, Addr line_addr, Addr c
   int rev_ptr;
   int rev_idx_ptr;
 
-  ghb_hwp->index_table[idx].valid = TRUE;
-  ghb_hwp->index_table[idx].czone_tag = czone_tag;
-  ghb_hwp->index_table[idx].last_access = cycle_count;
+  ghb_index_set_valid(ghb_hwp, idx, czone_tag);
+  ghb_index_set_last_access(ghb_hwp, idx, cycle_count);
 
   // Now make entry in ghb
   ghb_hwp->ghb_tail = (ghb_hwp->ghb_tail + 1) % PREF_GHB_BUFFER_N;
@@ -306,7 +309,7 @@ void pref_ghb_create_newentry(Pref_GHB* ghb_hwp, int idx, Addr line_addr, Addr c
 
   if (rev_idx_ptr != -1 && ghb_hwp->index_table[rev_idx_ptr].ghb_ptr == ghb_hwp->ghb_tail && rev_idx_ptr != idx) {
     ghb_hwp->index_table[rev_idx_ptr].ghb_ptr = -1;
-    ghb_hwp->index_table[rev_idx_ptr].valid = FALSE;
+    ghb_index_invalidate(ghb_hwp, rev_idx_ptr);
   }
 
   ghb_hwp->ghb_buffer[ghb_hwp->ghb_tail].miss_index = line_addr >> LOG2(DCACHE_LINE_SIZE);
@@ -319,6 +322,54 @@ void pref_ghb_create_newentry(Pref_GHB* ghb_hwp, int idx, Addr line_addr, Addr c
   ghb_hwp->index_table[idx].ghb_ptr = ghb_hwp->ghb_tail;
 }
 
+/* The index table is fully associative. czone_map, invalid_entries and max_last_access_idx replace the scans over
+ * it and are kept in step with every change of valid, czone_tag and last_access below. */
+static void ghb_index_set_valid(Pref_GHB* ghb_hwp, int idx, Addr czone_tag) {
+  GHB_Index_Table_Entry* entry = &ghb_hwp->index_table[idx];
+  if (entry->valid && entry->czone_tag != czone_tag)
+    hash_table_access_delete(&ghb_hwp->czone_map, entry->czone_tag);
+  entry->valid = TRUE;
+  entry->czone_tag = czone_tag;
+  Flag new_entry;
+  *(int*)hash_table_access_create(&ghb_hwp->czone_map, czone_tag, &new_entry) = idx;
+  ghb_hwp->invalid_entries[idx / 64] &= ~(1ULL << (idx % 64));
+}
+
+static void ghb_index_invalidate(Pref_GHB* ghb_hwp, int idx) {
+  GHB_Index_Table_Entry* entry = &ghb_hwp->index_table[idx];
+  if (entry->valid)
+    hash_table_access_delete(&ghb_hwp->czone_map, entry->czone_tag);
+  entry->valid = FALSE;
+  ghb_hwp->invalid_entries[idx / 64] |= 1ULL << (idx % 64);
+}
+
+static void ghb_index_set_last_access(Pref_GHB* ghb_hwp, int idx, uns last_access) {
+  GHB_Index_Table_Entry* table = ghb_hwp->index_table;
+  uns old_last_access = table[idx].last_access;
+  int max_idx = ghb_hwp->max_last_access_idx;
+  table[idx].last_access = last_access;
+  if (idx != max_idx) {
+    if (last_access > table[max_idx].last_access || (last_access == table[max_idx].last_access && idx < max_idx))
+      ghb_hwp->max_last_access_idx = idx;
+  } else if (last_access < old_last_access) {
+    // only when the uns copy of cycle_count wraps; same scan as the original victim search
+    max_idx = 0;
+    for (int ii = 1; ii < PREF_GHB_INDEX_N; ii++)
+      if (table[max_idx].last_access < table[ii].last_access)
+        max_idx = ii;
+    ghb_hwp->max_last_access_idx = max_idx;
+  }
+}
+
+/* Same choice as scanning the table: the first invalid entry, otherwise the first entry with the largest
+ * last_access */
+static int ghb_index_victim(const Pref_GHB* ghb_hwp) {
+  for (uns word = 0; word < GHB_INDEX_WORDS; word++)
+    if (ghb_hwp->invalid_entries[word])
+      return word * 64 + __builtin_ctzll(ghb_hwp->invalid_entries[word]);
+  return ghb_hwp->max_last_access_idx;
+}
+
 void pref_ghb_throttle(Pref_GHB* ghb_hwp) {
   int dyn_shift = 0;
 
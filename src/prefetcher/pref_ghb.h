@@ -28,6 +28,8 @@
 #ifndef __PREF_GHB_H__
 #define __PREF_GHB_H__
 
+#include "libs/hash_lib.h"
+
 #include "pref_common.h"
 
 #define CZONE_TAG(x) (x >> (PREF_GHB_CZONE_BITS))
@@ -51,6 +53,9 @@ typedef struct Pref_GHB_Struct {
 
   // Index table
   GHB_Index_Table_Entry* index_table;
+  Hash_Table czone_map;      // czone_tag -> index table entry, for the valid entries
+  uns64* invalid_entries;    // bitmap of the invalid index table entries
+  int max_last_access_idx;   // entry with the largest last_access, lowest index first
   // GHB
   GHB_Entry* ghb_buffer;
 
@@ -50,6 +50,7 @@
 #include "memory/memory.h"
 #include "prefetcher/l2l1pref.h"
 #include "prefetcher/pref_common.h"
+#include "prefetcher/stream_index.h"
 
 #include "dcache_stage.h"
 #include "op.h"
@@ -136,6 +137,9 @@ void init_stream_core(HWP* hwp, Pref_Stream* pref_stream_core) {
     if (PREF_STREAM_PER_CORE_ENABLE) {
       pref_stream_core[proc_id].stream = (Stream_Buffer*)calloc(STREAM_BUFFER_N, sizeof(Stream_Buffer));
       memset(pref_stream_core[proc_id].stream, 0, STREAM_BUFFER_N * sizeof(Stream_Buffer));
+      pref_stream_core[proc_id].index = (Stream_Index*)malloc(sizeof(Stream_Index));
+      stream_index_init(pref_stream_core[proc_id].index, "pref_stream_index", pref_stream_core[proc_id].stream,
+                        STREAM_BUFFER_N, STREAM_TRAIN_LENGTH);
       pref_stream_core[proc_id].train_filter = (Addr*)calloc(TRAIN_FILTER_SIZE, sizeof(Addr));
       memset(pref_stream_core[proc_id].train_filter, 0, TRAIN_FILTER_SIZE * sizeof(Addr));
       pref_stream_core[proc_id].train_filter_no = (int*)malloc(sizeof(int));
@@ -163,6 +167,9 @@ void init_stream_core(HWP* hwp, Pref_Stream* pref_stream_core) {
   if (!PREF_STREAM_PER_CORE_ENABLE) {
     pref_stream_core[0].stream = (Stream_Buffer*)calloc(STREAM_BUFFER_N, sizeof(Stream_Buffer));
     memset(pref_stream_core[0].stream, 0, STREAM_BUFFER_N * sizeof(Stream_Buffer));
+    pref_stream_core[0].index = (Stream_Index*)malloc(sizeof(Stream_Index));
+    stream_index_init(pref_stream_core[0].index, "pref_stream_index", pref_stream_core[0].stream, STREAM_BUFFER_N,
+                      STREAM_TRAIN_LENGTH);
     pref_stream_core[0].train_filter = (Addr*)calloc(TRAIN_FILTER_SIZE, sizeof(Addr));
     memset(pref_stream_core[0].train_filter, 0, TRAIN_FILTER_SIZE * sizeof(Addr));
     pref_stream_core[0].train_filter_no = (int*)malloc(sizeof(int));
@@ -170,6 +177,7 @@ void init_stream_core(HWP* hwp, Pref_Stream* pref_stream_core) {
 
     for (proc_id = 1; proc_id < NUM_CORES; proc_id++) {
       pref_stream_core[proc_id].stream = pref_stream_core[0].stream;
+      pref_stream_core[proc_id].index = pref_stream_core[0].index;
       pref_stream_core[proc_id].train_filter = pref_stream_core[0].train_filter;
       pref_stream_core[proc_id].train_filter_no = pref_stream_core[0].train_filter_no;
     }
@@ -215,6 +223,7 @@ void pref_stream_train(Pref_Stream* pref_stream, uns8 proc_id, Addr line_addr, A
 
     if (stream->trained) {
       stream->lru = cycle_count;  // update lru
+      stream_index_touch(pref_stream->index, hit_index);
       STAT_EVENT(0, HIT_TRAIN_STREAM);
       stream->pause = SAT_DEC(stream->pause, 0);
       if (stream->pause > 0)
@@ -239,6 +248,7 @@ void pref_stream_train(Pref_Stream* pref_stream, uns8 proc_id, Addr line_addr, A
         // addresses
         if (proc_id != (stream->ep + stream->dir) >> (58 - LOG2(DCACHE_LINE_SIZE))) {
           stream->valid = FALSE;
+          stream_index_update(pref_stream->index, hit_index);
           return;
         }
 
@@ -260,6 +270,7 @@ void pref_stream_train(Pref_Stream* pref_stream, uns8 proc_id, Addr line_addr, A
           stream->buffer_full = TRUE;
           stream->sp = stream->sp + stream->dir;
         }
+        stream_index_update(pref_stream->index, hit_index);
 
         if (REMOVE_REDUNDANT_STREAM)
           pref_stream_remove_redundant_stream(pref_stream, hit_index);
@@ -307,12 +318,18 @@ int pref_stream_train_create_stream_buffer(Pref_Stream* pref_stream, uns8 proc_i
   int lru_index = -1;
   Flag found_closeby = FALSE;
   Addr line_index = line_addr >> LOG2(DCACHE_LINE_SIZE);
+  Stream_Index* index = pref_stream->index;
 
   ASSERTM(proc_id, extra_dis == 0 || (!train && !create),
           "extra_dis should not be used when altering prefetcher state\n");
 
+  // Only the streams the index holds near line_index can match; walking them in table order keeps the first
+  // match of the full scans.
+  const uns64* candidates = stream_index_candidates(
+      index, line_index >= (Addr)extra_dis ? line_index - extra_dis : 0, line_index + extra_dis);
+
   // First check for a trained buffer
-  for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
+  for (ii = stream_index_next(index, candidates, 0); ii != -1; ii = stream_index_next(index, candidates, ii + 1)) {
     Stream_Buffer* stream = &pref_stream->stream[ii];
     if (stream->valid && stream->trained) {
       if (((stream->sp <= line_index) && (stream->ep + extra_dis >= line_index) && (stream->dir == 1)) ||
@@ -327,7 +344,7 @@ int pref_stream_train_create_stream_buffer(Pref_Stream* pref_stream, uns8 proc_i
   }
 
   if (train || create) {
-    for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
+    for (ii = stream_index_next(index, candidates, 0); ii != -1; ii = stream_index_next(index, candidates, ii + 1)) {
       Stream_Buffer* stream = &pref_stream->stream[ii];
       if (stream->valid && !stream->trained) {
         if ((stream->sp <= (line_index + STREAM_TRAIN_LENGTH)) && (stream->sp >= (line_index - STREAM_TRAIN_LENGTH))) {
@@ -347,9 +364,11 @@ int pref_stream_train_create_stream_buffer(Pref_Stream* pref_stream, uns8 proc_i
               // check for address space overflow
               if (get_proc_id_from_cmp_addr(stream->ep << LOG2(DCACHE_LINE_SIZE)) != proc_id) {
                 stream->valid = FALSE;
+                stream_index_update(index, ii);
                 return -1;
               }
               stream->dir = dir;
+              stream_index_update(index, ii);
               DEBUG(proc_id,
                     "stream  trained stream_index:%3d sp %7s ep %7s dir %2d "
                     "miss_index %7d\n",
@@ -368,23 +387,12 @@ int pref_stream_train_create_stream_buffer(Pref_Stream* pref_stream, uns8 proc_i
 
   if (create) {
     // search for invalid buffer
-    for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
-      if (!pref_stream->stream[ii].valid) {
-        lru_index = ii;
-        break;
-      }
-    }
+    lru_index = stream_index_first_invalid(index);
 
     // search for oldest buffer
 
     if (lru_index == -1) {
-      lru_index = 0;
-
-      for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
-        if (pref_stream->stream[ii].lru < pref_stream->stream[lru_index].lru) {
-          lru_index = ii;
-        }
-      }
+      lru_index = stream_index_lru(index);
       STAT_EVENT(0, REPLACE_OLD_STREAM);
       collect_stream_stats(&pref_stream->stream[lru_index]);
       if (PREF_STREAM_PER_CORE_ENABLE) {
@@ -408,6 +416,8 @@ int pref_stream_train_create_stream_buffer(Pref_Stream* pref_stream, uns8 proc_i
     lru_stream->length = STREAM_LENGTH;
     lru_stream->pref_issued = 0;
     lru_stream->pref_useful = 0;
+    stream_index_update(index, lru_index);
+    stream_index_touch(index, lru_index);
 
     STAT_EVENT_ALL(STREAM_TRAIN_CREATE);
     STAT_EVENT(proc_id, CORE_STREAM_TRAIN_CREATE);
@@ -498,14 +508,20 @@ void pref_stream_addto_train_stream_filter(Pref_Stream* pref_stream, Addr line_i
 void pref_stream_remove_redundant_stream(Pref_Stream* pref_stream, int hit_index) {
   int ii;
   Stream_Buffer* hit_stream = &pref_stream->stream[hit_index];
+  Stream_Index* index = pref_stream->index;
 
-  for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
+  // only an sp or ep strictly between the hit stream's sp and ep is removed
+  if (hit_stream->sp >= hit_stream->ep)
+    return;
+  const uns64* candidates = stream_index_candidates(index, hit_stream->sp, hit_stream->ep);
+  for (ii = stream_index_next(index, candidates, 0); ii != -1; ii = stream_index_next(index, candidates, ii + 1)) {
     Stream_Buffer* stream = &pref_stream->stream[ii];
     if (ii == hit_index || !stream->valid)
       continue;
     if ((stream->ep < hit_stream->ep && stream->ep > hit_stream->sp) ||
         (stream->sp < hit_stream->ep && stream->sp > hit_stream->sp)) {
       stream->valid = FALSE;
+      stream_index_update(index, ii);
       STAT_EVENT(0, REMOVE_REDUNDANT_STREAM_STAT);
       DEBUG(0, "stream[%d] sp:0x%s ep:0x%s is removed by stream[%d] sp:0x%s ep:0x%s\n", ii, hexstr64(stream->sp),
             hexstr64(stream->ep), hit_index, hexstr64(hit_stream->sp), hexstr64(hit_stream->ep));
@@ -37,6 +37,7 @@
 
 struct HWP_struct;
 struct HWP_Info_struct;
+struct Stream_Index_struct;
 
 /**************************************************************************************/
 /* Types */
@@ -69,6 +70,7 @@ typedef struct Pref_Stream_struct {
   // WATCHOUT These are shared by cores or duplicated based on
   // PREF_STREAM_PER_CORE_ENABLE
   Stream_Buffer* stream;
+  struct Stream_Index_struct* index;  // lookup index over stream
   Addr* train_filter;
   int* train_filter_no;
   ////////////////////////////////////////////////
@@ -0,0 +1,214 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : stream_index.c
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Secondary index over a fully associative stream buffer table
+ ***************************************************************************************/
+
+#include <string.h>
+
+#include "prefetcher/stream_index.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/utils.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define STREAM_INDEX_BUCKET_BITS 6  // lines per address bucket: 64
+#define BIT_WORD(ii) ((ii) >> 6)
+#define BIT_MASK(ii) (1ULL << ((ii)&63))
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static void stream_reach(const Stream_Index* index, const Stream_Buffer* stream, Addr* lo, Addr* hi);
+static void bucket_add(Stream_Index* index, Addr bucket, uns ii);
+static void bucket_remove(Stream_Index* index, Addr bucket, uns ii);
+static void lru_unlink(Stream_Index* index, int ii);
+static void lru_insert_sorted(Stream_Index* index, int ii);
+
+/**************************************************************************************/
+
+void stream_index_init(Stream_Index* index, const char* name, Stream_Buffer* streams, uns num_streams,
+                       uns train_length) {
+  index->streams = streams;
+  index->num_streams = num_streams;
+  index->words = (num_streams + 63) / 64;
+  index->train_length = train_length;
+  init_hash_table(&index->buckets, name, MAX2(num_streams * 4, 64), index->words * sizeof(uns64));
+  index->registered = (Flag*)calloc(num_streams, sizeof(Flag));
+  index->first_bucket = (Addr*)calloc(num_streams, sizeof(Addr));
+  index->last_bucket = (Addr*)calloc(num_streams, sizeof(Addr));
+  index->invalid = (uns64*)calloc(index->words, sizeof(uns64));
+  index->candidates = (uns64*)calloc(index->words, sizeof(uns64));
+  index->lru_prev = (int*)malloc(num_streams * sizeof(int));
+  index->lru_next = (int*)malloc(num_streams * sizeof(int));
+  index->lru_head = -1;
+  index->lru_tail = -1;
+
+  for (uns ii = 0; ii < num_streams; ii++) {
+    lru_insert_sorted(index, ii);
+    stream_index_update(index, ii);
+  }
+}
+
+/* Addresses a stream can match: the lookup and redundancy tests compare against sp and ep, and an untrained stream
+ * matches up to train_length lines away from sp. */
+static void stream_reach(const Stream_Index* index, const Stream_Buffer* stream, Addr* lo, Addr* hi) {
+  if (stream->trained) {
+    *lo = MIN2(stream->sp, stream->ep);
+    *hi = MAX2(stream->sp, stream->ep);
+  } else {
+    *lo = stream->sp >= index->train_length ? stream->sp - index->train_length : 0;
+    *hi = stream->sp + index->train_length >= stream->sp ? stream->sp + index->train_length : (Addr)-1;
+    // ep is sp until training, but keep it covered for the redundant stream check
+    *lo = MIN2(*lo, stream->ep);
+    *hi = MAX2(*hi, stream->ep);
+  }
+}
+
+static void bucket_add(Stream_Index* index, Addr bucket, uns ii) {
+  Flag new_entry;
+  uns64* bits = (uns64*)hash_table_access_create(&index->buckets, bucket, &new_entry);
+  bits[BIT_WORD(ii)] |= BIT_MASK(ii);
+}
+
+static void bucket_remove(Stream_Index* index, Addr bucket, uns ii) {
+  uns64* bits = (uns64*)hash_table_access(&index->buckets, bucket);
+  ASSERT(0, bits && (bits[BIT_WORD(ii)] & BIT_MASK(ii)));
+  bits[BIT_WORD(ii)] &= ~BIT_MASK(ii);
+  for (uns word = 0; word < index->words; word++)
+    if (bits[word])
+      return;
+  hash_table_access_delete(&index->buckets, bucket);
+}
+
+void stream_index_update(Stream_Index* index, uns ii) {
+  const Stream_Buffer* stream = &index->streams[ii];
+  Addr first = 0, last = 0;
+  Flag registered = stream->valid;
+
+  if (stream->valid)
+    index->invalid[BIT_WORD(ii)] &= ~BIT_MASK(ii);
+  else
+    index->invalid[BIT_WORD(ii)] |= BIT_MASK(ii);
+
+  if (registered) {
+    Addr lo, hi;
+    stream_reach(index, stream, &lo, &hi);
+    first = lo >> STREAM_INDEX_BUCKET_BITS;
+    last = hi >> STREAM_INDEX_BUCKET_BITS;
+  }
+
+  // move only the buckets that changed; ep advancing one line crosses a bucket every 64 prefetches
+  if (index->registered[ii]) {
+    for (Addr bucket = index->first_bucket[ii]; bucket <= index->last_bucket[ii]; bucket++)
+      if (!registered || bucket < first || bucket > last)
+        bucket_remove(index, bucket, ii);
+  }
+  if (registered) {
+    for (Addr bucket = first; bucket <= last; bucket++)
+      if (!index->registered[ii] || bucket < index->first_bucket[ii] || bucket > index->last_bucket[ii])
+        bucket_add(index, bucket, ii);
+  }
+
+  index->registered[ii] = registered;
+  index->first_bucket[ii] = first;
+  index->last_bucket[ii] = last;
+}
+
+const uns64* stream_index_candidates(Stream_Index* index, Addr lo, Addr hi) {
+  memset(index->candidates, 0, index->words * sizeof(uns64));
+  for (Addr bucket = lo >> STREAM_INDEX_BUCKET_BITS; bucket <= hi >> STREAM_INDEX_BUCKET_BITS; bucket++) {
+    const uns64* bits = (const uns64*)hash_table_access(&index->buckets, bucket);
+    if (bits)
+      for (uns word = 0; word < index->words; word++)
+        index->candidates[word] |= bits[word];
+  }
+  return index->candidates;
+}
+
+int stream_index_next(const Stream_Index* index, const uns64* bitmap, int ii) {
+  if (ii < 0 || (uns)ii >= index->num_streams)
+    return -1;
+  uns word = BIT_WORD(ii);
+  uns64 bits = bitmap[word] & ~(BIT_MASK(ii) - 1);
+  while (!bits) {
+    if (++word == index->words)
+      return -1;
+    bits = bitmap[word];
+  }
+  int next = word * 64 + __builtin_ctzll(bits);
+  return (uns)next < index->num_streams ? next : -1;
+}
+
+int stream_index_first_invalid(const Stream_Index* index) {
+  return stream_index_next(index, index->invalid, 0);
+}
+
+int stream_index_lru(const Stream_Index* index) {
+  return index->lru_head;
+}
+
+static void lru_unlink(Stream_Index* index, int ii) {
+  int prev = index->lru_prev[ii];
+  int next = index->lru_next[ii];
+  if (prev == -1)
+    index->lru_head = next;
+  else
+    index->lru_next[prev] = next;
+  if (next == -1)
+    index->lru_tail = prev;
+  else
+    index->lru_prev[next] = prev;
+}
+
+/* The new lru is normally the current cycle and goes at the tail; the walk back only runs when lru is not the
+ * largest, e.g. after the int lru field wraps, so the order always matches the replacement scan's. */
+static void lru_insert_sorted(Stream_Index* index, int ii) {
+  int lru = index->streams[ii].lru;
+  int prev = index->lru_tail;
+  while (prev != -1 && (index->streams[prev].lru > lru || (index->streams[prev].lru == lru && prev > ii)))
+    prev = index->lru_prev[prev];
+
+  int next = prev == -1 ? index->lru_head : index->lru_next[prev];
+  index->lru_prev[ii] = prev;
+  index->lru_next[ii] = next;
+  if (prev == -1)
+    index->lru_head = ii;
+  else
+    index->lru_next[prev] = ii;
+  if (next == -1)
+    index->lru_tail = ii;
+  else
+    index->lru_prev[next] = ii;
+}
+
+void stream_index_touch(Stream_Index* index, uns ii) {
+  lru_unlink(index, ii);
+  lru_insert_sorted(index, ii);
+}
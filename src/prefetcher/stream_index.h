@@ -0,0 +1,84 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : stream_index.h
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Secondary index over a fully associative stream buffer table.
+ *
+ *                Valid streams are registered in the address buckets their reach
+ *                overlaps (between sp and ep once trained, sp +/- the train length
+ *                before), so a lookup only checks the streams registered near the
+ *                miss. Candidates come back as a bitmap in table order and the
+ *                callers keep their original match tests, so the first match is the
+ *                same entry the linear scans returned. The index also keeps the
+ *                invalid entries and an order by (lru, index) for the victim choice.
+ *                Every change to valid, trained, sp, ep or lru must be reported.
+ ***************************************************************************************/
+#ifndef __STREAM_INDEX_H__
+#define __STREAM_INDEX_H__
+
+#include "globals/global_types.h"
+
+#include "libs/hash_lib.h"
+#include "prefetcher/pref_stream.h"
+
+/**************************************************************************************/
+/* Types */
+
+typedef struct Stream_Index_struct {
+  Stream_Buffer* streams;
+  uns num_streams;
+  uns words;         // uns64 words per stream bitmap
+  uns train_length;  // reach of an untrained stream on each side of sp
+  Hash_Table buckets;  // bucket -> bitmap of the streams whose reach overlaps it
+  Flag* registered;
+  Addr* first_bucket;  // buckets each registered stream is in
+  Addr* last_bucket;
+  uns64* invalid;      // bitmap of invalid streams
+  uns64* candidates;   // result of the last stream_index_candidates call
+  // doubly linked list of all streams sorted by (lru, index); the head is the victim
+  int* lru_prev;
+  int* lru_next;
+  int lru_head;
+  int lru_tail;
+} Stream_Index;
+
+/**************************************************************************************/
+/* Prototypes */
+
+void stream_index_init(Stream_Index* index, const char* name, Stream_Buffer* streams, uns num_streams,
+                       uns train_length);
+/* Call after the valid, trained, sp or ep field of a stream changed */
+void stream_index_update(Stream_Index* index, uns ii);
+/* Call after the lru field of a stream changed */
+void stream_index_touch(Stream_Index* index, uns ii);
+/* Bitmap of the valid streams whose reach overlaps [lo, hi] (a superset of the matches) */
+const uns64* stream_index_candidates(Stream_Index* index, Addr lo, Addr hi);
+/* First stream set in bitmap at or after ii, or -1 */
+int stream_index_next(const Stream_Index* index, const uns64* bitmap, int ii);
+/* Lowest-numbered invalid stream, or -1 */
+int stream_index_first_invalid(const Stream_Index* index);
+/* Stream with the smallest lru, lowest index first */
+int stream_index_lru(const Stream_Index* index);
+
+#endif /*  __STREAM_INDEX_H__*/
@@ -50,6 +50,7 @@
 #include "prefetcher//pref_stream.h"
 #include "prefetcher/l2l1pref.h"
 #include "prefetcher/pref_common.h"
+#include "prefetcher/stream_index.h"
 
 #include "dcache_stage.h"
 #include "op.h"
@@ -102,6 +103,9 @@ static int l2hit_l2access_send_no;
 void init_stream_HWP(void) {
   stream_hwp = (Stream_HWP*)malloc(sizeof(Stream_HWP));
   stream_hwp->stream = (Stream_Buffer*)calloc(STREAM_BUFFER_N, sizeof(Stream_Buffer));
+  stream_hwp->stream_index = (Stream_Index*)malloc(sizeof(Stream_Index));
+  stream_index_init(stream_hwp->stream_index, "stream_hwp_index", stream_hwp->stream, STREAM_BUFFER_N,
+                    STREAM_TRAIN_LENGTH);
 
   stream_hwp->pref_req_queue = (Pref_Mem_Req*)calloc(PREF_REQ_Q_SIZE, sizeof(Pref_Mem_Req));
   train_filter = (Addr*)calloc(TRAIN_FILTER_SIZE, sizeof(Addr));
@@ -142,6 +146,7 @@ void stream_dl0_miss(Addr line_addr) /* line_addr: the first address of the
 
     if (stream_hwp->stream[hit_index].trained) {
       stream_hwp->stream[hit_index].lru = cycle_count;  // update lru
+      stream_index_touch(stream_hwp->stream_index, hit_index);
       STAT_EVENT(proc_id, HIT_TRAIN_STREAM);
       /* hit the stream_buffer, request the prefetch */
 
@@ -180,6 +185,7 @@ void stream_dl0_miss(Addr line_addr) /* line_addr: the first address of the
           stream_hwp->stream[hit_index].buffer_full = TRUE;
           stream_hwp->stream[hit_index].sp = stream_hwp->stream[hit_index].sp + stream_hwp->stream[hit_index].dir;
         }
+        stream_index_update(stream_hwp->stream_index, hit_index);
         STAT_EVENT(proc_id, STREAM_BUFFER_REQ);
 
         if (REMOVE_REDUNDANT_STREAM)
@@ -214,6 +220,7 @@ void stream_dl0_hit_train(Addr line_addr) {
 
     if (stream_hwp->stream[hit_index].trained) {
       stream_hwp->stream[hit_index].lru = cycle_count;  // update lru
+      stream_index_touch(stream_hwp->stream_index, hit_index);
       STAT_EVENT(proc_id, HIT_TRAIN_STREAM);
       /* hit the stream_buffer, request the prefetch */
 
@@ -252,6 +259,7 @@ void stream_dl0_hit_train(Addr line_addr) {
           stream_hwp->stream[hit_index].buffer_full = TRUE;
           stream_hwp->stream[hit_index].sp = stream_hwp->stream[hit_index].sp + stream_hwp->stream[hit_index].dir;
         }
+        stream_index_update(stream_hwp->stream_index, hit_index);
         STAT_EVENT(proc_id, STREAM_BUFFER_REQ);
 
         if (REMOVE_REDUNDANT_STREAM)
@@ -406,9 +414,12 @@ int train_create_stream_buffer(uns proc_id, Addr line_index, Flag train, Flag cr
   int ii;
   int dir;
   int lru_index = -1;
+  Stream_Index* index = stream_hwp->stream_index;
 
   if (train || create) {
-    for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
+    // walk only the streams indexed near line_index, in table order
+    const uns64* candidates = stream_index_candidates(index, line_index, line_index);
+    for (ii = stream_index_next(index, candidates, 0); ii != -1; ii = stream_index_next(index, candidates, ii + 1)) {
       if (stream_hwp->stream[ii].valid && stream_hwp->stream[ii].trained) {
         if (((stream_hwp->stream[ii].sp <= line_index) && (stream_hwp->stream[ii].ep >= line_index) &&
              (stream_hwp->stream[ii].dir == 1)) ||
@@ -420,7 +431,7 @@ int train_create_stream_buffer(uns proc_id, Addr line_index, Flag train, Flag cr
       }
     }
 
-    for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
+    for (ii = stream_index_next(index, candidates, 0); ii != -1; ii = stream_index_next(index, candidates, ii + 1)) {
       if (stream_hwp->stream[ii].valid && (!stream_hwp->stream[ii].trained)) {
         if ((stream_hwp->stream[ii].sp <= (line_index + STREAM_TRAIN_LENGTH)) &&
             (stream_hwp->stream[ii].sp >= (line_index - STREAM_TRAIN_LENGTH))) {  // FIXME: should creation be
@@ -437,6 +448,7 @@ int train_create_stream_buffer(uns proc_id, Addr line_index, Flag train, Flag cr
             stream_hwp->stream[ii].ep =
                 (dir > 0) ? line_index + STREAM_START_DIS : line_index - STREAM_START_DIS;  // BUG 57
             stream_hwp->stream[ii].dir = dir;
+            stream_index_update(index, ii);
             DEBUG(proc_id,
                   "stream  trained stream_index:%3d sp %7s ep %7s dir %2d "
                   "miss_index %7d\n",
@@ -455,22 +467,12 @@ int train_create_stream_buffer(uns proc_id, Addr line_index, Flag train, Flag cr
 
   if (create) {
     // search for invalid buffer
-    for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
-      if (!stream_hwp->stream[ii].valid) {
-        lru_index = ii;
-        break;
-      }
-    }
+    lru_index = stream_index_first_invalid(index);
 
     // search for oldest buffer
 
     if (lru_index == -1) {
-      lru_index = 0;
-      for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
-        if (stream_hwp->stream[ii].lru < stream_hwp->stream[lru_index].lru) {
-          lru_index = ii;
-        }
-      }
+      lru_index = stream_index_lru(index);
       STAT_EVENT(proc_id, REPLACE_OLD_STREAM);
     }
 
@@ -483,6 +485,8 @@ int train_create_stream_buffer(uns proc_id, Addr line_index, Flag train, Flag cr
     stream_hwp->stream[lru_index].train_hit = 1;
     stream_hwp->stream[lru_index].trained = FALSE;
     stream_hwp->stream[lru_index].buffer_full = FALSE;
+    stream_index_update(index, lru_index);
+    stream_index_touch(index, lru_index);
 
     STAT_EVENT(proc_id, STREAM_TRAIN_CREATE);
     DEBUG(proc_id, "create new stream : stream_no :%3d, line_index %7s sp = %7s\n", lru_index, hexstr64(line_index),
@@ -691,8 +695,15 @@ int train_l2hit_stream_buffer(Addr line_index, Flag hit) {
 
 void remove_redundant_stream(int hit_index) {
   int ii;
+  Stream_Index* index = stream_hwp->stream_index;
+  Addr hit_sp = stream_hwp->stream[hit_index].sp;
+  Addr hit_ep = stream_hwp->stream[hit_index].ep;
 
-  for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
+  // only an sp or ep strictly between the hit stream's sp and ep is removed
+  if (hit_sp >= hit_ep)
+    return;
+  const uns64* candidates = stream_index_candidates(index, hit_sp, hit_ep);
+  for (ii = stream_index_next(index, candidates, 0); ii != -1; ii = stream_index_next(index, candidates, ii + 1)) {
     if ((ii == hit_index) || (!stream_hwp->stream[ii].valid))
       continue;
     if (((stream_hwp->stream[ii].ep < stream_hwp->stream[hit_index].ep) &&
@@ -700,6 +711,7 @@ void remove_redundant_stream(int hit_index) {
         ((stream_hwp->stream[ii].sp < stream_hwp->stream[hit_index].ep) &&
          (stream_hwp->stream[ii].sp > stream_hwp->stream[hit_index].sp))) {
       stream_hwp->stream[ii].valid = FALSE;
+      stream_index_update(index, ii);
       STAT_EVENT(0, REMOVE_REDUNDANT_STREAM_STAT);
       DEBUG(0, "stream[%d] sp:0x%s ep:0x%s is removed by stream[%d] sp:0x%s ep:0x%s\n", ii,
             hexstr64(stream_hwp->stream[ii].sp), hexstr64(stream_hwp->stream[ii].ep), hit_index,
@@ -36,6 +36,7 @@
 struct Mem_Req_struct;
 struct Pref_Mem_Req_struct;
 struct Stream_Buffer_struct;
+struct Stream_Index_struct;
 
 /**************************************************************************************/
 /* Types */
@@ -43,6 +44,7 @@ struct Stream_Buffer_struct;
 typedef struct Stream_HWP_Struct {
   // stream HWP
   Stream_Buffer* stream;
+  struct Stream_Index_struct* stream_index;  // lookup index over stream
   Stream_Buffer* l2hit_stream;
   /* prefetch req queues */
   Pref_Mem_Req* pref_req_queue;
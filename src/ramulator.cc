@@ -26,9 +26,12 @@
  * Description  : Defines an interface to Ramulator
  ***************************************************************************************/
 
+#include <cmath>
 #include <deque>
 #include <list>
 #include <map>
+#include <queue>
+#include <string.h>
 #include <utility>
 
 #include "ramulator/Config.h"
@@ -37,6 +40,7 @@
 
 extern "C" {
 #include "globals/assert.h"
+#include "globals/utils.h"
 
 #include "general.param.h"
 #include "memory/memory.param.h"
@@ -48,6 +52,8 @@ extern "C" {
 #include "statistics.h"
 }
 
+#include "dram_analytic.h"
+
 /**************************************************************************************/
 /* Macros */
 
@@ -64,6 +70,10 @@ void to_ramulator_req(const Mem_Req* scarab_req, Request* ramulator_req);
 void init_configs();
 bool try_completing_request(Mem_Req* req);
 void enqueue_response(Request& req);
+void complete_read(long addr);
+bool analytic_send(const Request& req);
+void calibration_send(const Request& req);
+void calibration_finish();
 
 void stats_callback(int coreid, int type);
 
@@ -73,6 +83,28 @@ deque<pair<long, Mem_Req*>> resp_queue;  // completed read request that need to
 map<long, list<Mem_Req*>> inflight_read_reqs;
 // map<long, Mem_Req*> inflight_read_reqs;
 
+/* Analytic model (--dram_model analytic, or timed alongside Ramulator with --dram_analytic_calibrate) */
+Dram_Analytic* analytic = NULL;
+bool analytic_only = false;
+Counter dram_cycle = 0;  // ramulator_tick() calls, i.e. memory clock cycles
+// (done cycle, address) of the reads timed by the analytic model
+priority_queue<pair<Counter, long>, vector<pair<Counter, long>>, greater<pair<Counter, long>>> analytic_done;
+
+/* Calibration: least squares fit of (Ramulator latency - analytic base latency) over the outcome indicators and the
+ * analytic queueing delay, accumulated as normal equations so no per-request samples are kept. */
+#define CALIB_TERMS 4  // ROW_HIT, ROW_CLOSED and ROW_CONFLICT offsets, queue scale
+
+struct Calib_Sample {
+  Counter send_cycle;
+  Dram_Analytic::Access access;
+};
+
+map<long, Calib_Sample> calib_inflight;
+double calib_ata[CALIB_TERMS][CALIB_TERMS];
+double calib_atb[CALIB_TERMS];
+double calib_btb;
+Counter calib_samples;
+
 void ramulator_init() {
   ASSERTM(0, ICACHE_LINE_SIZE == DCACHE_LINE_SIZE,
           "Ramulator"
@@ -81,6 +113,19 @@ void ramulator_init() {
           "DCACHE_LINE_SIZE=%d \n",
           ICACHE_LINE_SIZE, DCACHE_LINE_SIZE);
 
+  if (!strcmp(DRAM_MODEL, "analytic")) {
+    ASSERTM(0, !DRAM_ANALYTIC_CALIBRATE, "dram_analytic_calibrate needs dram_model ramulator\n");
+    analytic_only = true;
+  } else {
+    ASSERTM(0, !strcmp(DRAM_MODEL, "ramulator"), "Unknown dram_model %s\n", DRAM_MODEL);
+  }
+  if (analytic_only || DRAM_ANALYTIC_CALIBRATE)
+    analytic = new Dram_Analytic(analytic_only);
+  if (analytic_only) {
+    DPRINTF("Initialized the analytic DRAM model. \n");
+    return;
+  }
+
   configs = new Config();
   init_configs();
 
@@ -90,6 +135,12 @@ void ramulator_init() {
 }
 
 void ramulator_finish() {
+  if (DRAM_ANALYTIC_CALIBRATE)
+    calibration_finish();
+  delete analytic;
+  if (analytic_only)
+    return;
+
   wrapper->finish();
 
   delete wrapper;
@@ -192,7 +243,9 @@ int ramulator_send(Mem_Req* scarab_req) {
     return true;  // a request to the same address is already issued
   }
 
-  bool is_sent = wrapper->send(req);
+  bool is_sent = analytic_only ? analytic_send(req) : wrapper->send(req);
+  if (is_sent && DRAM_ANALYTIC_CALIBRATE)
+    calibration_send(req);
 
   if (is_sent) {
     STAT_EVENT(scarab_req->proc_id, POWER_MEMORY_CTRL_ACCESS);
@@ -223,12 +276,34 @@ int ramulator_send(Mem_Req* scarab_req) {
 void enqueue_response(Request& req) {
   // This should only be called by READ requests
   ASSERTM(0, req.type == Request::Type::READ, "ERROR: Responses should be sent only for read requests! \n");
-  ASSERTM(0, inflight_read_reqs.find(req.addr) != inflight_read_reqs.end(),
+
+  if (DRAM_ANALYTIC_CALIBRATE) {
+    auto it_sample = calib_inflight.find(req.addr);
+    ASSERT(0, it_sample != calib_inflight.end());
+    const Dram_Analytic::Access& access = it_sample->second.access;
+    double x[CALIB_TERMS] = {0, 0, 0, (double)access.queue};
+    x[access.outcome] = 1;
+    double y = (double)(dram_cycle - it_sample->second.send_cycle) - (double)access.base;
+    for (uns i = 0; i < CALIB_TERMS; i++) {
+      for (uns j = 0; j < CALIB_TERMS; j++)
+        calib_ata[i][j] += x[i] * x[j];
+      calib_atb[i] += x[i] * y;
+    }
+    calib_btb += y * y;
+    calib_samples++;
+    calib_inflight.erase(it_sample);
+  }
+
+  complete_read(req.addr);
+}
+
+void complete_read(long addr) {
+  ASSERTM(0, inflight_read_reqs.find(addr) != inflight_read_reqs.end(),
           "ERROR: A corresponding Scarab request was not found for the "
-          "Ramulator request that read address: %lu\n",
-          req.addr);
+          "DRAM request that read address: %lu\n",
+          addr);
 
-  auto it_scarab_req = inflight_read_reqs.find(req.addr);
+  auto it_scarab_req = inflight_read_reqs.find(addr);
   for (auto req : it_scarab_req->second)
     resp_queue.push_back(make_pair(it_scarab_req->first, req));
   // resp_queue.push_back(make_pair(it_scarab_req->first, it_scarab_req->second));
@@ -285,8 +360,98 @@ void to_ramulator_req(const Mem_Req* scarab_req, Request* ramulator_req) {
   ramulator_req->callback = enqueue_response;
 }
 
+bool analytic_send(const Request& req) {
+  bool is_write = req.type == Request::Type::WRITE;
+  if (!analytic->can_accept(req.addr, is_write, dram_cycle))
+    return false;
+
+  Dram_Analytic::Access access = analytic->access(req.addr, is_write, req.coreid, dram_cycle);
+  if (!is_write)
+    analytic_done.push(make_pair(access.done, req.addr));
+  return true;
+}
+
+/* Times a request accepted by Ramulator with the analytic model as well */
+void calibration_send(const Request& req) {
+  bool is_write = req.type == Request::Type::WRITE;
+  Dram_Analytic::Access access = analytic->access(req.addr, is_write, req.coreid, dram_cycle);
+  if (!is_write)
+    calib_inflight[req.addr] = {dram_cycle, access};
+}
+
+/* Root mean square error of the latency model with the given coefficients over the calibration samples */
+static double calibration_rmse(const double* coeff) {
+  double sse = calib_btb;
+  for (uns i = 0; i < CALIB_TERMS; i++) {
+    sse -= 2 * coeff[i] * calib_atb[i];
+    for (uns j = 0; j < CALIB_TERMS; j++)
+      sse += coeff[i] * calib_ata[i][j] * coeff[j];
+  }
+  return sqrt(MAX2(sse, 0.0) / calib_samples);
+}
+
+void calibration_finish() {
+  if (calib_samples == 0) {
+    WARNING(0, "dram_analytic_calibrate: no DRAM reads completed, nothing to fit\n");
+    return;
+  }
+
+  // Gaussian elimination with partial pivoting; the small ridge leaves the offset of an outcome that never occurred
+  // at 0 instead of making the system singular.
+  double a[CALIB_TERMS][CALIB_TERMS + 1];
+  for (uns i = 0; i < CALIB_TERMS; i++) {
+    for (uns j = 0; j < CALIB_TERMS; j++)
+      a[i][j] = calib_ata[i][j] + (i == j ? 1e-6 : 0);
+    a[i][CALIB_TERMS] = calib_atb[i];
+  }
+  for (uns col = 0; col < CALIB_TERMS; col++) {
+    uns pivot = col;
+    for (uns i = col + 1; i < CALIB_TERMS; i++)
+      if (fabs(a[i][col]) > fabs(a[pivot][col]))
+        pivot = i;
+    for (uns j = 0; j <= CALIB_TERMS; j++)
+      swap(a[col][j], a[pivot][j]);
+    for (uns i = 0; i < CALIB_TERMS; i++) {
+      if (i == col)
+        continue;
+      double factor = a[i][col] / a[col][col];
+      for (uns j = col; j <= CALIB_TERMS; j++)
+        a[i][j] -= factor * a[col][j];
+    }
+  }
+
+  double current[CALIB_TERMS] = {(double)DRAM_ANALYTIC_HIT_OFFSET, (double)DRAM_ANALYTIC_CLOSED_OFFSET,
+                                 (double)DRAM_ANALYTIC_CONFLICT_OFFSET, DRAM_ANALYTIC_QUEUE_SCALE};
+  double fit[CALIB_TERMS];
+  for (uns i = 0; i < CALIB_TERMS; i++)
+    fit[i] = a[i][CALIB_TERMS] / a[i][i];
+  // offsets are integer parameters
+  for (uns i = 0; i < Dram_Analytic::NUM_OUTCOMES; i++)
+    fit[i] = round(fit[i]);
+
+  FILE* file = file_tag_fopen(OUTPUT_DIR, "dram_analytic.params", "w");
+  ASSERTM(0, file, "Could not open dram_analytic.params in %s\n", OUTPUT_DIR);
+  fprintf(file, "# Analytic DRAM model fit against Ramulator over %llu reads\n", calib_samples);
+  fprintf(file, "# read latency RMSE in DRAM cycles: %.2f with the current parameters, %.2f with the fit\n",
+          calibration_rmse(current), calibration_rmse(fit));
+  fprintf(file, "--dram_model                     analytic\n");
+  fprintf(file, "--dram_analytic_hit_offset       %d\n", (int)fit[Dram_Analytic::ROW_HIT]);
+  fprintf(file, "--dram_analytic_closed_offset    %d\n", (int)fit[Dram_Analytic::ROW_CLOSED]);
+  fprintf(file, "--dram_analytic_conflict_offset  %d\n", (int)fit[Dram_Analytic::ROW_CONFLICT]);
+  fprintf(file, "--dram_analytic_queue_scale      %.4f\n", fit[Dram_Analytic::NUM_OUTCOMES]);
+  fclose(file);
+}
+
 void ramulator_tick() {
-  wrapper->tick();
+  dram_cycle++;
+  if (analytic_only) {
+    while (!analytic_done.empty() && analytic_done.top().first <= dram_cycle) {
+      complete_read(analytic_done.top().second);
+      analytic_done.pop();
+    }
+  } else {
+    wrapper->tick();
+  }
 
   if (resp_queue.size() > 0) {
     if (try_completing_request(resp_queue.front().second))
@@ -294,19 +459,30 @@ void ramulator_tick() {
   }
 }
 
+/* Without Ramulator the chip organization comes straight from the parameters, as Ramulator derives it */
 int ramulator_get_chip_width() {
+  if (analytic_only)
+    return RAMULATOR_CHIP_WIDTH;
   return wrapper->get_chip_width();
 }
 
 int ramulator_get_chip_size() {
+  if (analytic_only)  // in Mbit
+    return (int)((uns64)RAMULATOR_ROWS * RAMULATOR_COLS * RAMULATOR_CHIP_WIDTH * RAMULATOR_BANKGROUPS *
+                     RAMULATOR_BANKS >>
+                 20);
   return wrapper->get_chip_size();
 }
 
 int ramulator_get_num_chips() {
+  if (analytic_only)
+    return BUS_WIDTH_IN_BYTES * 8 / RAMULATOR_CHIP_WIDTH * RAMULATOR_CHANNELS * RAMULATOR_RANKS;
   return wrapper->get_num_chips();
 }
 
 int ramulator_get_chip_row_buffer_size() {
+  if (analytic_only)
+    return RAMULATOR_COLS * RAMULATOR_CHIP_WIDTH;
   return wrapper->get_chip_row_buffer_size();
 }
 
@@ -44,9 +44,12 @@
 #include "debug/debug.param.h"
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
+#include "debug/host_prof.h"
 #include "debug/memview.h"
 #include "debug/pipeview.h"
 
+#include "libs/malloc_lib.h"
+
 #include "bp/bp.param.h"
 #include "core.param.h"
 #include "general.param.h"
@@ -568,6 +571,14 @@ void uop_sim() {
       if (DUMB_CORE_ON && DUMB_CORE == proc_id)
         continue;
       if (!retired_exit[proc_id]) {
+        Warmup_Inst warmup_inst;
+        if (operating_mode == WARMUP_MODE && WARMUP_FAST_PATH && model->warmup_inst_func && !DUMP_TRACE &&
+            frontend_warmup_inst(proc_id, &warmup_inst)) {
+          inst_count[proc_id]++;
+          ASSERTM(proc_id, !warmup_inst.exit, "Program ended before start of simulation\n");
+          model->warmup_inst_func(proc_id, &warmup_inst);
+          continue;
+        }
         do {
           frontend_fetch_op(proc_id, 0, &op);
 
@@ -689,6 +700,7 @@ void full_sim() {
     pipeview_init();
   if (MEMVIEW)
     memview_init();
+  host_prof_init();
 
   init_op_pool();
 
@@ -713,9 +725,11 @@ void full_sim() {
       break;
     freq_advance_time();
     sim_time = freq_time();
+    host_prof_cycle_begin();
     model->cycle_func();
     if (SIM_MODEL != DUMB_MODEL && DUMB_CORE_ON)
       model_table[DUMB_MODEL].cycle_func();
+    host_prof_cycle_end();
 
     if (DEBUG_MODEL && DEBUG_RANGE_COND(0) && ENABLE_GLOBAL_DEBUG_PRINT)
       model->debug_func();
@@ -809,6 +823,9 @@ void full_sim() {
     }
   }
 
+  if (SMALLOC_STATS)
+    smalloc_print_stats(mystdout);
+
   /* Tear down list backing allocations (free-list chunk pools). */
   if (td)
     destroy_list(&td->seq_op_list);
@@ -0,0 +1,76 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : stage_data.c
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Age-ordered slot index for Stage_Data
+ ***************************************************************************************/
+
+#include "stage_data.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+
+#include "op.h"
+
+/**************************************************************************************/
+/* stage_data_init_age_order: */
+
+void stage_data_init_age_order(Stage_Data* sd) {
+  ASSERT(0, sd->max_op_count > 0);
+  sd->age_order = (uns*)malloc(sizeof(uns) * sd->max_op_count);
+  sd->age_order_count = 0;
+}
+
+void stage_data_age_order_clear(Stage_Data* sd) {
+  sd->age_order_count = 0;
+}
+
+/**************************************************************************************/
+/* stage_data_age_order_insert: sd->ops[slot] was just set; op_nums are unique within a core */
+
+void stage_data_age_order_insert(Stage_Data* sd, uns slot) {
+  Op* op = sd->ops[slot];
+  int ii;
+
+  ASSERT(0, op && sd->age_order_count < sd->max_op_count);
+  for (ii = sd->age_order_count; ii > 0 && sd->ops[sd->age_order[ii - 1]]->op_num > op->op_num; ii--)
+    sd->age_order[ii] = sd->age_order[ii - 1];
+  sd->age_order[ii] = slot;
+  sd->age_order_count++;
+}
+
+/**************************************************************************************/
+/* stage_data_age_order_remove: call before or after clearing sd->ops[slot] */
+
+void stage_data_age_order_remove(Stage_Data* sd, uns slot) {
+  int ii;
+
+  for (ii = 0; ii < sd->age_order_count && sd->age_order[ii] != slot; ii++)
+    ;
+  ASSERT(0, ii < sd->age_order_count);
+  for (; ii < sd->age_order_count - 1; ii++)
+    sd->age_order[ii] = sd->age_order[ii + 1];
+  sd->age_order_count--;
+}
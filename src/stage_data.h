@@ -62,8 +62,20 @@ typedef struct Stage_Data_struct {
   int op_count;     /* number of ops in the stage */
   int max_op_count; /* max value of op_count */
   Op** ops;         /* array of ops in the stage */
+  uns* age_order;   /* optional: occupied slots, oldest op first (NULL if the stage does not keep it) */
+  int age_order_count;
 } Stage_Data;
 
+/**************************************************************************************/
+/* Prototypes */
+
+/* The age order is kept by stages that process their slots in program order. The stage reports every op it
+ * places in or takes out of a slot; ops must not change while they sit in a slot. */
+void stage_data_init_age_order(Stage_Data* sd);
+void stage_data_age_order_clear(Stage_Data* sd);
+void stage_data_age_order_insert(Stage_Data* sd, uns slot);
+void stage_data_age_order_remove(Stage_Data* sd, uns slot);
+
 /**************************************************************************************/
 
 #endif /* #ifndef __STAGE_H__ */
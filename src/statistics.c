@@ -77,6 +77,51 @@ static Flag stat_is_pref_stat(const Stat* stat) {
 
 static void dump_stats_array(uns8 proc_id, Flag final, Stat stat_array[], uns num_stats, uns8 bp_id);
 static void dump_alt_dfe_stats(uns8 proc_id, Flag final);
+static void dump_stats_binary(uns8 proc_id, Stat stat_array[], uns num_stats, uns8 bp_id);
+
+/**************************************************************************************/
+/* Columnar binary stats (STATS_BINARY)
+
+   All dumps are appended to a single <FILE_TAG>stats.bin file (see
+   bin/scarab_globals/scarab_stats_bin.py). The file starts with a schema:
+     Stats_Bin_Header
+     per stat: <uns8 type> <uns32 ratio_stat> <uns16 len> <name> <uns16 len> <file_name>
+   followed by one row per dump_stats_array call:
+     Stats_Bin_Row_Header
+     num_stats x <uns64 interval> and num_stats x <uns64 total>, where each
+     value holds the raw bits of the Stat count/value union. */
+
+#define STATS_BIN_VERSION 1
+
+#define STATS_BIN_ROW_PERIODIC 0x1
+#define STATS_BIN_ROW_ROI 0x2
+#define STATS_BIN_ROW_WARMUP 0x4
+
+typedef struct Stats_Bin_Header_struct {
+  char magic[8];  // "SCARABST"
+  uns32 version;
+  uns32 num_stats;
+  uns32 num_cores;
+  uns32 row_header_size;
+} Stats_Bin_Header;
+
+typedef struct Stats_Bin_Row_Header_struct {
+  uns32 proc_id;
+  uns16 bp_id;
+  uns16 flags;
+  uns32 first_stat;  // index of stat_array[0] in the schema
+  uns32 num_stats;
+  uns64 dump_id;  // period_ID or roi_dump_ID
+  uns64 cycle_count;
+  uns64 inst_count;
+  uns64 inst_count_fetched;
+  uns64 pret_inst_count;
+  uns64 period_cycles;
+  uns64 period_insts;
+} Stats_Bin_Row_Header;
+
+static FILE* stats_bin_file = NULL;
+static uns64* stats_bin_row = NULL;
 
 /**************************************************************************************/
 // init_global_stats_array:
@@ -253,6 +298,13 @@ static void dump_stats_array(uns8 proc_id, Flag final, Stat stat_array[], uns nu
       s->total_count += s->count;
   }
 
+  if (STATS_BINARY) {
+    dump_stats_binary(proc_id, stat_array, num_stats, bp_id);
+    // periodic and ROI dumps only go to the binary file
+    if (PERIODIC_DUMP || roi_dump_began)
+      goto reset;
+  }
+
   const char* last_file_name = NULL;
   FILE* file_stream = NULL;
   FILE* csv_file_stream = NULL;
@@ -526,6 +578,7 @@ static void dump_stats_array(uns8 proc_id, Flag final, Stat stat_array[], uns nu
     csv_file_stream = NULL;
   }
 
+reset:
   /* reset the interval counters */
   for (ii = 0; ii < num_stats; ii++) {
     Stat* s = &stat_array[ii];
@@ -559,6 +612,82 @@ static void dump_alt_dfe_stats(uns8 proc_id, Flag final) {
   }
 }
 
+/**************************************************************************************/
+/* dump_stats_binary: appends one row to the columnar stats file, opening it
+   and writing the schema on first use. */
+
+static void dump_stats_binary(uns8 proc_id, Stat stat_array[], uns num_stats, uns8 bp_id) {
+  uns ii;
+
+  if (!stats_bin_file) {
+    char buf[MAX_STR_LENGTH + 1];
+    snprintf(buf, MAX_STR_LENGTH + 1, "%s/%sstats.bin", OUTPUT_DIR, FILE_TAG);
+    stats_bin_file = fopen(buf, "wb");
+    ASSERTUM(0, stats_bin_file, "Couldn't open statistic output file '%s'.\n", buf);
+
+    Stats_Bin_Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "SCARABST", sizeof(header.magic));
+    header.version         = STATS_BIN_VERSION;
+    header.num_stats       = NUM_GLOBAL_STATS;
+    header.num_cores       = NUM_CORES;
+    header.row_header_size = sizeof(Stats_Bin_Row_Header);
+    fwrite(&header, sizeof(header), 1, stats_bin_file);
+
+    for (ii = 0; ii < NUM_GLOBAL_STATS; ii++) {
+      Stat* s      = &global_stat_array[0][ii];
+      uns8 type    = s->type;
+      uns32 ratio  = s->ratio_stat;
+      uns16 len    = strlen(s->name);
+      uns16 fn_len = strlen(s->file_name);
+      fwrite(&type, sizeof(type), 1, stats_bin_file);
+      fwrite(&ratio, sizeof(ratio), 1, stats_bin_file);
+      fwrite(&len, sizeof(len), 1, stats_bin_file);
+      fwrite(s->name, 1, len, stats_bin_file);
+      fwrite(&fn_len, sizeof(fn_len), 1, stats_bin_file);
+      fwrite(s->file_name, 1, fn_len, stats_bin_file);
+    }
+    stats_bin_row = (uns64*)malloc(2 * NUM_GLOBAL_STATS * sizeof(uns64));
+  }
+
+  Stat* base = bp_id ? alt_bp_stat_array[proc_id][bp_id] : global_stat_array[proc_id];
+  ASSERT(proc_id, stat_array >= base && stat_array + num_stats <= base + NUM_GLOBAL_STATS);
+
+  Stats_Bin_Row_Header row;
+  memset(&row, 0, sizeof(row));
+  row.proc_id            = proc_id;
+  row.bp_id              = bp_id;
+  row.first_stat         = stat_array - base;
+  row.num_stats          = num_stats;
+  row.cycle_count        = cycle_count;
+  row.inst_count         = inst_count[proc_id];
+  row.inst_count_fetched = inst_count_fetched[proc_id];
+  row.pret_inst_count    = pret_inst_count[proc_id];
+  row.period_cycles      = cycle_count - period_last_cycle_count;
+  row.period_insts       = inst_count_fetched[proc_id] - period_last_inst_count[proc_id];
+  if (PERIODIC_DUMP) {
+    row.flags |= STATS_BIN_ROW_PERIODIC;
+    row.dump_id = period_ID;
+  }
+  if (roi_dump_began) {
+    row.flags |= STATS_BIN_ROW_ROI;
+    row.dump_id = roi_dump_ID;
+  }
+  if (FULL_WARMUP && !warmup_dump_done[proc_id])
+    row.flags |= STATS_BIN_ROW_WARMUP;
+
+  /* count/value and total_count/total_value are 8-byte unions, so the raw bits
+     are copied regardless of the stat type */
+  for (ii = 0; ii < num_stats; ii++) {
+    memcpy(&stats_bin_row[ii], &stat_array[ii].count, sizeof(uns64));
+    memcpy(&stats_bin_row[num_stats + ii], &stat_array[ii].total_count, sizeof(uns64));
+  }
+
+  fwrite(&row, sizeof(row), 1, stats_bin_file);
+  fwrite(stats_bin_row, sizeof(uns64), 2 * num_stats, stats_bin_file);
+  fflush(stats_bin_file);
+}
+
 /**************************************************************************************/
 /* dump_stats: */
 
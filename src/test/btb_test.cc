@@ -0,0 +1,119 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+
+#include "bp/bp_targ_mech.h"
+#include "bp/btb.h"
+#include "libs/cache_lib.h"
+}
+
+#include "gtest/gtest.h"
+
+// Multi_Btb replaced one REPL_TRUE_LRU cache_lib cache per bank. Both are fed
+// the same address stream, and every lookup, tag alias and victim must match.
+
+struct Btb_Geometry {
+  uns entries;
+  uns assoc;
+  uns banks;
+  uns tag_bits;
+};
+
+class MultiBtbTest : public ::testing::TestWithParam<Btb_Geometry> {
+ protected:
+  void SetUp() override {
+    const Btb_Geometry& geom = GetParam();
+    sim_time = 0;
+    multi_btb_init_level(&btb, BTB_MAIN, geom.entries, geom.assoc, geom.banks, geom.tag_bits);
+    ref.resize(geom.banks);
+    for (Cache& bank : ref)
+      init_cache_impl(&bank, "REF-BTB", geom.entries / geom.banks, geom.assoc, 1, geom.tag_bits, sizeof(Addr),
+                      REPL_TRUE_LRU);
+  }
+
+  Addr* ref_access(Addr addr, Flag update_repl, Flag* tag_aliasing) {
+    Addr intra_bank_addr, line_addr;
+    uns bank_id = get_btb_bank_id(GetParam().banks, addr, &intra_bank_addr);
+    return (Addr*)cache_access_impl(&ref[bank_id], intra_bank_addr, &line_addr, tag_aliasing, update_repl);
+  }
+
+  Addr* ref_insert(Addr addr) {
+    Addr intra_bank_addr, line_addr, repl_line_addr;
+    uns bank_id = get_btb_bank_id(GetParam().banks, addr, &intra_bank_addr);
+    return (Addr*)cache_insert(&ref[bank_id], 0, intra_bank_addr, &line_addr, &repl_line_addr);
+  }
+
+  Multi_Btb btb = {};
+  std::vector<Cache> ref;
+};
+
+TEST_P(MultiBtbTest, MatchesTrueLruCache) {
+  std::mt19937 rng(11);
+  // More PCs than entries, so sets overflow, and sparse enough that narrow tags alias
+  std::uniform_int_distribution<Addr> pc_dist(0, 4 * GetParam().entries - 1);
+  std::bernoulli_distribution coin(0.5);
+  uns hits = 0, victims = 0;
+
+  for (int step = 0; step < 200000; step++) {
+    // Several lookups may share a cycle, which exercises the LRU tie-break
+    if (coin(rng))
+      sim_time++;
+    const Addr pc = 0x400000 + 13 * pc_dist(rng);
+    const Flag update_repl = coin(rng);
+
+    uns bank_id;
+    const Flag access_hit = multi_btb_access(&btb, BTB_MAIN, pc, FALSE, &bank_id) != NULL;
+    Multi_Btb_Probe probe;
+    multi_btb_probe(&btb, pc, update_repl, &probe);
+    ASSERT_EQ(access_hit, probe.hit[BTB_MAIN]) << "step " << step;
+    Flag ref_alias = FALSE;
+    Addr* ref_line = ref_access(pc, update_repl, &ref_alias);
+    ASSERT_EQ(probe.hit[BTB_MAIN], ref_line != NULL) << "lookup of 0x" << std::hex << pc << " at step " << std::dec
+                                                     << step;
+    if (ref_line) {
+      hits++;
+      ASSERT_EQ(probe.target[BTB_MAIN], *ref_line) << "step " << step;
+      ASSERT_EQ(probe.tag_alias[BTB_MAIN], ref_alias) << "step " << step;
+      continue;
+    }
+
+    // Each entry's target records the PC that inserted it, so the old target
+    // of the replaced way identifies the victim (0 for an invalid way).
+    Addr* line = multi_btb_insert(&btb, BTB_MAIN, pc);
+    ref_line = ref_insert(pc);
+    ASSERT_EQ(*line, *ref_line) << "victim for 0x" << std::hex << pc << " at step " << std::dec << step;
+    victims += *line != 0;
+    *line = pc;
+    *ref_line = pc;
+  }
+  EXPECT_GT(hits, 0u);
+  EXPECT_GT(victims, 0u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Geometries, MultiBtbTest,
+                         ::testing::Values(Btb_Geometry{4096, 4, 1, 64}, Btb_Geometry{1024, 8, 2, 64},
+                                           Btb_Geometry{256, 4, 4, 6}));
@@ -0,0 +1,169 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+extern "C" {
+#include "globals/global_types.h"
+
+#include "bp/bp.param.h"
+
+#include "bp/h2p_table.h"
+#include "statistics.h"
+}
+
+#include "gtest/gtest.h"
+
+// One set of four ways, so every PC competes for the same set. The overflow
+// hash is allocated at init, and each test picks the table mode it runs in.
+
+static constexpr uns ASSOC = 4;
+
+class H2PTableTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    H2P_TABLE_SETS = 1;
+    H2P_TABLE_ASSOC = ASSOC;
+    H2P_TABLE_EXACT = TRUE;
+    H2P_FILTER_ENTRIES = 16;
+    H2P_MIN_EXEC = 10;
+    H2P_MIN_MISPRED = 5;
+    H2P_MISPRED_RATIO_PERMIL = 100;
+    init_global_stats_array();
+    init_global_stats(0);
+    h2p_table_init();
+  }
+
+  void SetUp() override {
+    H2P_TABLE_EXACT = TRUE;  // so the reset also clears the overflow hash
+    reset_h2p_stats();
+    H2P_TABLE_EXACT = FALSE;
+    evictions_before = GET_STAT_EVENT(0, H2P_TABLE_EVICT);
+  }
+
+  static void retire(Addr pc, uns count, Recovery_Point recovery_point = RECOVER_AT_NONE) {
+    for (uns ii = 0; ii < count; ii++)
+      h2p_table_update(0, pc, recovery_point);
+  }
+
+  Counter evictions() const { return GET_STAT_EVENT(0, H2P_TABLE_EVICT) - evictions_before; }
+
+  Counter evictions_before;
+};
+
+TEST_F(H2PTableTest, InvalidWaysFillBeforeEviction) {
+  for (Addr pc = 0x1000; pc < 0x1000 + ASSOC; pc++)
+    retire(pc, 1);
+  EXPECT_EQ(evictions(), 0u);
+  for (Addr pc = 0x1000; pc < 0x1000 + ASSOC; pc++)
+    ASSERT_NE(h2p_table_lookup(pc), nullptr);
+}
+
+TEST_F(H2PTableTest, VictimIsLeastRecentlyUpdatedWay) {
+  retire(0xa, 1);
+  retire(0xb, 1);
+  retire(0xc, 1);
+  retire(0xd, 1);
+  retire(0xa, 1);  // 0xb is now the oldest
+  retire(0xe, 1);
+  EXPECT_EQ(evictions(), 1u);
+  EXPECT_EQ(h2p_table_lookup(0xb), nullptr);
+  for (Addr pc : {0xa, 0xc, 0xd, 0xe})
+    EXPECT_NE(h2p_table_lookup(pc), nullptr) << std::hex << pc;
+
+  retire(0xf, 1);  // then 0xc
+  EXPECT_EQ(evictions(), 2u);
+  EXPECT_EQ(h2p_table_lookup(0xc), nullptr);
+  EXPECT_EQ(h2p_table_lookup(0xa)->exec_count, 2u);
+}
+
+TEST_F(H2PTableTest, CountsMispredictionsPerStage) {
+  retire(0x40, 10);
+  retire(0x40, 6, RECOVER_AT_FE);
+  retire(0x40, 2, RECOVER_AT_EXEC);
+  const Branch_PC_Stats* s = h2p_table_lookup(0x40);
+  ASSERT_NE(s, nullptr);
+  EXPECT_EQ(s->exec_count, 18u);
+  EXPECT_EQ(s->mispred_count, 8u);
+  EXPECT_EQ(s->mispred_at_fe_count, 6u);
+  EXPECT_EQ(s->mispred_at_exec_count, 2u);
+  EXPECT_TRUE(is_h2p(0x40));
+  EXPECT_TRUE(is_h2p_at_fe(0x40));
+  EXPECT_FALSE(is_h2p_at_decode(0x40));
+  EXPECT_FALSE(is_h2p_at_exec(0x40));  // below H2P_MIN_MISPRED
+}
+
+TEST_F(H2PTableTest, FilterFollowsUpdates) {
+  EXPECT_FALSE(is_h2p(0x40));  // caches "not tracked"
+  retire(0x40, 10);
+  EXPECT_FALSE(is_h2p(0x40));
+  retire(0x40, 5, RECOVER_AT_DECODE);
+  EXPECT_TRUE(is_h2p(0x40));
+  EXPECT_TRUE(is_h2p_at_decode(0x40));
+}
+
+TEST_F(H2PTableTest, EvictionForgetsH2P) {
+  retire(0x40, 10, RECOVER_AT_EXEC);
+  ASSERT_TRUE(is_h2p_at_exec(0x40));
+  for (Addr pc = 0x1000; pc < 0x1000 + ASSOC; pc++)
+    retire(pc, 1);
+  EXPECT_EQ(h2p_table_lookup(0x40), nullptr);
+  EXPECT_FALSE(is_h2p_at_exec(0x40));
+}
+
+TEST_F(H2PTableTest, ExactModeKeepsEvictedCounts) {
+  H2P_TABLE_EXACT = TRUE;
+  retire(0x40, 10, RECOVER_AT_EXEC);
+  ASSERT_TRUE(is_h2p_at_exec(0x40));
+  for (Addr pc = 0x1000; pc < 0x1000 + ASSOC; pc++)
+    retire(pc, 1);
+  EXPECT_EQ(evictions(), 1u);
+
+  // Spilled, but still exact and still H2P
+  const Branch_PC_Stats* s = h2p_table_lookup(0x40);
+  ASSERT_NE(s, nullptr);
+  EXPECT_EQ(s->exec_count, 10u);
+  EXPECT_TRUE(is_h2p_at_exec(0x40));
+
+  // Executing again brings the counts back into the set
+  retire(0x40, 1);
+  EXPECT_EQ(evictions(), 2u);
+  EXPECT_EQ(h2p_table_lookup(0x40)->exec_count, 11u);
+  EXPECT_EQ(h2p_table_lookup(0x40)->mispred_at_exec_count, 10u);
+}
+
+TEST_F(H2PTableTest, ResetForgetsEveryPC) {
+  H2P_TABLE_EXACT = TRUE;
+  for (Addr pc = 0x40; pc < 0x40 + 2 * ASSOC; pc++)
+    retire(pc, 10, RECOVER_AT_EXEC);
+  ASSERT_TRUE(is_h2p(0x40));
+  ASSERT_TRUE(is_h2p(0x40 + 2 * ASSOC - 1));
+
+  reset_h2p_stats();
+  for (Addr pc = 0x40; pc < 0x40 + 2 * ASSOC; pc++) {
+    EXPECT_EQ(h2p_table_lookup(pc), nullptr) << std::hex << pc;
+    EXPECT_FALSE(is_h2p(pc)) << std::hex << pc;
+  }
+
+  // Every way is free again
+  Counter evictions_at_reset = evictions();
+  for (Addr pc = 0x1000; pc < 0x1000 + ASSOC; pc++)
+    retire(pc, 1);
+  EXPECT_EQ(evictions(), evictions_at_reset);
+}
@@ -0,0 +1,186 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "frontend/pt_memtrace/memtrace_trace_reader_memtrace.h"
+#include "pin/pin_lib/x86_decoder.h"
+
+#include "general.param.h"
+
+#include "gtest/gtest.h"
+#include "trace_entry.h"
+
+// Drives TraceReaderMemtrace over a generated drmemtrace file: a loop of NOPs
+// closed by a jmp, with encodings embedded. The decode cache is bounded below
+// the number of InstInfos the reader holds, so every eviction has to skip
+// entries that are still referenced by its lookahead buffer.
+
+using namespace dynamorio::drmemtrace;
+
+static constexpr addr_t CODE_BASE = 0x400000;
+static constexpr int NUM_SLOTS = 12;
+static constexpr uint64_t TID = 1;
+static constexpr uint64_t PID = 1;
+
+struct Expected_Inst {
+  uint64_t pc;
+  std::vector<uint8_t> bytes;
+};
+
+class MemtraceDecodeCacheTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { init_x86_decoder(nullptr); }
+
+  void SetUp() override {
+    saved_cache_entries = MEMTRACE_DECODE_CACHE_ENTRIES;
+    trace_path = ::testing::TempDir() + "memtrace_decode_cache_test.trace.gz";
+    // 1, 2 and 3 byte NOPs, then a jmp back to the first slot
+    addr_t pc = CODE_BASE;
+    for (int slot = 0; slot < NUM_SLOTS; slot++) {
+      static const std::vector<uint8_t> nops[] = {{0x90}, {0x66, 0x90}, {0x0f, 0x1f, 0x00}};
+      code.push_back({pc, nops[slot % 3]});
+      pc += code.back().bytes.size();
+    }
+    code.push_back({pc, {0xeb, (uint8_t)(CODE_BASE - (pc + 2))}});
+  }
+
+  void TearDown() override {
+    MEMTRACE_DECODE_CACHE_ENTRIES = saved_cache_entries;
+    remove(trace_path.c_str());
+  }
+
+  void put(unsigned short type, unsigned short size, addr_t addr) {
+    trace_entry_t entry = {};
+    entry.type = type;
+    entry.size = size;
+    entry.addr = addr;
+    entries.push_back(entry);
+  }
+
+  // Encodings are emitted the first time a PC executes and whenever its bytes
+  // change, as raw2trace does; the reader flags the latter as encoding_is_new.
+  void put_inst(const Expected_Inst& inst, bool with_encoding) {
+    if (with_encoding) {
+      trace_entry_t entry = {};
+      entry.type = TRACE_TYPE_ENCODING;
+      entry.size = inst.bytes.size();
+      std::copy(inst.bytes.begin(), inst.bytes.end(), entry.encoding);
+      entries.push_back(entry);
+    }
+    const bool is_jmp = inst.bytes[0] == 0xeb;
+    put(is_jmp ? TRACE_TYPE_INSTR_DIRECT_JUMP : TRACE_TYPE_INSTR, inst.bytes.size(), inst.pc);
+    expected.push_back(inst);
+  }
+
+  // Runs the loop `iterations` times. At `smc_iteration` the 2-byte NOP in
+  // slot 1 is rewritten to a same-length mov.
+  void write_trace(int iterations, int smc_iteration = -1) {
+    put(TRACE_TYPE_HEADER, 0, TRACE_ENTRY_VERSION);
+    put(TRACE_TYPE_MARKER, TRACE_MARKER_TYPE_VERSION, TRACE_ENTRY_VERSION);
+    put(TRACE_TYPE_MARKER, TRACE_MARKER_TYPE_FILETYPE, OFFLINE_FILE_TYPE_ENCODINGS | OFFLINE_FILE_TYPE_ARCH_X86_64);
+    put(TRACE_TYPE_THREAD, sizeof(thread_id_t), TID);
+    put(TRACE_TYPE_PID, sizeof(process_id_t), PID);
+    put(TRACE_TYPE_MARKER, TRACE_MARKER_TYPE_CACHE_LINE_SIZE, 64);
+    for (int iter = 0; iter < iterations; iter++) {
+      if (iter == smc_iteration)
+        code[1].bytes = {0x89, 0xc0};
+      for (const Expected_Inst& inst : code)
+        put_inst(inst, iter == 0 || (iter == smc_iteration && inst.pc == code[1].pc));
+    }
+    put(TRACE_TYPE_THREAD_EXIT, sizeof(thread_id_t), TID);
+    put(TRACE_TYPE_FOOTER, 0, 0);
+
+    gzFile file = gzopen(trace_path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(gzwrite(file, entries.data(), entries.size() * sizeof(trace_entry_t)),
+              (int)(entries.size() * sizeof(trace_entry_t)));
+    gzclose(file);
+  }
+
+  static void expect_decode(const InstInfo& inst, const Expected_Inst& exp, size_t seq) {
+    ASSERT_TRUE(inst.valid) << "seq " << seq;
+    ASSERT_EQ(inst.pc, exp.pc) << "seq " << seq;
+    uint64_t lsb = 0;
+    for (uint8_t byte : exp.bytes)
+      lsb = (lsb << 8) + byte;
+    ASSERT_EQ(inst.info->instruction_addr, exp.pc) << "decode of seq " << seq << " was overwritten";
+    ASSERT_EQ(inst.info->size, exp.bytes.size()) << "decode of seq " << seq << " was overwritten";
+    ASSERT_EQ(inst.info->inst_binary_lsb, lsb) << "decode of seq " << seq << " was overwritten";
+  }
+
+  // Consumes the whole trace, checking the returned instruction and every
+  // lookahead entry still points at its own decode after each step.
+  void run_reader(TraceReaderMemtrace& reader, uint32_t buf_size) {
+    for (size_t seq = 0; seq < expected.size(); seq++) {
+      const InstInfo* inst = reader.nextInstruction();
+      expect_decode(*inst, expected[seq], seq);
+      for (uint32_t idx = 1; idx <= buf_size && seq + idx < expected.size(); idx++) {
+        TraceReader::bufferEntry ref;
+        ASSERT_EQ(reader.peekInstructionAtIndex(idx, ref), TraceReader::ENTRY_VALID);
+        expect_decode(*ref, expected[seq + idx], seq + idx);
+      }
+    }
+    EXPECT_FALSE(reader.nextInstruction()->valid);
+  }
+
+  uns saved_cache_entries;
+  std::string trace_path;
+  std::vector<Expected_Inst> code;
+  std::vector<trace_entry_t> entries;
+  std::vector<Expected_Inst> expected;
+};
+
+TEST_F(MemtraceDecodeCacheTest, BufferedEntriesSurviveEviction) {
+  // 4 cached decodes for 13 PCs, 9 of them held by the buffer at any time
+  MEMTRACE_DECODE_CACHE_ENTRIES = 4;
+  write_trace(100);
+  TraceReaderMemtrace reader(trace_path, 8);
+  ASSERT_FALSE(!reader);
+  run_reader(reader, 8);
+  EXPECT_GT(reader.decodeCacheEvictions(), 0u);
+}
+
+TEST_F(MemtraceDecodeCacheTest, NewEncodingKeepsBufferedDecode) {
+  // The buffer spans more than one loop iteration, so the old decode of the
+  // rewritten slot is still buffered when its new encoding arrives.
+  MEMTRACE_DECODE_CACHE_ENTRIES = 0;
+  write_trace(20, 10);
+  TraceReaderMemtrace reader(trace_path, 16);
+  ASSERT_FALSE(!reader);
+  run_reader(reader, 16);
+  EXPECT_EQ(reader.decodeCacheInvalidations(), 1u);
+}
+
+TEST_F(MemtraceDecodeCacheTest, UnboundedCacheNeverEvicts) {
+  MEMTRACE_DECODE_CACHE_ENTRIES = 0;
+  write_trace(20);
+  TraceReaderMemtrace reader(trace_path, 8);
+  ASSERT_FALSE(!reader);
+  run_reader(reader, 8);
+  EXPECT_EQ(reader.decodeCacheEvictions(), 0u);
+}
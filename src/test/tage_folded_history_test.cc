@@ -0,0 +1,94 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <random>
+#include <vector>
+
+#include "../bp/template_lib/tage.h"
+#include "gtest/gtest.h"
+
+// Compares Folded_History_Bank against the classic one-fold-at-a-time update.
+// The Makefile builds this file once per code path (AVX2, SSE2, scalar).
+
+static constexpr int HISTORY_SIZE = 3000;
+static constexpr int NUM_FOLDS = 13;  // not a multiple of the lane width, so padding lanes are exercised
+static constexpr int MAX_IN_FLIGHT = 1;
+
+// Seznec's per-table folded history
+struct Reference_Fold {
+  int original_length;
+  int compressed_length;
+  int outpoint;
+  int64_t value = 0;
+
+  Reference_Fold(int _original_length, int _compressed_length)
+      : original_length(_original_length),
+        compressed_length(_compressed_length),
+        outpoint(_original_length % _compressed_length) {}
+
+  void update(const Long_History_Register<HISTORY_SIZE>& history) {
+    value = (value << 1) ^ history[0];
+    value ^= (int64_t)history[original_length] << outpoint;
+    value ^= value >> compressed_length;
+    value &= (1 << compressed_length) - 1;
+  }
+};
+
+class FoldedHistoryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::uniform_int_distribution<int> original_dist(1, HISTORY_SIZE - 1);
+    std::uniform_int_distribution<int> compressed_dist(1, 30);
+    for (int fold = 0; fold < NUM_FOLDS; fold++) {
+      refs.emplace_back(original_dist(rng), compressed_dist(rng));
+      bank.init_fold(fold, refs.back().original_length, refs.back().compressed_length);
+    }
+  }
+
+  void push(bool bit) {
+    history.push_bit(bit);
+    bank.update(history);
+    for (Reference_Fold& ref : refs)
+      ref.update(history);
+  }
+
+  void expect_match(int step) {
+    for (int fold = 0; fold < NUM_FOLDS; fold++) {
+      ASSERT_EQ(bank.get_value(fold), refs[fold].value)
+          << "fold " << fold << " (" << refs[fold].original_length << " -> " << refs[fold].compressed_length
+          << ") diverged at step " << step;
+    }
+  }
+
+  std::mt19937 rng{12345};
+  Long_History_Register<HISTORY_SIZE> history{MAX_IN_FLIGHT};
+  Folded_History_Bank<HISTORY_SIZE, NUM_FOLDS> bank;
+  std::vector<Reference_Fold> refs;
+};
+
+TEST_F(FoldedHistoryTest, RandomHistoryMatchesScalarFold) {
+  std::bernoulli_distribution bit_dist(0.5);
+  for (int step = 0; step < 4 * HISTORY_SIZE; step++) {
+    push(bit_dist(rng));
+    history.retire(1);
+    expect_match(step);
+  }
+}
@@ -0,0 +1,123 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <random>
+
+#include "../bp/template_lib/tage.h"
+#include "gtest/gtest.h"
+
+// Misprediction repair in Tage::global_recover: rewinding the history register
+// and restoring the folded history checkpoint must leave the bank exactly as if
+// the wrong-path branches had never been pushed.
+
+static constexpr int HISTORY_SIZE = 3000;
+static constexpr int NUM_FOLDS = 13;
+static constexpr int MAX_IN_FLIGHT = 64;
+
+struct History_State {
+  Long_History_Register<HISTORY_SIZE> history{MAX_IN_FLIGHT};
+  Folded_History_Bank<HISTORY_SIZE, NUM_FOLDS> bank;
+
+  void push(bool bit) {
+    history.push_bit(bit);
+    bank.update(history);
+  }
+};
+
+class HistoryCheckpointTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::uniform_int_distribution<int> original_dist(1, HISTORY_SIZE - 1);
+    std::uniform_int_distribution<int> compressed_dist(1, 30);
+    for (int fold = 0; fold < NUM_FOLDS; fold++) {
+      const int original_length = original_dist(rng);
+      const int compressed_length = compressed_dist(rng);
+      speculative.bank.init_fold(fold, original_length, compressed_length);
+      correct_path.bank.init_fold(fold, original_length, compressed_length);
+    }
+  }
+
+  // Branches on the correct path go to both states and retire immediately.
+  void push_correct(bool bit) {
+    speculative.push(bit);
+    speculative.history.retire(1);
+    correct_path.push(bit);
+    correct_path.history.retire(1);
+  }
+
+  void expect_match(int round) {
+    for (int fold = 0; fold < NUM_FOLDS; fold++) {
+      ASSERT_EQ(speculative.bank.get_value(fold), correct_path.bank.get_value(fold))
+          << "fold " << fold << " diverged in round " << round;
+    }
+  }
+
+  std::mt19937 rng{2024};
+  History_State speculative;
+  History_State correct_path;
+};
+
+TEST_F(HistoryCheckpointTest, RestoreUndoesFlushedBranches) {
+  std::bernoulli_distribution bit_dist(0.5);
+  std::uniform_int_distribution<int> flush_dist(1, MAX_IN_FLIGHT);
+  for (int step = 0; step < 2 * HISTORY_SIZE; step++)
+    push_correct(bit_dist(rng));
+
+  for (int round = 0; round < 200; round++) {
+    Folded_History_Bank<HISTORY_SIZE, NUM_FOLDS>::Checkpoint checkpoint;
+    speculative.bank.save(&checkpoint);
+
+    const int num_flushed = flush_dist(rng);
+    for (int ii = 0; ii < num_flushed; ii++)
+      speculative.push(bit_dist(rng));
+    speculative.history.rewind(num_flushed);
+    speculative.bank.restore(checkpoint);
+    expect_match(round);
+
+    // Later branches must fold against the rewound history
+    for (int ii = 0; ii < 16; ii++) {
+      push_correct(bit_dist(rng));
+      expect_match(round);
+    }
+  }
+}
+
+TEST_F(HistoryCheckpointTest, NestedCheckpointsRestoreToTheirOwnBranch) {
+  std::bernoulli_distribution bit_dist(0.5);
+  for (int step = 0; step < HISTORY_SIZE; step++)
+    push_correct(bit_dist(rng));
+
+  // Checkpoint every in-flight branch, then recover to the oldest mispredicted one
+  Folded_History_Bank<HISTORY_SIZE, NUM_FOLDS>::Checkpoint checkpoints[8];
+  for (int ii = 0; ii < 8; ii++) {
+    speculative.bank.save(&checkpoints[ii]);
+    speculative.push(bit_dist(rng));
+  }
+  speculative.history.rewind(8 - 2);
+  speculative.bank.restore(checkpoints[2]);
+
+  // The first two in-flight branches stay; replay them on the correct path
+  Long_History_Register<HISTORY_SIZE>& history = speculative.history;
+  const bool second = history[0], first = history[1];
+  correct_path.push(first);
+  correct_path.push(second);
+  expect_match(0);
+}
@@ -0,0 +1,306 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+// These carry their own C++ guards and pull in C++ headers
+#include "decoupled_frontend.h"
+#include "icache_stage.h"
+
+extern "C" {
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+
+#include "libs/cache_lib.h"
+
+#include "cmp_model.h"
+#include "dcache_stage.h"
+#include "frontend/frontend.h"
+#include "model.h"
+#include "param_parser.h"
+#include "sim.h"
+}
+
+#include "gtest/gtest.h"
+#include "trace_entry.h"
+
+// Warms the same drmemtrace file through uop_sim twice, once with
+// WARMUP_FAST_PATH and once without, and checks that both leave every icache
+// and dcache line in the same state. The simulator keeps its state in
+// globals, so each run happens in its own child process.
+//
+// The code is 32 blocks of loads, stores and a NOP, 4KB apart so they share
+// an icache set, each ending in a jmp to the next. The jmps take the uop path
+// in both runs, so the fast path is interleaved with the slow one. The data
+// addresses mix a hot region with a stream larger than the dcache, which
+// exercises misses, dirty evictions and LRU updates.
+
+using namespace dynamorio::drmemtrace;
+
+static constexpr addr_t CODE_BASE = 0x400000;
+static constexpr addr_t BLOCK_STRIDE = 0x1000;
+static constexpr int NUM_BLOCKS = 32;
+static constexpr addr_t DATA_BASE = 0x10000000;
+static constexpr int ITERATIONS = 200;
+static constexpr int WARMUP_INSTS = 25000;  // before the end of the trace
+static constexpr uint64_t TID = 1;
+static constexpr uint64_t PID = 1;
+
+struct Code_Inst {
+  addr_t pc;
+  std::vector<uint8_t> bytes;
+  unsigned short type;
+  int mem_type;  // 0 none, 1 load, 2 store
+};
+
+struct Line_State {
+  uint64_t cache;  // 0 icache, 1 dcache
+  uint64_t set;
+  uint64_t way;
+  uint64_t valid;
+  uint64_t tag;
+  uint64_t base;
+  uint64_t last_access_time;
+  uint64_t insertion_time;
+  uint64_t dirty;
+  uint64_t read_count;
+  uint64_t write_count;
+
+  bool operator==(const Line_State& other) const {
+    return valid == other.valid && tag == other.tag && base == other.base &&
+           last_access_time == other.last_access_time && insertion_time == other.insertion_time &&
+           dirty == other.dirty && read_count == other.read_count && write_count == other.write_count;
+  }
+};
+
+static uint64_t fast_path_insts;
+
+static void counting_warmup_inst(uns proc_id, Warmup_Inst* inst) {
+  fast_path_insts++;
+  cmp_warmup_inst(proc_id, inst);
+}
+
+static void snapshot_cache(uint64_t cache_id, const Cache* cache, std::vector<Line_State>* lines) {
+  for (uns set = 0; set < cache->num_sets; set++) {
+    for (uns way = 0; way < cache->assoc; way++) {
+      const Cache_Entry* entry = &cache->entries[set][way];
+      Line_State line = {cache_id, set, way, entry->valid};
+      if (entry->valid) {
+        line.tag = entry->tag;
+        line.base = entry->base;
+        line.last_access_time = entry->last_access_time;
+        line.insertion_time = entry->insertion_time;
+        if (cache_id == 1) {
+          const Dcache_Data* data = (const Dcache_Data*)entry->data;
+          line.dirty = data->dirty;
+          line.read_count = data->read_count[0];
+          line.write_count = data->write_count[0];
+        }
+      }
+      lines->push_back(line);
+    }
+  }
+}
+
+static bool write_all(int fd, const void* buf, size_t size) {
+  const char* ptr = (const char*)buf;
+  while (size) {
+    ssize_t ret = write(fd, ptr, size);
+    if (ret <= 0)
+      return false;
+    ptr += ret;
+    size -= ret;
+  }
+  return true;
+}
+
+class WarmupFastPathTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    trace_path = ::testing::TempDir() + "warmup_fast_path_test.trace.gz";
+    for (int block = 0; block < NUM_BLOCKS; block++) {
+      static const Code_Inst body[] = {
+          {0, {0x8b, 0x03}, TRACE_TYPE_INSTR, 1},  // mov eax, [rbx]
+          {0, {0x89, 0x03}, TRACE_TYPE_INSTR, 2},  // mov [rbx], eax
+          {0, {0x90}, TRACE_TYPE_INSTR, 0},        // nop
+          {0, {0x8b, 0x03}, TRACE_TYPE_INSTR, 1},  // mov eax, [rbx]
+      };
+      addr_t pc = CODE_BASE + block * BLOCK_STRIDE;
+      for (Code_Inst inst : body) {
+        inst.pc = pc;
+        pc += inst.bytes.size();
+        code.push_back(inst);
+      }
+      const addr_t target = CODE_BASE + ((block + 1) % NUM_BLOCKS) * BLOCK_STRIDE;
+      const uint32_t rel = (uint32_t)(target - (pc + 5));
+      code.push_back({pc,
+                      {0xe9, (uint8_t)rel, (uint8_t)(rel >> 8), (uint8_t)(rel >> 16), (uint8_t)(rel >> 24)},
+                      TRACE_TYPE_INSTR_DIRECT_JUMP,
+                      0});
+    }
+    write_trace();
+  }
+
+  void TearDown() override { remove(trace_path.c_str()); }
+
+  void put(std::vector<trace_entry_t>* entries, unsigned short type, unsigned short size, addr_t addr) {
+    trace_entry_t entry = {};
+    entry.type = type;
+    entry.size = size;
+    entry.addr = addr;
+    entries->push_back(entry);
+  }
+
+  void write_trace() {
+    std::vector<trace_entry_t> entries;
+    std::mt19937 rng(7);
+    std::bernoulli_distribution hot(0.5);
+    std::uniform_int_distribution<addr_t> hot_line(0, 63);
+    std::uniform_int_distribution<addr_t> cold_line(64, 16383);
+    std::uniform_int_distribution<addr_t> offset(0, 7);
+
+    put(&entries, TRACE_TYPE_HEADER, 0, TRACE_ENTRY_VERSION);
+    put(&entries, TRACE_TYPE_MARKER, TRACE_MARKER_TYPE_VERSION, TRACE_ENTRY_VERSION);
+    put(&entries, TRACE_TYPE_MARKER, TRACE_MARKER_TYPE_FILETYPE,
+        OFFLINE_FILE_TYPE_ENCODINGS | OFFLINE_FILE_TYPE_ARCH_X86_64);
+    put(&entries, TRACE_TYPE_THREAD, sizeof(thread_id_t), TID);
+    put(&entries, TRACE_TYPE_PID, sizeof(process_id_t), PID);
+    put(&entries, TRACE_TYPE_MARKER, TRACE_MARKER_TYPE_CACHE_LINE_SIZE, 64);
+    for (int iter = 0; iter < ITERATIONS; iter++) {
+      for (const Code_Inst& inst : code) {
+        if (iter == 0) {
+          trace_entry_t entry = {};
+          entry.type = TRACE_TYPE_ENCODING;
+          entry.size = inst.bytes.size();
+          std::copy(inst.bytes.begin(), inst.bytes.end(), entry.encoding);
+          entries.push_back(entry);
+        }
+        put(&entries, inst.type, inst.bytes.size(), inst.pc);
+        if (inst.mem_type) {
+          const addr_t line = hot(rng) ? hot_line(rng) : cold_line(rng);
+          put(&entries, inst.mem_type == 1 ? TRACE_TYPE_READ : TRACE_TYPE_WRITE, 4,
+              DATA_BASE + line * 64 + offset(rng) * 8);
+        }
+      }
+    }
+    put(&entries, TRACE_TYPE_THREAD_EXIT, sizeof(thread_id_t), TID);
+    put(&entries, TRACE_TYPE_FOOTER, 0, 0);
+
+    gzFile file = gzopen(trace_path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(gzwrite(file, entries.data(), entries.size() * sizeof(trace_entry_t)),
+              (int)(entries.size() * sizeof(trace_entry_t)));
+    gzclose(file);
+  }
+
+  // Runs the warmup in a child and reads back its cache lines. The first
+  // record carries the number of fast path instructions in its tag.
+  std::vector<Line_State> warmup(bool fast_path, uint64_t* fast_insts) {
+    char dir_template[] = "/tmp/warmup_fast_path_test.XXXXXX";
+    const char* output_dir = mkdtemp(dir_template);
+    EXPECT_NE(output_dir, nullptr);
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(fds[0]);
+      const std::string warmup_insts = std::to_string(WARMUP_INSTS);
+      const char* args[] = {"scarab",           "--frontend",      "memtrace",
+                            "--cbp_trace_r0",   trace_path.c_str(), "--warmup",
+                            warmup_insts.c_str(), "--warmup_fast_path", fast_path ? "1" : "0",
+                            "--output_dir",     output_dir,        nullptr};
+      char** argv = get_params(sizeof(args) / sizeof(args[0]) - 1, (char**)args);
+      char* envp[] = {nullptr};
+      init_global(argv, envp);
+      model_table[CMP_MODEL].warmup_inst_func = counting_warmup_inst;
+      model = &model_table[SIM_MODEL];
+      model->init_func(WARMUP_MODE);
+      operating_mode = WARMUP_MODE;
+      uop_sim();
+
+      std::vector<Line_State> lines(1);
+      lines[0].tag = fast_path_insts;
+      snapshot_cache(0, &cmp_model.icache_stage[0].icache, &lines);
+      snapshot_cache(1, &cmp_model.dcache_stage[0].dcache, &lines);
+      _exit(write_all(fds[1], lines.data(), lines.size() * sizeof(Line_State)) ? 0 : 1);
+    }
+    close(fds[1]);
+
+    std::vector<Line_State> lines;
+    Line_State line;
+    while (read(fds[0], &line, sizeof(line)) == sizeof(line))
+      lines.push_back(line);
+    close(fds[0]);
+    int status;
+    EXPECT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0) << "warmup child failed, status " << status;
+    if (lines.empty())
+      return lines;
+    *fast_insts = lines[0].tag;
+    lines.erase(lines.begin());
+    return lines;
+  }
+
+  std::string trace_path;
+  std::vector<Code_Inst> code;
+};
+
+TEST_F(WarmupFastPathTest, CachesMatchUopWarmup) {
+  uint64_t slow_fast_insts = 0, fast_fast_insts = 0;
+  const std::vector<Line_State> slow = warmup(false, &slow_fast_insts);
+  const std::vector<Line_State> fast = warmup(true, &fast_fast_insts);
+  ASSERT_FALSE(slow.empty());
+  ASSERT_EQ(slow.size(), fast.size());
+
+  // Only the non-jmp instructions can take the fast path
+  EXPECT_EQ(slow_fast_insts, 0u);
+  EXPECT_GT(fast_fast_insts, WARMUP_INSTS / 2u);
+
+  uns valid[2] = {}, dirty = 0;
+  for (size_t ii = 0; ii < slow.size(); ii++) {
+    const Line_State& s = slow[ii];
+    const Line_State& f = fast[ii];
+    ASSERT_TRUE(s == f) << (s.cache ? "dcache" : "icache") << " set " << s.set << " way " << s.way
+                        << ": base 0x" << std::hex << s.base << " vs 0x" << f.base << std::dec << ", last access "
+                        << s.last_access_time << " vs " << f.last_access_time << ", dirty " << s.dirty << " vs "
+                        << f.dirty << ", reads " << s.read_count << " vs " << f.read_count << ", writes "
+                        << s.write_count << " vs " << f.write_count;
+    valid[s.cache] += s.valid;
+    dirty += s.dirty;
+  }
+  // The fixture has to reach the states being compared
+  EXPECT_GT(valid[0], 0u);
+  EXPECT_GT(valid[1], 0u);
+  EXPECT_GT(dirty, 0u);
+}
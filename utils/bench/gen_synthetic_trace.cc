@@ -0,0 +1,194 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : utils/bench/gen_synthetic_trace.cc
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Writes small deterministic synthetic traces for the trace
+ *                frontend (--frontend trace), used by the throughput benchmarks.
+ *
+ *                mem       pointer-chasing loads over a large footprint
+ *                branch    loop around a data-dependent, random conditional branch
+ *                frontend  chain of basic blocks spread over a multi-MB code footprint
+ ***************************************************************************************/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "isa/isa.h"
+#include "table_info.h"
+
+#include "ctype_pin_inst.h"
+
+static const uint64_t CODE_BASE = 0x400000;
+static const uint64_t DATA_BASE = 0x10000000;
+static const uint8_t INST_SIZE = 4;
+
+static FILE* out;
+static uint64_t num_written;
+static uint64_t lcg_state = 0x2545F4914F6CDD1DULL;
+
+static uint64_t lcg_next() {
+  lcg_state = lcg_state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return lcg_state >> 17;
+}
+
+static ctype_pin_inst make_inst(uint64_t addr, uint8_t op_type, const char* iclass) {
+  ctype_pin_inst pi;
+  init_ctype_pin_inst(&pi);
+  pi.instruction_addr = addr;
+  pi.instruction_next_addr = addr + INST_SIZE;
+  pi.size = INST_SIZE;
+  pi.inst_binary_lsb = addr;  // unique encoding per static instruction
+  pi.op_type = op_type;
+  pi.num_simd_lanes = 1;
+  pi.lane_width_bytes = 8;
+  strncpy(pi.pin_iclass, iclass, sizeof(pi.pin_iclass) - 1);
+  return pi;
+}
+
+static ctype_pin_inst make_alu(uint64_t addr, Reg_Id src, Reg_Id dst) {
+  ctype_pin_inst pi = make_inst(addr, OP_IADD, "ADD");
+  pi.num_src_regs = 2;
+  pi.src_regs[0] = src;
+  pi.src_regs[1] = dst;
+  pi.num_dst_regs = 1;
+  pi.dst_regs[0] = dst;
+  return pi;
+}
+
+static ctype_pin_inst make_load(uint64_t addr, Reg_Id base, Reg_Id dst, uint64_t vaddr) {
+  ctype_pin_inst pi = make_inst(addr, OP_MOV, "MOV");
+  pi.is_move = 1;
+  pi.num_ld = 1;
+  pi.ld_size = 8;
+  pi.ld_vaddr[0] = vaddr;
+  pi.num_ld1_addr_regs = 1;
+  pi.ld1_addr_regs[0] = base;
+  pi.num_dst_regs = 1;
+  pi.dst_regs[0] = dst;
+  return pi;
+}
+
+static ctype_pin_inst make_branch(uint64_t addr, uint8_t cf_type, Reg_Id src, uint64_t target, bool taken) {
+  ctype_pin_inst pi = make_inst(addr, OP_IADD, cf_type == CF_CBR ? "JNZ" : "JMP");
+  pi.cf_type = cf_type;
+  if (cf_type == CF_CBR) {
+    pi.num_src_regs = 1;
+    pi.src_regs[0] = src;
+  }
+  pi.branch_target = target;
+  pi.actually_taken = taken;
+  pi.instruction_next_addr = taken ? target : addr + INST_SIZE;
+  return pi;
+}
+
+static void emit(const ctype_pin_inst& pi) {
+  fwrite(&pi, sizeof(pi), 1, out);
+  num_written++;
+}
+
+/* load rax <- [rsi]; add rbx += rax; add rsi += rax; jnz loop */
+static void gen_mem(uint64_t num_insts, uint64_t footprint) {
+  const uint64_t num_lines = footprint / 64;
+  while (num_written < num_insts) {
+    uint64_t vaddr = DATA_BASE + (lcg_next() % num_lines) * 64;
+    emit(make_load(CODE_BASE, REG_RSI, REG_RAX, vaddr));
+    emit(make_alu(CODE_BASE + 4, REG_RAX, REG_RBX));
+    emit(make_alu(CODE_BASE + 8, REG_RAX, REG_RSI));
+    emit(make_branch(CODE_BASE + 12, CF_CBR, REG_RSI, CODE_BASE, true));
+  }
+}
+
+/* add rax; jnz skip (random); add rbx; skip: add rcx; jnz loop */
+static void gen_branch(uint64_t num_insts) {
+  while (num_written < num_insts) {
+    bool taken = lcg_next() & 1;
+    emit(make_alu(CODE_BASE, REG_RDX, REG_RAX));
+    emit(make_branch(CODE_BASE + 4, CF_CBR, REG_RAX, CODE_BASE + 12, taken));
+    if (!taken)
+      emit(make_alu(CODE_BASE + 8, REG_RAX, REG_RBX));
+    emit(make_alu(CODE_BASE + 12, REG_RAX, REG_RCX));
+    emit(make_branch(CODE_BASE + 16, CF_CBR, REG_RCX, CODE_BASE, true));
+  }
+}
+
+/* Blocks of three adds and a jmp, one block per 64B line, visited in a fixed
+   random cyclic order so every block has a single static target. */
+static void gen_frontend(uint64_t num_insts, uint64_t footprint) {
+  const uint64_t num_blocks = footprint / 64;
+  uint64_t* order = (uint64_t*)malloc(num_blocks * sizeof(uint64_t));
+  for (uint64_t ii = 0; ii < num_blocks; ii++)
+    order[ii] = ii;
+  for (uint64_t ii = num_blocks - 1; ii > 0; ii--) {
+    uint64_t jj = lcg_next() % (ii + 1);
+    uint64_t tmp = order[ii];
+    order[ii] = order[jj];
+    order[jj] = tmp;
+  }
+
+  for (uint64_t ii = 0; num_written < num_insts; ii = (ii + 1) % num_blocks) {
+    uint64_t block = CODE_BASE + order[ii] * 64;
+    uint64_t target = CODE_BASE + order[(ii + 1) % num_blocks] * 64;
+    emit(make_alu(block, REG_RAX, REG_RBX));
+    emit(make_alu(block + 4, REG_RBX, REG_RCX));
+    emit(make_alu(block + 8, REG_RCX, REG_RAX));
+    emit(make_branch(block + 12, CF_BR, REG_INV, target, true));
+  }
+  free(order);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    fprintf(stderr, "Usage: %s <mem|branch|frontend> <num_insts> <out.trace.bz2> [footprint_bytes]\n", argv[0]);
+    return 1;
+  }
+  std::string kernel = argv[1];
+  uint64_t num_insts = strtoull(argv[2], NULL, 0);
+  uint64_t footprint = argc > 4 ? strtoull(argv[4], NULL, 0) : 0;
+
+  std::string cmd = std::string("bzip2 > ") + argv[3];
+  out = popen(cmd.c_str(), "w");
+  if (!out) {
+    fprintf(stderr, "Could not open %s\n", argv[3]);
+    return 1;
+  }
+
+  if (kernel == "mem") {
+    gen_mem(num_insts, footprint ? footprint : 64 << 20);
+  } else if (kernel == "branch") {
+    gen_branch(num_insts);
+  } else if (kernel == "frontend") {
+    gen_frontend(num_insts, footprint ? footprint : 4 << 20);
+  } else {
+    fprintf(stderr, "Unknown kernel %s\n", kernel.c_str());
+    pclose(out);
+    return 1;
+  }
+
+  pclose(out);
+  printf("Wrote %llu instructions to %s\n", (unsigned long long)num_written, argv[3]);
+  return 0;
+}
@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+"""
+Author: HPS Research Group
+Date: 10/18/2026
+Description: Simulator throughput benchmark. Runs every (workload, config)
+pair of bench_suite.json on the trace frontend, reports host KIPS, peak RSS
+and the HOST_PROF per-region time split, and compares KIPS/RSS against a
+stored baseline. KIPS is computed from SIM_HOST_WALL_SECONDS, so parameter
+parsing, model init and trace opening are not counted. Exits with status 1
+if any pair regressed past tolerance. A pair with no baseline entry (for
+example on a fresh checkout, where baseline.json is empty) is not gated: its
+numbers from this run are written to the baseline with a warning, so the
+next run compares against them. Use --update-baseline to re-record all pairs.
+
+Example:
+  python3 utils/bench/scarab_bench.py --scarab src/scarab --json bench.json
+  python3 utils/bench/scarab_bench.py --scarab src/scarab --update-baseline
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+REPO_DIR = os.path.dirname(os.path.dirname(BENCH_DIR))
+SRC_DIR = os.path.join(REPO_DIR, "src")
+
+# NAME  count  pct%  total_count  total_pct%
+STAT_RE = re.compile(r"^(HOST_PROF_\w+_TICKS)\s+\S+\s+\S+%\s+\S+\s+(-?[\d.]+|nan)%")
+# NAME  value  total_value
+WALL_RE = re.compile(r"^SIM_HOST_WALL_SECONDS\s+[\d.]+\s+([\d.]+)")
+
+
+def build_generator(work_dir):
+  gen = os.path.join(work_dir, "gen_synthetic_trace")
+  src = os.path.join(BENCH_DIR, "gen_synthetic_trace.cc")
+  if not os.path.exists(gen) or os.path.getmtime(gen) < os.path.getmtime(src):
+    subprocess.check_call(["g++", "-O2", "-std=c++17", "-I", SRC_DIR, src, "-o", gen])
+  return gen
+
+
+def get_trace(work_dir, name, workload):
+  if "trace" in workload:
+    return os.path.join(REPO_DIR, workload["trace"])
+  trace = os.path.join(work_dir, "{}.trace.bz2".format(name))
+  if not os.path.exists(trace):
+    cmd = [build_generator(work_dir), workload["kernel"], str(workload["insts"]), trace]
+    if "footprint" in workload:
+      cmd.append(str(workload["footprint"]))
+    subprocess.check_call(cmd, stdout=subprocess.DEVNULL)
+  return trace
+
+
+def read_core_stats(sim_dir):
+  """Simulation-phase wall seconds (None if absent) and HOST_PROF region split."""
+  sim_wall = None
+  regions = {}
+  path = os.path.join(sim_dir, "core.stat.0.out")
+  if not os.path.exists(path):
+    return sim_wall, regions
+  with open(path) as f:
+    for line in f:
+      m = STAT_RE.match(line)
+      if m:
+        regions[m.group(1)[len("HOST_PROF_"):-len("_TICKS")].lower()] = float(m.group(2))
+        continue
+      m = WALL_RE.match(line)
+      if m:
+        sim_wall = float(m.group(1))
+  return sim_wall, regions
+
+
+def run_one(scarab, suite, sim_dir, trace, params):
+  os.makedirs(sim_dir, exist_ok=True)
+  with open(os.path.join(REPO_DIR, params)) as src, open(os.path.join(sim_dir, "PARAMS.in"), "w") as dst:
+    dst.write(src.read())
+
+  cmd = [scarab] + suite["scarab_args"] + ["--cbp_trace_r0", trace, "--inst_limit", str(suite["inst_limit"])]
+  with open(os.path.join(sim_dir, "sim.out"), "w") as out:
+    start = time.monotonic()
+    proc = subprocess.Popen(cmd, cwd=sim_dir, stdout=out, stderr=subprocess.STDOUT)
+    _, status, rusage = os.wait4(proc.pid, 0)
+    wall = time.monotonic() - start
+
+  if os.waitstatus_to_exitcode(status) != 0:
+    return {"error": "scarab exited with status {}, see {}".format(status, sim_dir)}
+  sim_wall, regions = read_core_stats(sim_dir)
+  if not sim_wall:
+    return {"error": "no SIM_HOST_WALL_SECONDS in {}/core.stat.0.out".format(sim_dir)}
+  return {
+    "wall_seconds": wall,
+    "sim_wall_seconds": sim_wall,
+    "kips": suite["inst_limit"] / sim_wall / 1000.0,
+    "peak_rss_mb": rusage.ru_maxrss / 1024.0,
+    "host_prof_pct": regions,
+  }
+
+
+def compare(result, base, suite):
+  """Regression messages for one result against its baseline entry."""
+  msgs = []
+  if result["kips"] < base["kips"] * (1 - suite["kips_tolerance"]):
+    msgs.append("KIPS {:.1f} < baseline {:.1f}".format(result["kips"], base["kips"]))
+  if result["peak_rss_mb"] > base["peak_rss_mb"] * (1 + suite["rss_tolerance"]):
+    msgs.append("peak RSS {:.1f}MB > baseline {:.1f}MB".format(result["peak_rss_mb"], base["peak_rss_mb"]))
+  return msgs
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Scarab simulator throughput benchmark.")
+  parser.add_argument("--scarab", default=os.path.join(SRC_DIR, "scarab"), help="Scarab binary to benchmark.")
+  parser.add_argument("--suite", default=os.path.join(BENCH_DIR, "bench_suite.json"))
+  parser.add_argument("--baseline", default=os.path.join(BENCH_DIR, "baseline.json"))
+  parser.add_argument("--work_dir", default=os.path.join(REPO_DIR, "bench_work"),
+                      help="Where traces are generated and simulations run.")
+  parser.add_argument("--json", default=None, help="Write results to this JSON file.")
+  parser.add_argument("--only", action="append", default=None, help="Run only these workloads.")
+  parser.add_argument("--update-baseline", action="store_true", help="Store this run as the new baseline.")
+  args = parser.parse_args()
+
+  with open(args.suite) as f:
+    suite = json.load(f)
+  baseline = {}
+  if os.path.exists(args.baseline):
+    with open(args.baseline) as f:
+      baseline = json.load(f)
+
+  scarab = os.path.abspath(args.scarab)
+  os.makedirs(args.work_dir, exist_ok=True)
+
+  results = {}
+  regressions = []
+  missing = []
+  for wl_name, workload in suite["workloads"].items():
+    if args.only and wl_name not in args.only:
+      continue
+    trace = get_trace(args.work_dir, wl_name, workload)
+    for cfg_name, params in suite["configs"].items():
+      key = "{}/{}".format(wl_name, cfg_name)
+      result = run_one(scarab, suite, os.path.join(args.work_dir, wl_name, cfg_name), trace, params)
+      results[key] = result
+      if "error" in result:
+        regressions.append("{}: {}".format(key, result["error"]))
+        print("{:30} ERROR".format(key))
+        continue
+      if args.update_baseline:
+        msgs = []
+      elif not {"kips", "peak_rss_mb"} <= set(baseline.get(key, {})):
+        missing.append(key)
+        print("{:30} {:9.1f} KIPS {:9.1f} MB NEW BASELINE".format(key, result["kips"], result["peak_rss_mb"]))
+        continue
+      else:
+        msgs = compare(result, baseline[key], suite)
+      regressions += ["{}: {}".format(key, m) for m in msgs]
+      print("{:30} {:9.1f} KIPS {:9.1f} MB {}".format(key, result["kips"], result["peak_rss_mb"],
+                                                      "REGRESSED" if msgs else "ok"))
+
+  if args.json:
+    with open(args.json, "w") as f:
+      json.dump({"results": results, "regressions": regressions, "missing_baseline": missing}, f, indent=2,
+                sort_keys=True)
+
+  record = [key for key, result in results.items() if "error" not in result] if args.update_baseline else missing
+  if record:
+    for key in record:
+      baseline[key] = {"kips": results[key]["kips"], "peak_rss_mb": results[key]["peak_rss_mb"]}
+    with open(args.baseline, "w") as f:
+      json.dump(baseline, f, indent=2, sort_keys=True)
+      f.write("\n")
+  if args.update_baseline:
+    return 0
+
+  for key in missing:
+    print("WARNING: no baseline entry for {}, recorded this run in {}".format(key, args.baseline), file=sys.stderr)
+  for msg in regressions:
+    print("REGRESSION " + msg, file=sys.stderr)
+  return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())
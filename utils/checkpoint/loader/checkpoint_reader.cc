@@ -21,9 +21,17 @@
 
 #include "checkpoint_reader.h"
 
+#include <algorithm>
+#include <bzlib.h>
 #include <cassert>
+#include <climits>
+#include <condition_variable>
+#include <deque>
 #include <fcntl.h>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unistd.h>
 #include <vector>
 
@@ -42,6 +50,7 @@ char fpstate_buffer[FPSTATE_SIZE];
 struct Checkpoint_Memory_Region {
   RegionInfo  region_info;
   bool        already_mapped;
+  bool        zero_filled;  // freshly mapped anonymous memory, reads as zero
   std::string data_file;
 };
 
@@ -699,6 +708,7 @@ void allocate_new_regions(pid_t child_pid) {
         flags  = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED;
         fd     = -1;
         offset = 0;
+        memory_regions[i].zero_filled = true;
       } else {
         flags = MAP_PRIVATE | MAP_FIXED;
         fd    = execute_open(child_pid, checkpoint_region.file_name.c_str(), 0);
@@ -735,6 +745,239 @@ void allocate_new_regions(pid_t child_pid) {
   }
 }
 
+/* Region data is restored by worker threads that decompress the .dat files
+ * in-process and hand fixed-size chunks to the tracer thread, which is the only
+ * thread allowed to ptrace the child. The chunks come from a fixed pool of
+ * buffers, so memory use does not grow with the size of the checkpoint. */
+static const size_t RESTORE_CHUNK_SIZE        = MAX_PG_SIZE;
+static const int    RESTORE_CHUNKS_PER_WORKER = 2;
+// Zero pages are written along with their neighbors unless they form a run at
+// least this long, to avoid a ptrace round trip per page
+static const size_t RESTORE_MIN_ZERO_RUN = 16 * PG_SIZE;
+
+struct Restore_Chunk {
+  int    region_id;
+  size_t offset;  // from the start of the region
+  size_t size;
+  char*  data;
+};
+
+struct Restore_Queue {
+  std::mutex                mutex;
+  std::condition_variable   chunk_ready;
+  std::condition_variable   buffer_free;
+  std::deque<Restore_Chunk> chunks;
+  std::vector<char*>        free_buffers;
+  std::vector<int>          region_ids;
+  size_t                    next_region     = 0;
+  int                       running_workers = 0;
+  bool                      failed          = false;
+  std::string               error;
+};
+
+/* Same output as bzip2 -dc, including files of several concatenated streams */
+class Bzip2_Reader {
+ public:
+  explicit Bzip2_Reader(FILE* file) : file(file), in_buf(1 << 16) {}
+  ~Bzip2_Reader() {
+    if(in_stream)
+      BZ2_bzDecompressEnd(&strm);
+  }
+
+  // Returns fewer than n bytes only at the end of the data or on an error
+  size_t read(char* dst, size_t n) {
+    size_t done = 0;
+    while(done < n && !error) {
+      if(!in_stream) {
+        if(!fill())
+          break;
+        if(BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK) {
+          error = true;
+          break;
+        }
+        in_stream = true;
+      }
+      if(!fill()) {
+        error = true;  // truncated stream
+        break;
+      }
+      strm.next_out  = dst + done;
+      strm.avail_out = (unsigned)std::min(n - done, (size_t)UINT_MAX);
+      unsigned avail = strm.avail_out;
+      int      ret   = BZ2_bzDecompress(&strm);
+      done += avail - strm.avail_out;
+      if(ret == BZ_STREAM_END) {
+        BZ2_bzDecompressEnd(&strm);
+        in_stream = false;
+      } else if(ret != BZ_OK) {
+        error = true;
+      }
+    }
+    return done;
+  }
+
+  bool failed() const { return error; }
+
+ private:
+  bool fill() {
+    if(strm.avail_in)
+      return true;
+    size_t bytes_read = fread(in_buf.data(), 1, in_buf.size(), file);
+    if(ferror(file))
+      error = true;
+    strm.next_in  = in_buf.data();
+    strm.avail_in = bytes_read;
+    return bytes_read > 0;
+  }
+
+  FILE*             file;
+  std::vector<char> in_buf;
+  bz_stream         strm      = {};
+  bool              in_stream = false;
+  bool              error     = false;
+};
+
+static void fail_restore(Restore_Queue* queue, const std::string& error) {
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  if(!queue->failed) {
+    queue->failed = true;
+    queue->error  = error;
+  }
+  queue->buffer_free.notify_all();
+  queue->chunk_ready.notify_all();
+}
+
+static char* acquire_restore_buffer(Restore_Queue* queue) {
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  queue->buffer_free.wait(
+    lock, [queue] { return !queue->free_buffers.empty() || queue->failed; });
+  if(queue->failed)
+    return nullptr;
+  char* buffer = queue->free_buffers.back();
+  queue->free_buffers.pop_back();
+  return buffer;
+}
+
+static void release_restore_buffer(Restore_Queue* queue, char* buffer) {
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  queue->free_buffers.push_back(buffer);
+  queue->buffer_free.notify_one();
+}
+
+static void decompress_region(Restore_Queue* queue, int region_id) {
+  const Checkpoint_Memory_Region& region = memory_regions[region_id];
+  const std::string path = checkpoint_dir + "/" + region.data_file;
+  size_t region_size     = region.region_info.range.size();
+  DEBUG("decompressing " << path);
+
+  FILE* data_file = fopen(path.c_str(), "rb");
+  if(!data_file) {
+    fail_restore(queue, "Error opening a dat file: " + region.data_file);
+    return;
+  }
+  Bzip2_Reader reader(data_file);
+
+  bool complete = true;
+  for(size_t offset = 0; offset < region_size;) {
+    char* buffer = acquire_restore_buffer(queue);
+    if(!buffer) {
+      complete = false;
+      break;
+    }
+    size_t chunk_size = std::min(RESTORE_CHUNK_SIZE, region_size - offset);
+    if(reader.read(buffer, chunk_size) != chunk_size) {
+      release_restore_buffer(queue, buffer);
+      fail_restore(queue, (reader.failed() ? "dat file is corrupt: " :
+                                             "dat file did not have enough "
+                                             "bytes: ") +
+                            region.data_file);
+      complete = false;
+      break;
+    }
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->chunks.push_back({region_id, offset, chunk_size, buffer});
+    queue->chunk_ready.notify_one();
+    offset += chunk_size;
+  }
+
+  char temp_byte;
+  if(complete && reader.read(&temp_byte, 1) == 1) {
+    fail_restore(queue, "dat file has too many bytes: " + region.data_file);
+  } else if(complete && reader.failed()) {
+    fail_restore(queue, "dat file is corrupt: " + region.data_file);
+  }
+  fclose(data_file);
+}
+
+static void restore_region_worker(Restore_Queue* queue) {
+  for(;;) {
+    int region_id;
+    {
+      std::lock_guard<std::mutex> lock(queue->mutex);
+      if(queue->failed || queue->next_region == queue->region_ids.size())
+        break;
+      region_id = queue->region_ids[queue->next_region++];
+    }
+    decompress_region(queue, region_id);
+  }
+
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  queue->running_workers--;
+  queue->chunk_ready.notify_all();
+}
+
+static bool is_zero_page(const char* data, size_t size) {
+  const uint64_t* words = (const uint64_t*)data;
+  for(size_t i = 0; i < size / sizeof(uint64_t); ++i) {
+    if(words[i])
+      return false;
+  }
+  return true;
+}
+
+static void write_restore_chunk(pid_t child_pid, const Restore_Chunk& chunk,
+                                void* sharedmem_tracer_addr,
+                                void* sharedmem_tracee_addr) {
+  const Checkpoint_Memory_Region& region = memory_regions[chunk.region_id];
+  char* dest = (char*)region.region_info.range.inclusive_lower_bound +
+               chunk.offset;
+
+  if(chunk.region_id == vsyscall_region_id ||
+     chunk.region_id == vdso_region_id || chunk.region_id == vvar_region_id) {
+    assert_equal_mem(child_pid, chunk.data, dest, chunk.size);
+    return;
+  }
+  if(!region.zero_filled) {
+    shared_memory_memcpy(child_pid, dest, chunk.data, chunk.size,
+                         sharedmem_tracer_addr, sharedmem_tracee_addr);
+    return;
+  }
+
+  // A fresh anonymous mapping already reads as zero, so only the runs of
+  // non-zero pages are written. The rest stay unbacked in the child until the
+  // workload touches them.
+  size_t begin = 0;
+  while(begin < chunk.size) {
+    size_t page_size = std::min((size_t)PG_SIZE, chunk.size - begin);
+    if(is_zero_page(chunk.data + begin, page_size)) {
+      begin += page_size;
+      continue;
+    }
+    size_t end  = begin;  // end of the last non-zero page
+    size_t scan = begin;
+    while(scan < chunk.size && scan - end < RESTORE_MIN_ZERO_RUN) {
+      page_size = std::min((size_t)PG_SIZE, chunk.size - scan);
+      if(!is_zero_page(chunk.data + scan, page_size))
+        end = scan + page_size;
+      scan += page_size;
+    }
+    shared_memory_memcpy(child_pid, dest + begin, chunk.data + begin,
+                         end - begin, sharedmem_tracer_addr,
+                         sharedmem_tracee_addr);
+    begin = scan;
+  }
+}
+
 void write_data_to_regions(pid_t child_pid) {
   std::cout << "Writing data to all regions ..." << std::endl;
   auto[sharedmem_tracer_addr, sharedmem_tracee_addr] = allocate_shared_memory(
@@ -762,61 +1005,54 @@ void write_data_to_regions(pid_t child_pid) {
     kill_and_exit(child_pid);
   }
 
+  Restore_Queue queue;
   for(int i = 0; i < num_valid_memory_regions; ++i) {
     const RegionInfo& checkpoint_region = memory_regions[i].region_info;
-    size_t region_size = checkpoint_region.range.exclusive_upper_bound -
-                         checkpoint_region.range.inclusive_lower_bound;
-    assert(region_size % 8 == 0);
+    assert(checkpoint_region.range.size() % 8 == 0);
     if(is_pin_library(checkpoint_region.file_name)) {
       // Don't allocate pin library regions
       continue;
     }
+    queue.region_ids.push_back(i);
+  }
 
-    char*       temp_buffer = new char[region_size];
-    std::string cmd         = std::string("bzip2 -dc ") + checkpoint_dir + "/" +
-                      memory_regions[i].data_file;
-    DEBUG(cmd);
-    FILE* data_file = popen(cmd.c_str(), "r");
-    if(!data_file) {
-      fatal_and_kill_child(child_pid, "Error opening a dat file: %s",
-                           memory_regions[i].data_file.c_str());
-    }
-    size_t bytes_read = fread(temp_buffer, 1, region_size, data_file);
-    if(bytes_read != region_size) {
-      fatal_and_kill_child(child_pid,
-                           "dat file did not have enough bytes: %s. "
-                           "bytes_read: %d, region_size: %d",
-                           memory_regions[i].data_file.c_str(), bytes_read,
-                           region_size);
-    }
-
-    char temp_byte;
-    bytes_read = fread(&temp_byte, 1, 1, data_file);
-    if(bytes_read == 1 || !feof(data_file)) {
-      fatal_and_kill_child(child_pid, "dat file has too many bytes: %s",
-                           memory_regions[i].data_file.c_str());
-    }
-    fclose(data_file);
-
-    if(i == vsyscall_region_id || i == vdso_region_id || i == vvar_region_id) {
-      DEBUG("asserting regions are equal: start");
-      assert_equal_mem(child_pid, temp_buffer,
-                       (char*)checkpoint_region.range.inclusive_lower_bound,
-                       region_size);
-      DEBUG("asserting regions are equal: done");
-    } else {
-      DEBUG("doing a ptrace memcpy: start");
-      // execute_memcpy(child_pid,
-      //               (void*)checkpoint_region.range.inclusive_lower_bound,
-      //               temp_buffer, region_size);
-      shared_memory_memcpy(
-        child_pid, (void*)checkpoint_region.range.inclusive_lower_bound,
-        temp_buffer, region_size, sharedmem_tracer_addr, sharedmem_tracee_addr);
-      DEBUG("doing a ptrace memcpy: end");
+  int num_workers = std::max(
+    1, (int)std::min<size_t>(std::thread::hardware_concurrency(),
+                             queue.region_ids.size()));
+  std::vector<std::unique_ptr<char[]>> buffers;
+  for(int i = 0; i < num_workers * RESTORE_CHUNKS_PER_WORKER; ++i) {
+    buffers.emplace_back(new char[RESTORE_CHUNK_SIZE]);
+    queue.free_buffers.push_back(buffers.back().get());
+  }
+  queue.running_workers = num_workers;
+  std::vector<std::thread> workers;
+  for(int i = 0; i < num_workers; ++i)
+    workers.emplace_back(restore_region_worker, &queue);
+
+  DEBUG("restoring " << queue.region_ids.size() << " regions with "
+                     << num_workers << " threads: start");
+  for(;;) {
+    Restore_Chunk chunk;
+    {
+      std::unique_lock<std::mutex> lock(queue.mutex);
+      queue.chunk_ready.wait(lock, [&queue] {
+        return !queue.chunks.empty() || queue.running_workers == 0 ||
+               queue.failed;
+      });
+      if(queue.failed || queue.chunks.empty())
+        break;
+      chunk = queue.chunks.front();
+      queue.chunks.pop_front();
     }
-
-    delete[] temp_buffer;
+    write_restore_chunk(child_pid, chunk, sharedmem_tracer_addr,
+                        sharedmem_tracee_addr);
+    release_restore_buffer(&queue, chunk.data);
   }
+  for(auto& worker : workers)
+    worker.join();
+  if(queue.failed)
+    fatal_and_kill_child(child_pid, "%s", queue.error.c_str());
+  DEBUG("restoring regions: done");
 
   if(ptrace(PTRACE_SETREGS, child_pid, NULL, &oldregs)) {
     perror("PTRACE_SETREGS");